@@ -0,0 +1,52 @@
+#include <stdio.h>
+
+#include "igvDisplayListRenderer.h"
+
+/**
+* Destructor
+*/
+igvDisplayListRenderer::~igvDisplayListRenderer()
+{ if (lists)
+    { glDeleteLists(lists, IGV_MESHES);
+    }
+}
+
+/**
+* Method to query the name of the backend
+* @return The name accepted by igvRenderer::create
+*/
+const char* igvDisplayListRenderer::get_name()
+{ return "lists";
+}
+
+/**
+* Compiles the display lists of all the meshes
+* @retval true If the lists could be created
+* @retval false Otherwise
+*/
+bool igvDisplayListRenderer::initialize()
+{ if (!igvImmediateRenderer::initialize())
+    { return false;
+    }
+
+    lists = glGenLists(IGV_MESHES);
+    if (!lists)
+    { fprintf(stderr, "[renderer] display lists not available\n");
+        return false;
+    }
+
+    for (int mesh = 0; mesh < IGV_MESHES; mesh++)
+    { glNewList(lists + mesh, GL_COMPILE);
+        igvImmediateRenderer::draw_mesh((igvMesh) mesh);
+        glEndList();
+    }
+    return true;
+}
+
+/**
+* Draws a unit mesh by calling its display list
+* @param mesh Mesh to draw
+*/
+void igvDisplayListRenderer::draw_mesh(igvMesh mesh)
+{ glCallList(lists + mesh);
+}
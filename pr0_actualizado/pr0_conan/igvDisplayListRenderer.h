@@ -0,0 +1,29 @@
+#ifndef __IGVDISPLAYLISTRENDERER
+#define __IGVDISPLAYLISTRENDERER
+
+#include "igvImmediateRenderer.h"
+
+/**
+ * Renderer that compiles every mesh into a display list once, so drawing a mesh
+ * is a single glCallList instead of the whole glBegin/glEnd sequence
+ */
+class igvDisplayListRenderer: public igvImmediateRenderer {
+private:
+    GLuint lists = 0; ///< First of the IGV_MESHES display lists, one per mesh
+
+public:
+    /// Default constructor
+    igvDisplayListRenderer() = default;
+
+    /// Destructor
+    ~igvDisplayListRenderer() override;
+
+    // Methods
+    const char* get_name() override;
+    bool initialize() override;
+
+protected:
+    void draw_mesh(igvMesh mesh) override;
+};
+
+#endif   // __IGVDISPLAYLISTRENDERER
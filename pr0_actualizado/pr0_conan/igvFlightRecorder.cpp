@@ -0,0 +1,199 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdio.h>
+
+#include "igvFlightRecorder.h"
+#include "igvGLStats.h"
+
+// Singleton Pattern Application
+igvFlightRecorder* igvFlightRecorder::_instance = nullptr;
+
+// Current time, in ms
+static double now_ms()
+{ return std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+* Default constructor. Reads the frame budget from CGV_FRAME_BUDGET_MS and the
+* number of frames to keep from CGV_FLIGHT_FRAMES. The whole ring is allocated
+* here, so recording a frame never allocates memory
+*/
+igvFlightRecorder::igvFlightRecorder()
+{ memset(ring, 0, sizeof(ring));
+
+    const char* budget = getenv("CGV_FRAME_BUDGET_MS");
+    if (budget)
+    { budget_ms = atof(budget);
+    }
+
+    const char* frames = getenv("CGV_FLIGHT_FRAMES");
+    if (frames)
+    { n_frames = atoi(frames);
+        if (n_frames < 1)
+        { n_frames = 1;
+        }
+        if (n_frames > IGV_FLIGHT_MAX_FRAMES)
+        { n_frames = IGV_FLIGHT_MAX_FRAMES;
+        }
+    }
+
+#ifdef IGV_GL_STATS
+    if (budget_ms > 0)
+    { igvGLStats::getInstance().enable_trace();
+    }
+#endif   // IGV_GL_STATS
+}
+
+/**
+* Method to access the class's singleton object, applying the Singleton
+* design pattern
+* @return A reference to the class's singleton object
+*/
+igvFlightRecorder& igvFlightRecorder::getInstance()
+{ if ( !_instance )
+    { _instance = new igvFlightRecorder;
+    }
+
+    return *_instance;
+}
+
+/**
+* Method to check whether the recorder is enabled
+* @retval true If a frame budget has been set
+* @retval false Otherwise
+*/
+bool igvFlightRecorder::is_enabled()
+{ return budget_ms > 0;
+}
+
+/**
+* Records an input event in the frame being prepared
+* @param type Callback that received the event; must be a string literal
+* @param key Key or menu option
+* @param x X coordinate of the mouse position
+* @param y Y coordinate of the mouse position
+*/
+void igvFlightRecorder::input(const char* type, int key, int x, int y)
+{ if (!is_enabled())
+    { return;
+    }
+
+    igvFlightFrame& f = ring[head];
+    if (f.n_events < IGV_FLIGHT_MAX_EVENTS)
+    { f.events[f.n_events++] = { type, key, x, y, now_ms() };
+    }
+    else
+    { f.lost_events++;
+    }
+}
+
+/**
+* Starts drawing the frame being prepared
+*/
+void igvFlightRecorder::begin_frame()
+{ if (!is_enabled())
+    { return;
+    }
+
+    ring[head].frame = frame;
+    ring[head].start = now_ms();
+}
+
+/**
+* Records a scene state value in the frame being drawn
+* @param name Name of the value; must be a string literal
+* @param value Value
+*/
+void igvFlightRecorder::value(const char* name, float value)
+{ if (!is_enabled())
+    { return;
+    }
+
+    igvFlightFrame& f = ring[head];
+    if (f.n_values < IGV_FLIGHT_MAX_VALUES)
+    { f.values[f.n_values++] = { name, value };
+    }
+}
+
+/**
+* Finishes the frame being drawn. If it has exceeded the frame budget, the
+* history is dumped to disk; then the next slot of the ring is reused for the
+* next frame
+*/
+void igvFlightRecorder::end_frame()
+{ if (!is_enabled())
+    { return;
+    }
+
+    igvFlightFrame& f = ring[head];
+    f.frame_ms = now_ms() - f.start;
+
+    if (f.frame_ms > budget_ms && frame >= next_dump)
+    { dump(f);
+        next_dump = frame + n_frames; // the next dump will not repeat these frames
+    }
+
+    frame++;
+    head = (head + 1) % n_frames;
+    ring[head].n_events = 0;
+    ring[head].lost_events = 0;
+    ring[head].n_values = 0;
+}
+
+/**
+* Writes the history of the last frames and the GL call trace of the slow frame
+* to igv_slow_frame_<number>.txt, in the directory given by CGV_FLIGHT_DIR
+* (the working directory by default)
+* @param slow Frame that has exceeded the budget
+*/
+void igvFlightRecorder::dump(const igvFlightFrame& slow)
+{ const char* dir = getenv("CGV_FLIGHT_DIR");
+    char path[512];
+    snprintf(path, sizeof(path), "%s%sigv_slow_frame_%lu.txt", dir ? dir : "", dir ? "/" : "", slow.frame);
+
+    FILE* out = fopen(path, "w");
+    if (!out)
+    { perror(path);
+        return;
+    }
+
+    fprintf(out, "slow frame %lu: %.3f ms, budget %.3f ms\n\n", slow.frame, slow.frame_ms, budget_ms);
+
+    // history, from the oldest frame to the slow one
+    int n = (frame + 1 < (unsigned long) n_frames) ? (int) frame + 1 : n_frames;
+    for (int i = n - 1; i >= 0; i--)
+    { const igvFlightFrame& f = ring[(head - i + n_frames) % n_frames];
+
+        fprintf(out, "frame %lu: %.3f ms%s\n", f.frame, f.frame_ms, (f.frame_ms > budget_ms) ? " (over budget)" : "");
+        for (int v = 0; v < f.n_values; v++)
+        { fprintf(out, "  %s = %g\n", f.values[v].name, f.values[v].value);
+        }
+        for (int e = 0; e < f.n_events; e++)
+        { fprintf(out, "  input %s key %d at (%d, %d), %.3f ms before the frame\n", f.events[e].type,
+                    f.events[e].key, f.events[e].x, f.events[e].y, f.start - f.events[e].time);
+        }
+        if (f.lost_events)
+        { fprintf(out, "  %d more input events\n", f.lost_events);
+        }
+    }
+
+#ifdef IGV_GL_STATS
+    unsigned long length, kept;
+    const igvGLTraceEntry* trace = igvGLStats::getInstance().get_last_trace(length, kept);
+
+    fprintf(out, "\nGL call trace of frame %lu: %lu calls\n", slow.frame, length);
+    for (unsigned long i = 0; i < kept; i++)
+    { fprintf(out, "  %10.4f ms %s\n", trace[i].time, igvGLStats::call_name(trace[i].call));
+    }
+    if (kept < length)
+    { fprintf(out, "  ... %lu more calls\n", length - kept);
+    }
+#else
+    fprintf(out, "\nGL call trace not available: build with -DCGV_GL_STATS=ON\n");
+#endif   // IGV_GL_STATS
+
+    fclose(out);
+    fprintf(stderr, "[flight-recorder] frame %lu took %.3f ms, history written to %s\n", slow.frame, slow.frame_ms, path);
+}
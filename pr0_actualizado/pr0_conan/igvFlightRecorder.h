@@ -0,0 +1,77 @@
+#ifndef __IGVFLIGHTRECORDER
+#define __IGVFLIGHTRECORDER
+
+#define IGV_FLIGHT_MAX_FRAMES 1024 ///< Maximum number of frames kept in the ring
+#define IGV_FLIGHT_MAX_EVENTS 8 ///< Input events kept per frame
+#define IGV_FLIGHT_MAX_VALUES 16 ///< Scene state values kept per frame
+
+/**
+ * Input event received while a frame was being prepared
+ */
+struct igvFlightEvent {
+    const char* type; ///< Callback that received the event
+    int key; ///< Key or menu option
+    int x, y; ///< Mouse position
+    double time; ///< Time the event was received, in ms
+};
+
+/**
+ * Scene state value (selected object, camera parameter, number of stacks...)
+ */
+struct igvFlightValue {
+    const char* name; ///< Name of the value; must be a string literal
+    float value; ///< Value at the start of the frame
+};
+
+/**
+ * Record of one frame in the ring of the flight recorder
+ */
+struct igvFlightFrame {
+    unsigned long frame; ///< Frame number
+    double start; ///< Time the frame started to be drawn, in ms
+    double frame_ms; ///< Time spent drawing the frame
+    int n_events; ///< Input events received before the frame
+    int lost_events; ///< Input events that did not fit in events
+    igvFlightEvent events[IGV_FLIGHT_MAX_EVENTS]; ///< Input events received before the frame
+    int n_values; ///< Scene state values recorded
+    igvFlightValue values[IGV_FLIGHT_MAX_VALUES]; ///< Scene state at the start of the frame
+};
+
+/**
+ * Objects of this class keep the history of the last frames in a preallocated
+ * ring and dump it to disk when a frame exceeds the frame budget. It is enabled
+ * with the CGV_FRAME_BUDGET_MS environment variable; CGV_FLIGHT_FRAMES sets
+ * the number of frames kept (120 by default)
+ */
+class igvFlightRecorder {
+private:
+    igvFlightFrame ring[IGV_FLIGHT_MAX_FRAMES]; ///< History of the last frames
+    int n_frames = 120; ///< Number of frames of the ring in use
+    int head = 0; ///< Slot of the frame being prepared
+    unsigned long frame = 0; ///< Number of the frame being prepared
+    unsigned long next_dump = 0; ///< First frame that can be dumped, so that dumps do not overlap
+    double budget_ms = 0; ///< Frame budget, 0 if the recorder is disabled
+
+    // Implementing the Singleton pattern
+    static igvFlightRecorder* _instance; ///< Pointer to the singleton object of the class
+    igvFlightRecorder();
+
+public:
+    static igvFlightRecorder& getInstance();
+
+    /// Destructor
+    ~igvFlightRecorder() = default;
+
+    // Methods
+    bool is_enabled();
+
+    void input(const char* type, int key, int x, int y);
+    void begin_frame();
+    void value(const char* name, float value);
+    void end_frame();
+
+private:
+    void dump(const igvFlightFrame& slow);
+};
+
+#endif   // __IGVFLIGHTRECORDER
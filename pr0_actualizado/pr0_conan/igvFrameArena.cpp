@@ -0,0 +1,247 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <stdio.h>
+
+#include "igvFrameArena.h"
+
+#ifdef IGV_ARENA_CHECK
+// Heap allocations made through operator new since the program started
+static std::atomic<unsigned long> heap_allocations{0};
+
+// Replacements of the global operator new and delete, to count the allocations
+void* operator new(size_t size)
+{ heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* memory = malloc(size ? size : 1);
+    if (!memory)
+    { throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](size_t size)
+{ return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{ heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{ return operator new(size, tag);
+}
+
+void operator delete(void* memory) noexcept
+{ free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{ free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{ free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{ free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{ free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{ free(memory);
+}
+#endif   // IGV_ARENA_CHECK
+
+// Initialization of the static singleton pointer
+igvFrameArena* igvFrameArena::_instance = nullptr;
+
+/**
+* Constructor that allocates the first block and reads CGV_ARENA_CHECK
+* @throw std::bad_alloc If the block cannot be allocated
+*/
+igvFrameArena::igvFrameArena()
+{ capacity = IGV_ARENA_BLOCK;
+    block = (char*) malloc(capacity);
+    if (!block)
+    { throw std::bad_alloc();
+    }
+    overflow.reserve(16);
+
+    const char* check = getenv("CGV_ARENA_CHECK");
+#ifdef IGV_ARENA_CHECK
+    if (check)
+    { check_after = strtoul(check, nullptr, 10);
+    }
+#else
+    if (check)
+    { fprintf(stderr, "[arena] heap allocations are only counted when built with -DCGV_ARENA_CHECK=ON\n");
+    }
+#endif   // IGV_ARENA_CHECK
+    frame_start_allocations = get_heap_allocations();
+}
+
+/**
+* Method to get the only instance of the class, following the Singleton pattern
+* @return Reference to the arena
+*/
+igvFrameArena& igvFrameArena::getInstance()
+{ if (!_instance)
+    { _instance = new igvFrameArena;
+    }
+    return *_instance;
+}
+
+/**
+* Destructor
+*/
+igvFrameArena::~igvFrameArena()
+{ for (char* extra: overflow)
+    { free(extra);
+    }
+    free(block);
+}
+
+/**
+* Allocates memory that stays valid until the next reset
+* @param size Bytes to allocate
+* @param alignment Alignment of the memory, a power of 2
+* @return The memory
+* @throw std::bad_alloc If the arena is full and the heap has no memory left
+*/
+void* igvFrameArena::allocate(size_t size, size_t alignment)
+{ size_t start = (used + alignment - 1) & ~(alignment - 1);
+    if (start + size <= capacity)
+    { used = start + size;
+        return block + start;
+    }
+
+    // the arena is full: take the memory from the heap until the next reset
+    char* extra = (char*) malloc(size + alignment);
+    if (!extra)
+    { throw std::bad_alloc();
+    }
+    overflow.push_back(extra);
+    overflow_bytes += size + alignment;
+    return (void*) (((uintptr_t) extra + alignment - 1) & ~(uintptr_t) (alignment - 1));
+}
+
+/**
+* Makes all the memory of the arena available again. If the frame needed more
+* memory than the arena has, the arena grows to hold it in one block. Also counts
+* the heap allocations of the frame, and reports them if CGV_ARENA_CHECK asks to
+* @pre Nothing allocated from the arena is used afterwards
+* @throw std::bad_alloc If the arena cannot grow
+*/
+void igvFrameArena::reset()
+{ size_t frame_bytes = used + overflow_bytes;
+    if (frame_bytes > high_water)
+    { high_water = frame_bytes;
+    }
+
+    if (!overflow.empty())
+    { for (char* extra: overflow)
+        { free(extra);
+        }
+        overflow.clear();
+        overflow_bytes = 0;
+
+        while (capacity < high_water)
+        { capacity *= 2;
+        }
+        free(block);
+        block = (char*) malloc(capacity);
+        if (!block)
+        { capacity = 0;
+            throw std::bad_alloc();
+        }
+    }
+    used = 0;
+
+    frames++;
+    unsigned long allocations = get_heap_allocations();
+    last_frame_allocations = allocations - frame_start_allocations;
+    frame_start_allocations = allocations;
+    if (check_after && frames > check_start + check_after && last_frame_allocations)
+    { fprintf(stderr, "[arena] frame %lu made %lu heap allocations\n", frames, last_frame_allocations);
+        checked_allocations += last_frame_allocations;
+    }
+}
+
+/**
+* Method to query the memory allocated from the arena in the frame
+* @return The bytes allocated since the last reset
+*/
+size_t igvFrameArena::get_used()
+{ return used + overflow_bytes;
+}
+
+/**
+* Method to query the most memory allocated from the arena in a frame
+* @return The high-water mark, in bytes
+*/
+size_t igvFrameArena::get_high_water()
+{ return high_water;
+}
+
+/**
+* Method to query the size of the arena
+* @return The bytes that can be allocated in a frame without using the heap
+*/
+size_t igvFrameArena::get_capacity()
+{ return capacity;
+}
+
+/**
+* Method to query the heap allocations made since the last reset
+* @return The number of allocations
+*/
+unsigned long igvFrameArena::get_frame_allocations()
+{ return get_heap_allocations() - frame_start_allocations;
+}
+
+/**
+* Method to query the heap allocations made by the last frame, between the last
+* two resets
+* @return The number of allocations
+*/
+unsigned long igvFrameArena::get_last_frame_allocations()
+{ return last_frame_allocations;
+}
+
+/**
+* Makes the next CGV_ARENA_CHECK frames a warm-up, whose heap allocations are
+* not reported, as the first frames of the program are. For when the scene
+* changes, and its first frames allocate what the next ones reuse
+*/
+void igvFrameArena::restart_check()
+{ check_start = frames;
+}
+
+/**
+* Method to query the heap allocations reported by CGV_ARENA_CHECK
+* @return The allocations of the frames after the warm-ups, since the program
+* started; 0 if CGV_ARENA_CHECK is not set
+*/
+unsigned long igvFrameArena::get_checked_allocations()
+{ return checked_allocations;
+}
+
+/**
+* Method to query the heap allocations made through operator new, which are only
+* counted when built with CGV_ARENA_CHECK
+* @return The number of allocations since the program started; 0 if not counted
+*/
+unsigned long igvFrameArena::get_heap_allocations()
+{
+#ifdef IGV_ARENA_CHECK
+    return heap_allocations.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif   // IGV_ARENA_CHECK
+}
@@ -0,0 +1,100 @@
+#ifndef __IGVFRAMEARENA
+#define __IGVFRAMEARENA
+
+#include <cstddef>
+#include <vector>
+
+#define IGV_ARENA_BLOCK (64 * 1024) ///< Initial size of the arena, in bytes
+
+/**
+ * Linear allocator for the data that only lives during a frame: allocating bumps
+ * a pointer, nothing is freed on its own, and reset, called after the buffers
+ * are swapped, makes all the memory available again. When a frame needs more
+ * than the arena has, the extra memory comes from the heap and the arena grows
+ * to the high-water mark at the next reset, so once the frames stop growing
+ * they do not touch the heap. Built with -DCGV_ARENA_CHECK=ON, operator new is
+ * replaced to count the heap allocations, so that can be checked: with
+ * CGV_ARENA_CHECK=<frames>, every frame after the first <frames> ones that
+ * allocates from the heap is reported, and the allocations reported are added
+ * up, so a test can fail on them. Only used from the thread that draws
+ */
+class igvFrameArena {
+private:
+    char* block = nullptr; ///< Memory of the arena
+    size_t capacity = 0; ///< Size of block
+    size_t used = 0; ///< Bytes of block allocated in the frame
+    std::vector<char*> overflow; ///< Blocks allocated in the frame when block was full
+    size_t overflow_bytes = 0; ///< Bytes allocated in the overflow blocks
+    size_t high_water = 0; ///< Most bytes allocated in a frame
+
+    unsigned long frames = 0; ///< Number of resets
+    unsigned long frame_start_allocations = 0; ///< Heap allocations before the frame
+    unsigned long last_frame_allocations = 0; ///< Heap allocations made by the last frame
+    unsigned long check_after = 0; ///< Frames after which heap allocations are reported (0 = never)
+    unsigned long check_start = 0; ///< Frames before the warm-up of the check started
+    unsigned long checked_allocations = 0; ///< Heap allocations reported by the frames after the warm-ups
+
+    // Implementing the Singleton pattern
+    static igvFrameArena* _instance; ///< Pointer to the singleton object of the class
+    igvFrameArena();
+
+public:
+    static igvFrameArena& getInstance();
+
+    /// Destructor
+    ~igvFrameArena();
+
+    igvFrameArena(const igvFrameArena&) = delete;
+    igvFrameArena& operator=(const igvFrameArena&) = delete;
+
+    // Methods
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    void reset(); // at the end of the frame, after the buffers are swapped
+
+    size_t get_used(); // bytes allocated in the frame
+    size_t get_high_water();
+    size_t get_capacity();
+    unsigned long get_frame_allocations(); // heap allocations so far in the frame
+    unsigned long get_last_frame_allocations();
+    void restart_check(); // the next frames are a warm-up again, as after the scene changes
+    unsigned long get_checked_allocations(); // reported since the program started
+
+    static unsigned long get_heap_allocations(); // since the program started, if counted
+};
+
+/**
+ * Allocator for the standard containers that takes its memory from the frame
+ * arena, for containers that are built during a frame and dropped before the
+ * reset. Deallocating does nothing
+ */
+template <class T>
+struct igvArenaAllocator {
+    typedef T value_type;
+
+    igvArenaAllocator() = default;
+
+    template <class U>
+    igvArenaAllocator(const igvArenaAllocator<U>&) {}
+
+    T* allocate(size_t n)
+    { return (T*) igvFrameArena::getInstance().allocate(n * sizeof(T), alignof(T));
+    }
+
+    void deallocate(T*, size_t) {}
+};
+
+template <class T, class U>
+bool operator==(const igvArenaAllocator<T>&, const igvArenaAllocator<U>&)
+{ return true;
+}
+
+template <class T, class U>
+bool operator!=(const igvArenaAllocator<T>&, const igvArenaAllocator<U>&)
+{ return false;
+}
+
+/// Vector whose elements live in the frame arena
+template <class T>
+using igvFrameVector = std::vector<T, igvArenaAllocator<T>>;
+
+#endif   // __IGVFRAMEARENA
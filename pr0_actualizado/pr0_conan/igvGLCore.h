@@ -0,0 +1,194 @@
+#ifndef __IGVGLCORE
+#define __IGVGLCORE
+
+#if defined(__APPLE__) && defined(__MACH__)
+#define GL_DO_NOT_WARN_IF_MULTI_GL_VERSION_HEADERS_INCLUDED
+#include <GLUT/glut.h>
+#include <OpenGL/gl3.h>
+#else
+#include <GL/glut.h>
+#include <GL/freeglut_ext.h>
+#include <GL/glext.h>
+#endif   // defined(__APPLE__) && defined(__MACH__)
+
+#include "igvGLStats.h"
+
+#if !(defined(__APPLE__) && defined(__MACH__))
+
+/**
+ * OpenGL 3.3 core entry points used by the core-profile renderer, and by the
+ * offscreen target of every backend that draws at a reduced resolution. They are
+ * not exported by the system libraries on every platform, so they are loaded at
+ * run time with glutGetProcAddress
+ */
+#define IGV_GL_CORE_PROCS(X) \
+    X(PFNGLGENVERTEXARRAYSPROC, glGenVertexArrays) \
+    X(PFNGLDELETEVERTEXARRAYSPROC, glDeleteVertexArrays) \
+    X(PFNGLBINDVERTEXARRAYPROC, glBindVertexArray) \
+    X(PFNGLGENBUFFERSPROC, glGenBuffers) \
+    X(PFNGLDELETEBUFFERSPROC, glDeleteBuffers) \
+    X(PFNGLBINDBUFFERPROC, glBindBuffer) \
+    X(PFNGLBINDBUFFERBASEPROC, glBindBufferBase) \
+    X(PFNGLBUFFERDATAPROC, glBufferData) \
+    X(PFNGLBUFFERSUBDATAPROC, glBufferSubData) \
+    X(PFNGLMAPBUFFERRANGEPROC, glMapBufferRange) \
+    X(PFNGLUNMAPBUFFERPROC, glUnmapBuffer) \
+    X(PFNGLFENCESYNCPROC, glFenceSync) \
+    X(PFNGLCLIENTWAITSYNCPROC, glClientWaitSync) \
+    X(PFNGLDELETESYNCPROC, glDeleteSync) \
+    X(PFNGLGETSTRINGIPROC, glGetStringi) \
+    X(PFNGLVERTEXATTRIBPOINTERPROC, glVertexAttribPointer) \
+    X(PFNGLVERTEXATTRIBIPOINTERPROC, glVertexAttribIPointer) \
+    X(PFNGLVERTEXATTRIBDIVISORPROC, glVertexAttribDivisor) \
+    X(PFNGLVERTEXATTRIBI4UIPROC, glVertexAttribI4ui) \
+    X(PFNGLVERTEXATTRIB3FPROC, glVertexAttrib3f) \
+    X(PFNGLENABLEVERTEXATTRIBARRAYPROC, glEnableVertexAttribArray) \
+    X(PFNGLDISABLEVERTEXATTRIBARRAYPROC, glDisableVertexAttribArray) \
+    X(PFNGLCREATESHADERPROC, glCreateShader) \
+    X(PFNGLDELETESHADERPROC, glDeleteShader) \
+    X(PFNGLSHADERSOURCEPROC, glShaderSource) \
+    X(PFNGLCOMPILESHADERPROC, glCompileShader) \
+    X(PFNGLGETSHADERIVPROC, glGetShaderiv) \
+    X(PFNGLGETSHADERINFOLOGPROC, glGetShaderInfoLog) \
+    X(PFNGLCREATEPROGRAMPROC, glCreateProgram) \
+    X(PFNGLDELETEPROGRAMPROC, glDeleteProgram) \
+    X(PFNGLATTACHSHADERPROC, glAttachShader) \
+    X(PFNGLLINKPROGRAMPROC, glLinkProgram) \
+    X(PFNGLGETPROGRAMIVPROC, glGetProgramiv) \
+    X(PFNGLGETPROGRAMINFOLOGPROC, glGetProgramInfoLog) \
+    X(PFNGLUSEPROGRAMPROC, glUseProgram) \
+    X(PFNGLGETUNIFORMBLOCKINDEXPROC, glGetUniformBlockIndex) \
+    X(PFNGLUNIFORMBLOCKBINDINGPROC, glUniformBlockBinding) \
+    X(PFNGLGETUNIFORMLOCATIONPROC, glGetUniformLocation) \
+    X(PFNGLUNIFORM1IPROC, glUniform1i) \
+    X(PFNGLUNIFORM3FPROC, glUniform3f) \
+    X(PFNGLUNIFORM4IPROC, glUniform4i) \
+    X(PFNGLDRAWARRAYSINSTANCEDPROC, glDrawArraysInstanced) \
+    X(PFNGLACTIVETEXTUREPROC, glActiveTexture) \
+    X(PFNGLTEXBUFFERPROC, glTexBuffer) \
+    X(PFNGLGENQUERIESPROC, glGenQueries) \
+    X(PFNGLBEGINQUERYPROC, glBeginQuery) \
+    X(PFNGLENDQUERYPROC, glEndQuery) \
+    X(PFNGLGETQUERYOBJECTIVPROC, glGetQueryObjectiv) \
+    X(PFNGLGETQUERYOBJECTUI64VPROC, glGetQueryObjectui64v) \
+    X(PFNGLGENFRAMEBUFFERSPROC, glGenFramebuffers) \
+    X(PFNGLDELETEFRAMEBUFFERSPROC, glDeleteFramebuffers) \
+    X(PFNGLBINDFRAMEBUFFERPROC, glBindFramebuffer) \
+    X(PFNGLFRAMEBUFFERRENDERBUFFERPROC, glFramebufferRenderbuffer) \
+    X(PFNGLFRAMEBUFFERTEXTUREPROC, glFramebufferTexture) \
+    X(PFNGLDRAWBUFFERSPROC, glDrawBuffers) \
+    X(PFNGLCLEARBUFFERFVPROC, glClearBufferfv) \
+    X(PFNGLCLEARBUFFERUIVPROC, glClearBufferuiv) \
+    X(PFNGLCHECKFRAMEBUFFERSTATUSPROC, glCheckFramebufferStatus) \
+    X(PFNGLBLITFRAMEBUFFERPROC, glBlitFramebuffer) \
+    X(PFNGLGENRENDERBUFFERSPROC, glGenRenderbuffers) \
+    X(PFNGLDELETERENDERBUFFERSPROC, glDeleteRenderbuffers) \
+    X(PFNGLBINDRENDERBUFFERPROC, glBindRenderbuffer) \
+    X(PFNGLRENDERBUFFERSTORAGEPROC, glRenderbufferStorage)
+
+/**
+ * Entry points of extensions the core-profile renderer uses when the context has
+ * them; they stay null otherwise
+ */
+#define IGV_GL_CORE_OPTIONAL_PROCS(X) \
+    X(PFNGLBUFFERSTORAGEPROC, glBufferStorage) \
+    X(PFNGLVIEWPORTINDEXEDFPROC, glViewportIndexedf) \
+    X(PFNGLDISPATCHCOMPUTEPROC, glDispatchCompute) \
+    X(PFNGLMEMORYBARRIERPROC, glMemoryBarrier) \
+    X(PFNGLMULTIDRAWARRAYSINDIRECTPROC, glMultiDrawArraysIndirect)
+
+#define IGV_GL_CORE_DECLARE(type, name) extern type igvGLCore_##name;
+IGV_GL_CORE_PROCS(IGV_GL_CORE_DECLARE)
+IGV_GL_CORE_OPTIONAL_PROCS(IGV_GL_CORE_DECLARE)
+#undef IGV_GL_CORE_DECLARE
+
+// From here on, every translation unit that includes this header calls the loaded entry points
+#ifndef IGV_GL_CORE_IMPLEMENTATION
+#define glGenVertexArrays igvGLCore_glGenVertexArrays
+#define glDeleteVertexArrays igvGLCore_glDeleteVertexArrays
+#define glBindVertexArray igvGLCore_glBindVertexArray
+#define glGenBuffers igvGLCore_glGenBuffers
+#define glDeleteBuffers igvGLCore_glDeleteBuffers
+#define glBindBuffer igvGLCore_glBindBuffer
+#define glBindBufferBase igvGLCore_glBindBufferBase
+#define glBufferData igvGLCore_glBufferData
+#define glBufferSubData igvGLCore_glBufferSubData
+#define glMapBufferRange igvGLCore_glMapBufferRange
+#define glUnmapBuffer igvGLCore_glUnmapBuffer
+#define glFenceSync igvGLCore_glFenceSync
+#define glClientWaitSync igvGLCore_glClientWaitSync
+#define glDeleteSync igvGLCore_glDeleteSync
+#define glGetStringi igvGLCore_glGetStringi
+#define glVertexAttribPointer igvGLCore_glVertexAttribPointer
+#define glVertexAttribIPointer igvGLCore_glVertexAttribIPointer
+#define glVertexAttribDivisor igvGLCore_glVertexAttribDivisor
+#define glVertexAttribI4ui igvGLCore_glVertexAttribI4ui
+#define glVertexAttrib3f igvGLCore_glVertexAttrib3f
+#define glEnableVertexAttribArray igvGLCore_glEnableVertexAttribArray
+#define glDisableVertexAttribArray igvGLCore_glDisableVertexAttribArray
+#define glCreateShader igvGLCore_glCreateShader
+#define glDeleteShader igvGLCore_glDeleteShader
+#define glShaderSource igvGLCore_glShaderSource
+#define glCompileShader igvGLCore_glCompileShader
+#define glGetShaderiv igvGLCore_glGetShaderiv
+#define glGetShaderInfoLog igvGLCore_glGetShaderInfoLog
+#define glCreateProgram igvGLCore_glCreateProgram
+#define glDeleteProgram igvGLCore_glDeleteProgram
+#define glAttachShader igvGLCore_glAttachShader
+#define glLinkProgram igvGLCore_glLinkProgram
+#define glGetProgramiv igvGLCore_glGetProgramiv
+#define glGetProgramInfoLog igvGLCore_glGetProgramInfoLog
+#define glUseProgram igvGLCore_glUseProgram
+#define glGetUniformBlockIndex igvGLCore_glGetUniformBlockIndex
+#define glUniformBlockBinding igvGLCore_glUniformBlockBinding
+#define glGetUniformLocation igvGLCore_glGetUniformLocation
+#define glUniform1i igvGLCore_glUniform1i
+#define glUniform3f igvGLCore_glUniform3f
+#define glUniform4i igvGLCore_glUniform4i
+#define glDrawArraysInstanced igvGLCore_glDrawArraysInstanced
+#define glActiveTexture igvGLCore_glActiveTexture
+#define glTexBuffer igvGLCore_glTexBuffer
+#define glGenQueries igvGLCore_glGenQueries
+#define glBeginQuery igvGLCore_glBeginQuery
+#define glEndQuery igvGLCore_glEndQuery
+#define glGetQueryObjectiv igvGLCore_glGetQueryObjectiv
+#define glGetQueryObjectui64v igvGLCore_glGetQueryObjectui64v
+#define glGenFramebuffers igvGLCore_glGenFramebuffers
+#define glDeleteFramebuffers igvGLCore_glDeleteFramebuffers
+#define glBindFramebuffer igvGLCore_glBindFramebuffer
+#define glFramebufferRenderbuffer igvGLCore_glFramebufferRenderbuffer
+#define glFramebufferTexture igvGLCore_glFramebufferTexture
+#define glDrawBuffers igvGLCore_glDrawBuffers
+#define glClearBufferfv igvGLCore_glClearBufferfv
+#define glClearBufferuiv igvGLCore_glClearBufferuiv
+#define glCheckFramebufferStatus igvGLCore_glCheckFramebufferStatus
+#define glBlitFramebuffer igvGLCore_glBlitFramebuffer
+#define glGenRenderbuffers igvGLCore_glGenRenderbuffers
+#define glDeleteRenderbuffers igvGLCore_glDeleteRenderbuffers
+#define glBindRenderbuffer igvGLCore_glBindRenderbuffer
+#define glRenderbufferStorage igvGLCore_glRenderbufferStorage
+#define glBufferStorage igvGLCore_glBufferStorage
+#define glViewportIndexedf igvGLCore_glViewportIndexedf
+#define glDispatchCompute igvGLCore_glDispatchCompute
+#define glMemoryBarrier igvGLCore_glMemoryBarrier
+#define glMultiDrawArraysIndirect igvGLCore_glMultiDrawArraysIndirect
+#endif   // IGV_GL_CORE_IMPLEMENTATION
+
+#endif   // !(defined(__APPLE__) && defined(__MACH__))
+
+/**
+ * Helper functions to create an OpenGL 3.3 core-profile context and the shader
+ * programs used with it
+ */
+class igvGLCore {
+public:
+    static void request_context(unsigned int display_mode);
+    static bool load();
+    static bool has_extension(const char* name); // of the current context
+
+    static GLuint compile_program(const char* vertex_source, const char* fragment_source,
+                                  const char* geometry_source = nullptr);
+    static GLuint compile_compute_program(const char* compute_source); // 0 without compute shaders
+};
+
+#endif   // __IGVGLCORE
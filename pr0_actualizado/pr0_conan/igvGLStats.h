@@ -0,0 +1,332 @@
+#ifndef __IGVGLSTATS
+#define __IGVGLSTATS
+
+#if defined(__APPLE__) && defined(__MACH__)
+#include <GLUT/glut.h>
+#include <OpenGL/gl.h>
+#include <OpenGL/glu.h>
+#else
+#include <GL/glut.h>
+#endif   // defined(__APPLE__) && defined(__MACH__)
+
+#ifdef IGV_GL_STATS
+
+/**
+ * GL, GLU and GLUT entry points that are routed through the counting wrappers
+ */
+#define IGV_GL_STATS_CALLS(X) \
+    X(glBegin) X(glEnd) X(glVertex3f) X(glColor3f) X(glMaterialfv) X(glLightfv) \
+    X(glEnable) X(glDisable) X(glClear) X(glClearColor) X(glViewport) \
+    X(glMatrixMode) X(glLoadIdentity) X(glPushMatrix) X(glPopMatrix) \
+    X(glTranslatef) X(glRotatef) X(glScalef) X(glLoadMatrixf) X(glMultMatrixf) \
+    X(glOrtho) X(glFrustum) X(glCallList) X(glDrawArrays) \
+    X(glPolygonMode) X(glLineWidth) \
+    X(glGetFloatv) X(glGetIntegerv) X(glGetDoublev) X(glGetBooleanv) \
+    X(glReadPixels) X(glFinish) \
+    X(gluLookAt) X(gluPerspective) X(gluNewQuadric) X(gluDeleteQuadric) \
+    X(gluQuadricDrawStyle) X(gluCylinder) \
+    X(glutSolidCube) X(glutSolidCone) X(glutSolidSphere) \
+    X(glutSwapBuffers) X(glutPostRedisplay)
+
+/**
+ * Labels for the intercepted entry points
+ */
+typedef enum {
+#define IGV_GL_STATS_ENUM(name) IGV_CALL_##name,
+    IGV_GL_STATS_CALLS(IGV_GL_STATS_ENUM)
+#undef IGV_GL_STATS_ENUM
+    IGV_CALL_COUNT
+} igvGLCall;
+
+/**
+ * Counters gathered between two consecutive calls to glutSwapBuffers
+ */
+struct igvGLFrameStats {
+    unsigned long calls[IGV_CALL_COUNT]; ///< Number of calls to each entry point
+    unsigned long vertices; ///< Vertices submitted, including the ones tessellated by GLU/GLUT
+    unsigned long draw_calls; ///< glBegin blocks, GLU/GLUT solids and vertex array draws
+    int max_depth[3]; ///< High-water mark of the modelview, projection and texture stacks
+};
+
+/**
+ * Synchronizing call (glGet*, glReadPixels, glFinish) found inside a callback.
+ * Calls from the same call site and callback share a record
+ */
+struct igvGLStall {
+    const char* call; ///< Name of the synchronizing entry point
+    const char* file; ///< Source file of the call site
+    int line; ///< Line of the call site
+    const char* scope; ///< Callback (or hot scope) the call was made from
+    bool hot; ///< Whether the scope is a hot path
+    unsigned long count; ///< Number of calls
+    double total_ms; ///< Accumulated time blocked in the call
+    double max_ms; ///< Longest time blocked in a single call
+};
+
+#define IGV_GL_MAX_STALLS 32 ///< Number of different stall records that are kept
+
+/**
+ * Types of input events whose input-to-photon latency is measured
+ */
+typedef enum {
+    IGV_INPUT_KEYBOARD, ///< glutKeyboardFunc events
+    IGV_INPUT_SPECIAL, ///< glutSpecialFunc events
+    IGV_INPUT_MENU, ///< Menu selections
+    IGV_INPUT_TYPES
+} igvGLInputType;
+
+#define IGV_GL_MAX_INPUT_EVENTS 64 ///< Input events that can wait for their frame at the same time
+#define IGV_GL_MAX_FENCES 8 ///< Frames whose fence can be pending at the same time
+#define IGV_GL_LATENCY_BUCKETS 10 ///< Buckets of the latency histograms: <1, <2, <4 ... <256, >=256 ms
+
+/**
+ * Input event waiting for the frame that reflects it to be completed by the GPU
+ */
+struct igvGLInputEvent {
+    int type; ///< igvGLInputType of the event, -1 if the slot is free
+    double time; ///< Time the event entered its callback, in ms
+    int fence; ///< Fence of the frame that reflects it, -1 if that frame has not been drawn yet
+    unsigned long after; ///< Events the drawn snapshot must have applied to reflect it (0 = any frame)
+};
+
+/**
+ * Input-to-photon latency histogram of one type of event
+ */
+struct igvGLLatency {
+    unsigned long count; ///< Number of events measured
+    double total_ms; ///< Accumulated latency
+    double max_ms; ///< Longest latency
+    unsigned long buckets[IGV_GL_LATENCY_BUCKETS]; ///< Number of events per latency bucket
+};
+
+#define IGV_GL_MAX_TRACE 65536 ///< Calls kept in the trace of a frame
+
+/**
+ * Call recorded in the trace of a frame
+ */
+struct igvGLTraceEntry {
+    int call; ///< igvGLCall of the entry point
+    float time; ///< Time of the call, relative to the first call of the frame, in ms
+};
+
+/**
+ * Objects of this class keep the per-frame counters of the GL interception layer
+ */
+class igvGLStats {
+private:
+    igvGLFrameStats current; ///< Counters of the frame being drawn
+    igvGLFrameStats last; ///< Counters of the last completed frame
+    unsigned long frame = 0; ///< Number of completed frames
+    unsigned long report_every = 1; ///< Print a report every report_every frames (0 = never)
+    int mode = 0; ///< Matrix stack selected with glMatrixMode
+    int depth[3] = { 1, 1, 1 }; ///< Current depth of each matrix stack
+
+    const char* scope = nullptr; ///< Callback being executed, nullptr outside callbacks
+    bool hot = false; ///< Whether the callback being executed is a hot path
+    igvGLStall stalls[IGV_GL_MAX_STALLS]; ///< Synchronizing calls found inside callbacks
+    int n_stalls = 0; ///< Number of records used in stalls
+    bool hot_stall = false; ///< Whether a synchronizing call has been made from a hot path
+    unsigned long bench_frames = 0; ///< Frames to draw in a benchmark run (0 = no benchmark)
+
+    igvGLInputEvent events[IGV_GL_MAX_INPUT_EVENTS]; ///< Events whose latency is being measured
+    void* fences[IGV_GL_MAX_FENCES]; ///< GLsync objects inserted after glutSwapBuffers
+    igvGLLatency latency[IGV_INPUT_TYPES]; ///< Latency histograms per type of event
+    unsigned long dropped_events = 0; ///< Events not measured because all the slots were in use or they were dropped
+    int sync_support = -1; ///< Whether fence sync objects are available (-1 = not checked yet)
+    bool polling = false; ///< Whether a timer is polling the pending fences
+    int last_event = -1; ///< Slot of the last event timestamped, -1 if it is not measured
+    unsigned long drawn_events = 0; ///< Events applied in the snapshot of the frame being drawn
+
+    bool tracing = false; ///< Whether every call is recorded in the trace of the frame
+    igvGLTraceEntry trace[2][IGV_GL_MAX_TRACE]; ///< Traces of the current and the last frame
+    int trace_current = 0; ///< Trace of the frame being drawn
+    unsigned long trace_length[2] = { 0, 0 }; ///< Calls made in each frame (some may not be kept)
+    double trace_start = 0; ///< Time of the first call of the frame, in ms
+
+    // Implementing the Singleton pattern
+    static igvGLStats* _instance; ///< Pointer to the singleton object of the class
+    igvGLStats();
+
+public:
+    static igvGLStats& getInstance();
+
+    /// Destructor
+    ~igvGLStats() = default;
+
+    // Methods
+    void count(igvGLCall call);
+    void add_vertices(unsigned long n);
+    void draw_call();
+    void matrix_mode(GLenum _mode);
+    void push_matrix();
+    void pop_matrix();
+    void end_frame();
+    void print(const igvGLFrameStats& stats, unsigned long number);
+
+    const char* enter_scope(const char* _scope, bool _hot, bool& previous_hot);
+    void leave_scope(const char* previous, bool previous_hot);
+    void stall(const char* call, const char* file, int line, double ms);
+    void print_stalls();
+
+    void input_event(igvGLInputType type);
+    void defer_input(unsigned long applied);
+    void drop_input();
+    void draw_input(unsigned long applied);
+    void fence_frame();
+    bool poll_fences();
+    void print_latency();
+
+    void enable_trace();
+    const igvGLTraceEntry* get_last_trace(unsigned long& length, unsigned long& kept);
+    static const char* call_name(int call);
+
+    const igvGLFrameStats& get_last_frame();
+    unsigned long get_frame();
+};
+
+/**
+ * Objects of this class mark, while they are alive, the code being executed as a
+ * callback or hot path. Synchronizing calls made inside are reported as stalls
+ */
+class igvGLScope {
+private:
+    const char* previous; ///< Scope active when this one was entered
+    bool previous_hot; ///< Whether the previous scope was a hot path
+
+public:
+    igvGLScope(const char* name, bool hot);
+    ~igvGLScope();
+};
+
+// Counting wrappers, with the same signature as the entry point they replace
+void igvGL_glBegin(GLenum mode);
+void igvGL_glEnd();
+void igvGL_glVertex3f(GLfloat x, GLfloat y, GLfloat z);
+void igvGL_glColor3f(GLfloat r, GLfloat g, GLfloat b);
+void igvGL_glMaterialfv(GLenum face, GLenum pname, const GLfloat* params);
+void igvGL_glLightfv(GLenum light, GLenum pname, const GLfloat* params);
+void igvGL_glEnable(GLenum cap);
+void igvGL_glDisable(GLenum cap);
+void igvGL_glClear(GLbitfield mask);
+void igvGL_glClearColor(GLclampf r, GLclampf g, GLclampf b, GLclampf a);
+void igvGL_glViewport(GLint x, GLint y, GLsizei w, GLsizei h);
+void igvGL_glMatrixMode(GLenum mode);
+void igvGL_glLoadIdentity();
+void igvGL_glPushMatrix();
+void igvGL_glPopMatrix();
+void igvGL_glTranslatef(GLfloat x, GLfloat y, GLfloat z);
+void igvGL_glRotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z);
+void igvGL_glScalef(GLfloat x, GLfloat y, GLfloat z);
+void igvGL_glLoadMatrixf(const GLfloat* m);
+void igvGL_glMultMatrixf(const GLfloat* m);
+void igvGL_glOrtho(GLdouble l, GLdouble r, GLdouble b, GLdouble t, GLdouble n, GLdouble f);
+void igvGL_glFrustum(GLdouble l, GLdouble r, GLdouble b, GLdouble t, GLdouble n, GLdouble f);
+void igvGL_glCallList(GLuint list);
+void igvGL_glDrawArrays(GLenum mode, GLint first, GLsizei count);
+void igvGL_glPolygonMode(GLenum face, GLenum mode);
+void igvGL_glLineWidth(GLfloat width);
+void igvGL_glGetFloatv(GLenum pname, GLfloat* params, const char* file, int line);
+void igvGL_glGetIntegerv(GLenum pname, GLint* params, const char* file, int line);
+void igvGL_glGetDoublev(GLenum pname, GLdouble* params, const char* file, int line);
+void igvGL_glGetBooleanv(GLenum pname, GLboolean* params, const char* file, int line);
+void igvGL_glReadPixels(GLint x, GLint y, GLsizei w, GLsizei h, GLenum format, GLenum type,
+                        GLvoid* pixels, const char* file, int line);
+void igvGL_glFinish(const char* file, int line);
+void igvGL_gluLookAt(GLdouble eyeX, GLdouble eyeY, GLdouble eyeZ,
+                     GLdouble centerX, GLdouble centerY, GLdouble centerZ,
+                     GLdouble upX, GLdouble upY, GLdouble upZ);
+void igvGL_gluPerspective(GLdouble fovy, GLdouble aspect, GLdouble zNear, GLdouble zFar);
+GLUquadric* igvGL_gluNewQuadric();
+void igvGL_gluDeleteQuadric(GLUquadric* quad);
+void igvGL_gluQuadricDrawStyle(GLUquadric* quad, GLenum draw);
+void igvGL_gluCylinder(GLUquadric* quad, GLdouble base, GLdouble top, GLdouble height,
+                       GLint slices, GLint stacks);
+void igvGL_glutSolidCube(GLdouble size);
+void igvGL_glutSolidCone(GLdouble base, GLdouble height, GLint slices, GLint stacks);
+void igvGL_glutSolidSphere(GLdouble radius, GLint slices, GLint stacks);
+void igvGL_glutSwapBuffers();
+void igvGL_glutPostRedisplay();
+
+// Callback registration wrappers: the callbacks are run inside a igvGLScope
+void igvGL_glutDisplayFunc(void (*callback)());
+void igvGL_glutReshapeFunc(void (*callback)(int, int));
+void igvGL_glutKeyboardFunc(void (*callback)(unsigned char, int, int));
+void igvGL_glutSpecialFunc(void (*callback)(int, int, int));
+int igvGL_glutCreateMenu(void (*callback)(int));
+
+// From here on, every translation unit that includes this header calls the wrappers
+#ifndef IGV_GL_STATS_IMPLEMENTATION
+#define glBegin igvGL_glBegin
+#define glEnd igvGL_glEnd
+#define glVertex3f igvGL_glVertex3f
+#define glColor3f igvGL_glColor3f
+#define glMaterialfv igvGL_glMaterialfv
+#define glLightfv igvGL_glLightfv
+#define glEnable igvGL_glEnable
+#define glDisable igvGL_glDisable
+#define glClear igvGL_glClear
+#define glClearColor igvGL_glClearColor
+#define glViewport igvGL_glViewport
+#define glMatrixMode igvGL_glMatrixMode
+#define glLoadIdentity igvGL_glLoadIdentity
+#define glPushMatrix igvGL_glPushMatrix
+#define glPopMatrix igvGL_glPopMatrix
+#define glTranslatef igvGL_glTranslatef
+#define glRotatef igvGL_glRotatef
+#define glScalef igvGL_glScalef
+#define glLoadMatrixf igvGL_glLoadMatrixf
+#define glMultMatrixf igvGL_glMultMatrixf
+#define glOrtho igvGL_glOrtho
+#define glFrustum igvGL_glFrustum
+#define glCallList igvGL_glCallList
+#define glDrawArrays igvGL_glDrawArrays
+#define glPolygonMode igvGL_glPolygonMode
+#define glLineWidth igvGL_glLineWidth
+#define glGetFloatv(pname, params) igvGL_glGetFloatv(pname, params, __FILE__, __LINE__)
+#define glGetIntegerv(pname, params) igvGL_glGetIntegerv(pname, params, __FILE__, __LINE__)
+#define glGetDoublev(pname, params) igvGL_glGetDoublev(pname, params, __FILE__, __LINE__)
+#define glGetBooleanv(pname, params) igvGL_glGetBooleanv(pname, params, __FILE__, __LINE__)
+#define glReadPixels(x, y, w, h, format, type, pixels) \
+    igvGL_glReadPixels(x, y, w, h, format, type, pixels, __FILE__, __LINE__)
+#define glFinish() igvGL_glFinish(__FILE__, __LINE__)
+#define gluLookAt igvGL_gluLookAt
+#define gluPerspective igvGL_gluPerspective
+#define gluNewQuadric igvGL_gluNewQuadric
+#define gluDeleteQuadric igvGL_gluDeleteQuadric
+#define gluQuadricDrawStyle igvGL_gluQuadricDrawStyle
+#define gluCylinder igvGL_gluCylinder
+#define glutSolidCube igvGL_glutSolidCube
+#define glutSolidCone igvGL_glutSolidCone
+#define glutSolidSphere igvGL_glutSolidSphere
+#define glutSwapBuffers igvGL_glutSwapBuffers
+#define glutPostRedisplay igvGL_glutPostRedisplay
+#define glutDisplayFunc igvGL_glutDisplayFunc
+#define glutReshapeFunc igvGL_glutReshapeFunc
+#define glutKeyboardFunc igvGL_glutKeyboardFunc
+#define glutSpecialFunc igvGL_glutSpecialFunc
+#define glutCreateMenu igvGL_glutCreateMenu
+#endif   // IGV_GL_STATS_IMPLEMENTATION
+
+#endif   // IGV_GL_STATS
+
+// Marks the rest of the enclosing block as a hot path: a synchronizing GL call
+// made inside makes a benchmark run fail
+#ifdef IGV_GL_STATS
+#define IGV_GL_HOT_SCOPE(name) igvGLScope igv_gl_hot_scope(name, true)
+#else
+#define IGV_GL_HOT_SCOPE(name)
+#endif   // IGV_GL_STATS
+
+// With --threaded-input the event of a callback is reflected by the first frame drawn
+// from a snapshot that has applied it, not by the next frame swapped
+#ifdef IGV_GL_STATS
+#define IGV_GL_INPUT_AFTER(applied) igvGLStats::getInstance().defer_input(applied)
+#define IGV_GL_INPUT_DROPPED() igvGLStats::getInstance().drop_input()
+#define IGV_GL_INPUT_DRAWN(applied) igvGLStats::getInstance().draw_input(applied)
+#else
+#define IGV_GL_INPUT_AFTER(applied)
+#define IGV_GL_INPUT_DROPPED()
+#define IGV_GL_INPUT_DRAWN(applied)
+#endif   // IGV_GL_STATS
+
+#endif   // __IGVGLSTATS
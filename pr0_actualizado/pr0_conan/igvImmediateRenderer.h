@@ -0,0 +1,81 @@
+#ifndef __IGVIMMEDIATERENDERER
+#define __IGVIMMEDIATERENDERER
+
+#include <vector>
+
+#include "igvRenderer.h"
+
+/**
+ * Tessellation of a GLU quadric, generated the first time it is drawn and kept
+ * for the next draws
+ */
+struct igvQuadricMesh {
+    int slices; ///< Subdivisions around the axis
+    int stacks; ///< Subdivisions along the axis
+    std::vector<igvVertex> vertices; ///< Triangles of the quadric, of radius 1
+};
+
+/**
+ * Mesh submitted while the frame is drawn in several views, kept until
+ * end_frame draws it in each of them
+ */
+struct igvSubmission {
+    igvMesh mesh; ///< Mesh to draw
+    igvMaterial material; ///< Appearance of the mesh
+    igvMat4 transform; ///< Modeling matrix of the mesh
+    igvViewMask visible; ///< Views the mesh is drawn in
+};
+
+/**
+ * Renderer that submits every mesh with the legacy fixed-function pipeline:
+ * glBegin/glEnd and GLUT solids, with the transforms loaded in the modelview
+ * matrix and the materials set with glMaterialfv or glColor. The GLU quadrics
+ * are tessellated once per number of slices and stacks, as gluCylinder would,
+ * and drawn from those vertex arrays; the radius comes with the transform. With
+ * several views, the meshes are kept when submitted and drawn in every view by
+ * end_frame, so the scene is still traversed once
+ */
+class igvImmediateRenderer: public igvRenderer {
+protected:
+    igvMat4 view; ///< View matrix of the camera
+    igvVec4 light; ///< Position of the point light, in world coordinates
+    bool has_light = false; ///< Whether the scene has set a point light
+    std::vector<igvQuadricMesh> cylinders; ///< Cylinders tessellated so far
+    std::vector<igvSubmission> submissions; ///< Meshes of the frame, if drawn in several views; keeps its capacity
+    unsigned long draw_calls = 0; ///< Draw calls issued since begin_frame
+
+    // Fixed-function state, to skip redundant changes
+    int lighting = -1; ///< Whether GL_LIGHTING is enabled (-1 = unknown)
+    GLenum polygon_mode = 0; ///< Current polygon mode (0 = unknown)
+    GLfloat line_width = 0; ///< Current line width (0 = unknown)
+
+public:
+    /// Default constructor
+    igvImmediateRenderer() = default;
+
+    /// Destructor
+    ~igvImmediateRenderer() override = default;
+
+    // Methods
+    const char* get_name() override;
+    bool initialize() override;
+
+    void set_camera(const igvMat4& projection, const igvMat4& _view) override;
+    void set_light(const igvVec4& position) override;
+
+    void begin_frame() override;
+    void submit(igvMesh mesh, const igvMaterial& material, const igvMat4& transform) override;
+    unsigned long end_frame() override;
+
+protected:
+    void load_camera(const igvMat4& projection, const igvMat4& _view);
+    void place_light();
+    void apply_material(const igvMaterial& material);
+    void draw_submission(igvMesh mesh, const igvMaterial& material, const igvMat4& transform);
+    virtual void draw_mesh(igvMesh mesh);
+
+    const igvQuadricMesh& get_cylinder(int slices, int stacks);
+    static void draw_vertices(const std::vector<igvVertex>& vertices);
+};
+
+#endif   // __IGVIMMEDIATERENDERER
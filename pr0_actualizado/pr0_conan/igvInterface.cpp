@@ -1,5 +1,9 @@
 #include <cstdlib>
+#include <cstring>
 #include "igvInterface.h"
+#include "igvGLCore.h"
+#include "igvFlightRecorder.h"
+#include "igvFrameArena.h"
 #include <math.h>
 #include <vector>
 
@@ -7,8 +11,8 @@
 igvInterface* igvInterface::_instance = nullptr;
 
 struct ObjectState {
-    float tx = 0.0f, ty = 0.0f, tz = 0.0f; // translation
-    float rx = 0.0f, ry = 0.0f, rz = 0.0f; // rotation
+    igvVec3 t;                             // translation
+    float rx = 0.0f, ry = 0.0f, rz = 0.0f; // rotation (degrees)
     float scale = 1.0f;                    // scale
 };
 
@@ -30,6 +34,7 @@ struct Camera {
 
 static bool cameraMode = false; // true = move camera, false = move object
 static Camera cam;
+static igvMat4 projection; // projection matrix, rebuilt by reshapeFunc
 
 enum class TransformType {
     TRANSLATE,
@@ -75,7 +80,11 @@ igvInterface& igvInterface::getInstance()
  *               display window
  * @param _title Title of the display window
  * @pre It is assumed that all parameters have valid values
- * @post Changes the height and width of the window stored in the object
+ * @post Changes the height and width of the window stored in the object. The
+ *       renderer backend is chosen with --renderer=<name> (immediate by default).
+ *       With --headless, no window is created and the objects are drawn to files
+ *       by start_display_loop, which needs a backend that draws to memory;
+ *       --frames=<n> draws each of them n times, so the steady frames can be checked
  */
 void igvInterface::configure_environment(int argc, char **argv, int _window_width, int _window_height, int _pos_X,
                                          int _pos_Y, std::string _title)
@@ -84,15 +93,51 @@ void igvInterface::configure_environment(int argc, char **argv, int _window_widt
     window_width = _window_width;
     window_height = _window_height;
 
+    const char* renderer_name = "immediate";
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--renderer=", 11) == 0) {
+            renderer_name = argv[i] + 11;
+        } else if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (strncmp(argv[i], "--frames=", 9) == 0 && atoi(argv[i] + 9) > 0) {
+            headless_frames = atoi(argv[i] + 9);
+        } else {
+            fprintf(stderr, "Unknown option %s (use --renderer=<name>, --headless or --frames=<n>)\n", argv[i]);
+        }
+    }
+
+    renderer = igvRenderer::create(renderer_name);
+    if (!renderer) {
+        fprintf(stderr, "Unknown renderer %s (available: %s)\n", renderer_name, igvRenderer::get_names());
+        exit(1);
+    }
+    if (headless && renderer->requires_window()) {
+        fprintf(stderr, "The %s renderer needs a window; use --renderer=software with --headless\n",
+                renderer->get_name());
+        exit(1);
+    }
+
     // initialization of the display window
-    glutInit(&argc, argv);
-    glutInitDisplayMode(GLUT_RGB | GLUT_DOUBLE | GLUT_DEPTH);
-    glutInitWindowSize(_window_width,_window_height);
-    glutInitWindowPosition(_pos_X,_pos_Y);
-    glutCreateWindow(_title.c_str());
-
-    glEnable(GL_DEPTH_TEST); // activates Z-buffer face culling
-    glClearColor(0.0,0.0,0.0,0.0); // sets the window background color
+    if (!headless) {
+        glutInit(&argc, argv);
+        // the core backend needs an OpenGL 3.3 core-profile context
+        if (renderer->requires_core_profile()) {
+            igvGLCore::request_context(GLUT_RGB | GLUT_DOUBLE | GLUT_DEPTH);
+        } else {
+            glutInitDisplayMode(GLUT_RGB | GLUT_DOUBLE | GLUT_DEPTH);
+        }
+        glutInitWindowSize(_window_width,_window_height);
+        glutInitWindowPosition(_pos_X,_pos_Y);
+        glutCreateWindow(_title.c_str());
+    }
+
+    // the renderer activates Z-buffer face culling
+    if (!renderer->initialize()) {
+        fprintf(stderr, "The %s renderer is not available\n", renderer->get_name());
+        exit(1);
+    }
+    renderer->set_clear_color(0.0,0.0,0.0); // sets the window background color
+    fprintf(stderr, "[renderer] drawing with the %s renderer\n", renderer->get_name());
 }
 
 /**
@@ -100,9 +145,44 @@ void igvInterface::configure_environment(int argc, char **argv, int _window_widt
  */
 void igvInterface::start_display_loop()
 {
+    if (headless) {
+        render_headless();
+        return;
+    }
     glutMainLoop(); // starts the GLUT display loop
 }
 
+/**
+ * Method to draw every object without a window, as many frames as --frames asks,
+ * and save the last frame of each one to pr1_object<1|2|3>.ppm in the working
+ * directory. Each object starts a new warm-up of CGV_ARENA_CHECK; if a frame
+ * after it allocates from the heap, the program exits with 1 once all are drawn
+ */
+void igvInterface::render_headless()
+{
+    reshapeFunc(window_width, window_height);
+    for (int i = 0; i < 3; i++) {
+        selected = i;
+        igvFrameArena::getInstance().restart_check();
+        for (int frame = 0; frame < headless_frames; frame++) {
+            displayFunc();
+        }
+
+        std::string path = "pr1_object" + std::to_string(i + 1) + ".ppm";
+        if (renderer->save_frame(path.c_str())) {
+            printf("%s\n", path.c_str());
+        } else {
+            fprintf(stderr, "Could not write %s\n", path.c_str());
+        }
+    }
+
+    unsigned long allocations = igvFrameArena::getInstance().get_checked_allocations();
+    if (allocations > 0) {
+        fprintf(stderr, "[arena] %lu heap allocations after the warm-up frames\n", allocations);
+        exit(1);
+    }
+}
+
 /**
  * Method for controlling keyboard events
  * @param key Code of the key pressed
@@ -115,29 +195,29 @@ void igvInterface::start_display_loop()
  *       change
  */
 
+// Rotation of an object: Rx * Ry * Rz (Z is applied first, same as OpenGL)
+igvQuat objectRotation(const ObjectState& o) {
+    return igvQuat::axis_angle(o.rx, igvVec3(1, 0, 0)) *
+           igvQuat::axis_angle(o.ry, igvVec3(0, 1, 0)) *
+           igvQuat::axis_angle(o.rz, igvVec3(0, 0, 1));
+}
+
 // Apply object's local rotation to a translation vector (convert local -> world)
-void applyLocalTranslation(const ObjectState& o, float tx, float ty, float tz, float& outX, float& outY, float& outZ) {
-    float rx = o.rx * M_PI / 180.0f;
-    float ry = o.ry * M_PI / 180.0f;
-    float rz = o.rz * M_PI / 180.0f;
-
-    float cx = cos(rx), sx = sin(rx);
-    float cy = cos(ry), sy = sin(ry);
-    float cz = cos(rz), sz = sin(rz);
-
-    // Z * Y * X rotation order (same as OpenGL)
-    outX = cy * cz * tx + (-cy * sz) * ty + sy * tz;
-    outY = (sx * sy * cz + cx * sz) * tx +
-           (-sx * sy * sz + cx * cz) * ty +
-           (-sx * cy) * tz;
-    outZ = (-cx * sy * cz + sx * sz) * tx +
-           (cx * sy * sz + sx * cz) * ty +
-           (cx * cy) * tz;
+igvVec3 applyLocalTranslation(const ObjectState& o, const igvVec3& t) {
+    return objectRotation(o).rotate(t);
+}
+
+// Multiply a matrix by the modeling transform of an object: T * Rx * Ry * Rz * S
+void applyObjectTransform(const ObjectState& o, igvMat4& m) {
+    m = m * igvMat4::translation(o.t[X], o.t[Y], o.t[Z]) * igvMat4::rotation(objectRotation(o)) *
+        igvMat4::scaling(o.scale, o.scale, o.scale);
 }
 
 
 void igvInterface::keyboardFunc(unsigned char key, int x, int y)
 {
+    igvFlightRecorder::getInstance().input("keyboardFunc", key, x, y);
+
     switch (key)
     {
         case 27: exit(1); break; // Escape
@@ -160,46 +240,33 @@ void igvInterface::keyboardFunc(unsigned char key, int x, int y)
         case 'M': {
             if (bufferMode || transformBuffer.empty()) break; // Only apply if not recording and buffer is not empty
 
-            // Create a temporary matrix to apply the buffered transformations
-            glMatrixMode(GL_MODELVIEW);
-            glPushMatrix();
-            glLoadIdentity();
+            // Compose the buffered transformations on the CPU
+            igvMat4 mat;
 
             // Apply each transformation from the buffer in order
             for (const auto& op : transformBuffer) {
                 if (op.type == TransformType::TRANSLATE) {
-                    glTranslatef(op.x, op.y, op.z);
+                    mat.translate(op.x, op.y, op.z);
                 } else if (op.type == TransformType::ROTATE) {
-                    glRotatef(op.value, op.x, op.y, op.z);
+                    mat.rotate(op.value, op.x, op.y, op.z);
                 } else if (op.type == TransformType::SCALE) {
-                    glScalef(op.value, op.value, op.value);
+                    mat.scale(op.value, op.value, op.value);
                 }
             }
 
-            glTranslatef(obj[selected].tx, obj[selected].ty, obj[selected].tz);
-            glRotatef(obj[selected].rx, 1, 0, 0);
-            glRotatef(obj[selected].ry, 0, 1, 0);
-            glRotatef(obj[selected].rz, 0, 0, 1);
-            glScalef(obj[selected].scale, obj[selected].scale, obj[selected].scale);
-
-            // Get the resulting matrix
-            float mat[16];
-            glGetFloatv(GL_MODELVIEW_MATRIX, mat);
-            glPopMatrix();
+            applyObjectTransform(obj[selected], mat);
 
-            obj[selected].tx = mat[12];
-            obj[selected].ty = mat[13];
-            obj[selected].tz = mat[14];
+            obj[selected].t = mat.column(3).xyz();
 
             // Extract scale
-            float scaleX = sqrt(mat[0]*mat[0] + mat[1]*mat[1] + mat[2]*mat[2]);
+            float scaleX = length(mat.column(0).xyz());
             obj[selected].scale = scaleX;
 
             // Extract rotation
-            obj[selected].ry = asin(-mat[2]) * 180.0 / M_PI;
+            obj[selected].ry = asin(-mat(2, 0)) * 180.0 / M_PI;
             float cosY = cos(obj[selected].ry * M_PI / 180.0);
-            obj[selected].rx = atan2(mat[6] / cosY, mat[10] / cosY) * 180.0 / M_PI;
-            obj[selected].rz = atan2(mat[1] / cosY, mat[0] / cosY) * 180.0 / M_PI;
+            obj[selected].rx = atan2(mat(2, 1) / cosY, mat(2, 2) / cosY) * 180.0 / M_PI;
+            obj[selected].rz = atan2(mat(1, 0) / cosY, mat(0, 0) / cosY) * 180.0 / M_PI;
 
             printf("Applied buffered transform sequence\n");
             break;
@@ -208,11 +275,11 @@ void igvInterface::keyboardFunc(unsigned char key, int x, int y)
         // Translation Y
         case 'U':
             if (bufferMode) transformBuffer.push_back({TransformType::TRANSLATE, 0.0f, 0.1f, 0.0f});
-            else { float dx, dy, dz; applyLocalTranslation(obj[selected], 0.0f, 0.1f, 0.0f, dx, dy, dz); obj[selected].tx += dx; obj[selected].ty += dy; obj[selected].tz += dz; }
+            else obj[selected].t += applyLocalTranslation(obj[selected], igvVec3(0.0f, 0.1f, 0.0f));
             break;
         case 'u':
             if (bufferMode) transformBuffer.push_back({TransformType::TRANSLATE, 0.0f, -0.1f, 0.0f});
-            else { float dx, dy, dz; applyLocalTranslation(obj[selected], 0.0f, -0.1f, 0.0f, dx, dy, dz); obj[selected].tx += dx; obj[selected].ty += dy; obj[selected].tz += dz; }
+            else obj[selected].t += applyLocalTranslation(obj[selected], igvVec3(0.0f, -0.1f, 0.0f));
             break;
 
         // Rotation X
@@ -320,6 +387,8 @@ void igvInterface::keyboardFunc(unsigned char key, int x, int y)
 }
 
 void igvInterface::specialFunc(int key, int x, int y) {
+    igvFlightRecorder::getInstance().input("specialFunc", key, x, y);
+
     if (cameraMode) {
         // Camera orbit movement
         switch (key) {
@@ -346,11 +415,7 @@ void igvInterface::specialFunc(int key, int x, int y) {
             }
         } else {
             // Apply translation
-            float dx, dy, dz;
-            applyLocalTranslation(obj[selected], local_dx, 0.0f, local_dz, dx, dy, dz);
-            obj[selected].tx += dx;
-            obj[selected].ty += dy;
-            obj[selected].tz += dz;
+            obj[selected].t += applyLocalTranslation(obj[selected], igvVec3(local_dx, 0.0f, local_dz));
         }
     }
 
@@ -367,128 +432,130 @@ void igvInterface::specialFunc(int key, int x, int y) {
 void igvInterface::reshapeFunc(int w, int h)
 {
     // resize the viewport to the new window width and height
-   glViewport(0,0,(GLsizei) w,(GLsizei) h);
+   _instance->renderer->set_viewport(0,0,(GLsizei) w,(GLsizei) h);
 
    // we save new values from the display window
    _instance->set_window_width( w );
    _instance->set_window_height( h );
 
     // Projection setup
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-
     float aspect = (float)w / (float)h;
 
     if (cam.perspective) {
-        gluPerspective(60.0, aspect, cam.nearPlane, cam.farPlane);
+        projection = igvMat4::perspective(60.0, aspect, cam.nearPlane, cam.farPlane);
     } else {
         float orthoSize = cam.radius; // roughly match zoom level
-        glOrtho(-orthoSize * aspect, orthoSize * aspect,
-                -orthoSize, orthoSize,
-                cam.nearPlane, cam.farPlane);
+        projection = igvMat4::ortho(-orthoSize * aspect, orthoSize * aspect,
+                                    -orthoSize, orthoSize,
+                                    cam.nearPlane, cam.farPlane);
     }
-
-
-    glMatrixMode(GL_MODELVIEW);
 }
 
 /**
  * Method for displaying the scene
  */
 
-void prepare_outlines(float r, float g, float b, float width) {
-    glColor3f(r,g,b);
-    glLineWidth(width);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-}
+// Material of the white outlines drawn over the selected object
+static const igvMaterial outlines = { { 1.0, 1.0, 1.0 }, false, GL_LINE, 2.0f };
 
 void igvInterface::displayFunc()
 {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // clears the window and the Z-buffer
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity(); // reset modelview
-    float radA = cam.azimuth * M_PI / 180.0f;
-    float radE = cam.elevation * M_PI / 180.0f;
-
-    float eyeX = cam.radius * cos(radE) * cos(radA);
-    float eyeY = cam.radius * sin(radE);
-    float eyeZ = cam.radius * cos(radE) * sin(radA);
-
-    gluLookAt(eyeX, eyeY, eyeZ,
-              0.0, 0.0, 0.0,  // always look at origin
-              0.0, 1.0, 0.0);
-
-    // Section A: paint the axes
-    glBegin(GL_LINES);
-
-    // X axis - red
-    glColor3f(1.0, 0.0, 0.0);
-    glVertex3f(-20.0, 0.0, 0.0);
-    glVertex3f( 20.0, 0.0, 0.0);
-
-    // Y axis - green
-    glColor3f(0.0, 1.0, 0.0);
-    glVertex3f(0.0, -20.0, 0.0);
-    glVertex3f(0.0,  20.0, 0.0);
-
-    // Z axis - blue
-    glColor3f(0.0, 0.0, 1.0);
-    glVertex3f(0.0, 0.0, -20.0);
-    glVertex3f(0.0, 0.0,  20.0);
-
-    glEnd();
+    igvFlightRecorder& recorder = igvFlightRecorder::getInstance();
+    recorder.begin_frame();
+    recorder.value("selected", selected);
+    recorder.value("cameraMode", cameraMode);
+    recorder.value("radius", cam.radius);
+    recorder.value("azimuth", cam.azimuth);
+    recorder.value("elevation", cam.elevation);
+    recorder.value("nearPlane", cam.nearPlane);
+    recorder.value("farPlane", cam.farPlane);
+    recorder.value("perspective", cam.perspective);
+    recorder.value("bufferMode", bufferMode);
+    recorder.value("transformBuffer", transformBuffer.size());
+
+    // the renderers that outline the filled meshes in a post-process replace the wireframe pass
+    bool outlined = _instance->renderer->set_outlines(true, outlines.color);
+    _instance->renderer->clear(); // clears the window and the Z-buffer
+    float angles[2] = { cam.azimuth * (float) M_PI / 180.0f, cam.elevation * (float) M_PI / 180.0f };
+    float sines[2], cosines[2];
+    igv_sincos(angles, sines, cosines, 2);
+
+    igvVec3 eye(cam.radius * cosines[1] * cosines[0],
+                cam.radius * sines[1],
+                cam.radius * cosines[1] * sines[0]);
+
+    igvMat4 view = igvMat4::look_at(eye,
+                                    igvVec3(0.0, 0.0, 0.0),  // always look at origin
+                                    igvVec3(0.0, 1.0, 0.0));
+
+    igvRenderer* renderer = _instance->renderer;
+    renderer->set_camera(projection, view);
+    renderer->begin_frame();
+
+    // Section A: paint the axes, red X, green Y and blue Z
+    igvMaterial axes = { { 0.0, 0.0, 0.0 }, false, GL_FILL, 1.0f };
+    igvMat4 transform = igvMat4::scaling(20.0, 20.0, 20.0);
+    renderer->submit(IGV_MESH_AXES, axes, transform);
 
     // Section C: object drawing
-    glPushMatrix();
-    glColor3f(1.0, 1.0, 1.0);
-    glTranslatef(obj[selected].tx, obj[selected].ty, obj[selected].tz);
-    glRotatef(obj[selected].rx, 1, 0, 0);
-    glRotatef(obj[selected].ry, 0, 1, 0);
-    glRotatef(obj[selected].rz, 0, 0, 1);
-    glScalef(obj[selected].scale, obj[selected].scale, obj[selected].scale);
+    transform = igvMat4();
+    applyObjectTransform(obj[selected], transform);
 
     // object selection execution
     if (selected == 0) {
         // cube
-        glColor3f(1.0, 0.0, 0.0);
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        glutSolidCube(1.0);
-        // outlines
-        prepare_outlines(1.0, 1.0, 1.0, 2.0f);
-        glutSolidCube(1.0);
+        igvMaterial cube = { { 1.0, 0.0, 0.0 }, false, GL_FILL, 1.0f };
+        renderer->submit(IGV_MESH_CUBE, cube, transform);
+        // outlines, unless the renderer draws them
+        if (!outlined) {
+            renderer->submit(IGV_MESH_CUBE, outlines, transform);
+        }
     }
     else if (selected == 1) {
         // cone
-        glColor3f(0.0, 1.0, 0.0);
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        glutSolidCone(0.5, 1.0, 32, 32);
-        // outlines
-        prepare_outlines(1.0, 1.0, 1.0, 2.0f);
-        glutSolidCone(0.5, 1.0, 32, 32);
+        igvMaterial cone = { { 0.0, 1.0, 0.0 }, false, GL_FILL, 1.0f };
+        transform.scale(0.5, 0.5, 1.0);
+        renderer->submit(IGV_MESH_CONE, cone, transform);
+        // outlines, unless the renderer draws them
+        if (!outlined) {
+            renderer->submit(IGV_MESH_CONE, outlines, transform);
+        }
     }
     else if (selected == 2) {
         // sphere
-        glColor3f(0.0, 0.0, 1.0);
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        glutSolidSphere(0.5, 32, 32);
-        // outlines
-        prepare_outlines(1.0, 1.0, 1.0, 2.0f);
-        glutSolidSphere(0.5, 32, 32);
+        igvMaterial sphere = { { 0.0, 0.0, 1.0 }, false, GL_FILL, 1.0f };
+        transform.scale(0.5, 0.5, 0.5);
+        renderer->submit(IGV_MESH_SPHERE, sphere, transform);
+        // outlines, unless the renderer draws them
+        if (!outlined) {
+            renderer->submit(IGV_MESH_SPHERE, outlines, transform);
+        }
     }
 
-    // reset
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glLineWidth(1.0f);
-
-    glPopMatrix(); // restores the modeling matrix
-    glutSwapBuffers(); // used instead of glFlush() to prevent flickering
+    renderer->end_frame();
+    if (!_instance->headless) {
+        renderer->present();
+    }
+    recorder.value("streamed_bytes", renderer->get_streamed_bytes());
+    recorder.value("stream_waits", renderer->get_stream_waits());
+    recorder.value("culled_instances", renderer->get_culled_instances());
+
+    // the buffers have been swapped: the data of the frame is no longer needed
+    igvFrameArena& arena = igvFrameArena::getInstance();
+    recorder.value("arena_bytes", arena.get_used());
+    recorder.value("heap_allocations", arena.get_frame_allocations());
+    arena.reset();
+    recorder.end_frame();
 }
 
 /**
  * Method to initialize callbacks
  */
 void igvInterface::initialize_callbacks()
-{  glutKeyboardFunc(keyboardFunc);
+{  if (headless) {
+      return; // there is no window to receive events
+   }
+   glutKeyboardFunc(keyboardFunc);
    glutReshapeFunc(reshapeFunc);
    glutDisplayFunc(displayFunc);
    glutSpecialFunc(specialFunc); // register arrow keys
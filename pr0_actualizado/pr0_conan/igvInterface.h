@@ -14,6 +14,9 @@
 
 #endif   // defined(__APPLE__) && defined(__MACH__)
 
+#include "igvGLStats.h"
+#include "igvRenderer.h"
+
 #include <string>
 
 /**
@@ -24,6 +27,9 @@ class igvInterface
 		// Atributos
       int window_width = 0; ///< Initial width of the display window
       int window_height = 0;  ///< Initial height of the display window
+      igvRenderer* renderer = nullptr; ///< Renderer backend the scene is drawn with
+      bool headless = false; ///< Whether the objects are drawn to files instead of a window
+      int headless_frames = 1; ///< Frames each object is drawn with --headless, set with --frames=<n>
 
       // Application of the Singleton pattern
       static igvInterface* _instance;   ///< Pointer to the only object of the class
@@ -57,6 +63,8 @@ class igvInterface
 
       void start_display_loop(); // display the scene and wait for events on the interface
 
+      void render_headless(); // draws every object and saves them as PPM files
+
       // get_ and set_ methods for accessing attributes
 
       int get_window_width();
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <stdio.h>
+
+#include "igvRenderTarget.h"
+
+/**
+* Makes the target the framebuffer drawn to and read from. The first call
+* creates it, loading the entry points if the backend has not loaded them, and
+* the renderbuffers are reallocated when they are smaller than the size asked
+* for; new renderbuffers are cleared with the current clear color
+* @param _width Width drawn to, in pixels
+* @param _height Height drawn to, in pixels
+* @retval true If the target is bound
+* @retval false If the context has no framebuffer objects, or the target is not
+* complete; the frames keep going to the window
+*/
+bool igvRenderTarget::bind(GLsizei _width, GLsizei _height)
+{
+#if !(defined(__APPLE__) && defined(__MACH__))
+    if (!glBindFramebuffer && !igvGLCore::load())
+    { return false;
+    }
+#endif   // !(defined(__APPLE__) && defined(__MACH__))
+
+    if (!framebuffer)
+    { glGenFramebuffers(1, &framebuffer);
+        glGenRenderbuffers(1, &color);
+        glGenRenderbuffers(1, &depth);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    if (_width <= width && _height <= height)
+    { return true;
+    }
+
+    width = std::max(width, _width);
+    height = std::max(height, _height);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    { fprintf(stderr, "[renderer] the offscreen target of %dx%d pixels is not complete\n", width, height);
+        release();
+        return false;
+    }
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    return true;
+}
+
+/**
+* Stretches the frame drawn to the target over the window, with linear
+* filtering, and binds the target again
+* @param src_width Width of the frame in the target, from its left edge
+* @param src_height Height of the frame in the target, from its bottom edge
+* @param dst_width Width it covers in the window, from its left edge
+* @param dst_height Height it covers in the window, from its bottom edge
+* @pre The target is bound
+*/
+void igvRenderTarget::blit(GLsizei src_width, GLsizei src_height, GLsizei dst_width, GLsizei dst_height)
+{ glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, src_width, src_height, 0, 0, dst_width, dst_height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+}
+
+/**
+* Frees the framebuffer and its renderbuffers, and makes the window the
+* framebuffer drawn to again. The next bind creates them again
+*/
+void igvRenderTarget::release()
+{ if (!framebuffer)
+    { return;
+    }
+    unbind();
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &color);
+    glDeleteRenderbuffers(1, &depth);
+    framebuffer = color = depth = 0;
+    width = height = 0;
+}
+
+/**
+* Method to query the framebuffer object of the target
+* @return The framebuffer, or 0 if it has not been created or has been released
+*/
+GLuint igvRenderTarget::get_framebuffer()
+{ return framebuffer;
+}
+
+/**
+* Makes the window the framebuffer drawn to and read from
+*/
+void igvRenderTarget::unbind()
+{
+#if !(defined(__APPLE__) && defined(__MACH__))
+    if (!glBindFramebuffer)
+    { return;
+    }
+#endif   // !(defined(__APPLE__) && defined(__MACH__))
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,40 @@
+#ifndef __IGVRENDERTARGET
+#define __IGVRENDERTARGET
+
+#include "igvGLCore.h"
+
+/**
+ * Offscreen framebuffer with a color and a depth renderbuffer, for the backends
+ * that draw with OpenGL at a lower resolution than the window. The frames are
+ * drawn to it, and blit stretches them to the window with linear filtering. The
+ * renderbuffers grow to hold the largest size bound and never shrink, so the
+ * resolution can change on every frame without allocating
+ */
+class igvRenderTarget {
+private:
+    GLuint framebuffer = 0; ///< Framebuffer object
+    GLuint color = 0; ///< RGBA8 color renderbuffer
+    GLuint depth = 0; ///< 24-bit depth renderbuffer
+    GLsizei width = 0; ///< Width of the renderbuffers, in pixels
+    GLsizei height = 0; ///< Height of the renderbuffers, in pixels
+
+public:
+    /// Default constructor. The framebuffer is created by the first bind
+    igvRenderTarget() = default;
+
+    /// Destructor
+    ~igvRenderTarget() = default;
+
+    igvRenderTarget(const igvRenderTarget&) = delete;
+    igvRenderTarget& operator=(const igvRenderTarget&) = delete;
+
+    // Methods
+    bool bind(GLsizei _width, GLsizei _height); // the next draws go to the target
+    void blit(GLsizei src_width, GLsizei src_height, GLsizei dst_width, GLsizei dst_height); // to the window
+    void release(); // frees the framebuffer, and draws to the window again
+    GLuint get_framebuffer(); // 0 if it has not been created
+
+    static void unbind(); // the next draws go to the window
+};
+
+#endif   // __IGVRENDERTARGET
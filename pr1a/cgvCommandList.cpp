@@ -0,0 +1,335 @@
+#include <cstring>
+
+#include "cgvCommandList.h"
+
+// Names of the meshes and commands, for dump
+static const char* mesh_names[CGV_MESHES] = { "cube", "sphere", "cone", "cylinder", "axes" };
+static const char* command_names[CGV_CMD_TYPES] = { "material", "transform", "draw", "grid" };
+
+// Whether two materials give the same appearance
+static bool same_material(const cgvMaterial& a, const cgvMaterial& b)
+{ return a.color[0] == b.color[0] && a.color[1] == b.color[1] && a.color[2] == b.color[2]
+           && a.lit == b.lit && a.polygon_mode == b.polygon_mode && a.line_width == b.line_width;
+}
+
+/**
+* Removes all the commands. The vectors keep their capacity, so recording the
+* same scene again does not allocate
+*/
+void cgvCommandList::clear()
+{ commands.clear();
+    materials.clear();
+    transforms.clear();
+    grids.clear();
+    lights.clear();
+    current_material = UINT32_MAX;
+}
+
+/**
+* Records a change of the current material, unless it is already the current one
+* @param material Material of the next draws
+*/
+void cgvCommandList::set_material(const cgvMaterial& material)
+{ if (current_material != UINT32_MAX && same_material(materials[current_material], material))
+    { return;
+    }
+
+    uint32_t index = add_material(material);
+    commands.push_back({ CGV_CMD_SET_MATERIAL, index });
+    current_material = index;
+}
+
+/**
+* Finds a material in the table, adding it if it is not there
+* @param material Material to find
+* @return Its index in the table
+*/
+uint32_t cgvCommandList::add_material(const cgvMaterial& material)
+{ uint32_t index = 0;
+    while (index < materials.size() && !same_material(materials[index], material))
+    { index++;
+    }
+    if (index == materials.size())
+    { materials.push_back(material);
+    }
+    return index;
+}
+
+/**
+* Records a change of the current transform, unless it is already the current one
+* @param transform Modeling matrix of the next draws
+*/
+void cgvCommandList::set_transform(const cgvMat4& transform)
+{ if (!transforms.empty() && memcmp(transforms.back().data(), transform.data(), sizeof(transform.m)) == 0)
+    { return;
+    }
+    commands.push_back({ CGV_CMD_SET_TRANSFORM, (uint32_t) transforms.size() });
+    transforms.push_back(transform);
+}
+
+/**
+* Records a draw of a mesh with the current material and transform
+* @param mesh Mesh to draw
+* @pre A material and a transform have been recorded before
+*/
+void cgvCommandList::draw_mesh(cgvMesh mesh)
+{ commands.push_back({ CGV_CMD_DRAW_MESH, (uint32_t) mesh });
+}
+
+/**
+* Records a mesh as cgvRenderer::submit would draw it
+* @param mesh Mesh to draw
+* @param material Appearance of the mesh
+* @param transform Modeling matrix of the mesh
+*/
+void cgvCommandList::submit(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& transform)
+{ set_material(material);
+    set_transform(transform);
+    draw_mesh(mesh);
+}
+
+/**
+* Records a draw of a grid of copies of a mesh with the current material and
+* transform, which places the copy in the cell (0, 0, 0)
+* @param mesh Mesh to draw in each cell
+* @param grid Cells of the grid and distance between them
+* @pre A material and a transform have been recorded before
+*/
+void cgvCommandList::draw_grid(cgvMesh mesh, const cgvGrid& grid)
+{ commands.push_back({ CGV_CMD_DRAW_GRID, (uint32_t) grids.size() });
+    grids.push_back({ mesh, grid });
+}
+
+/**
+* Records a grid of copies of a mesh as cgvRenderer::submit_grid would draw it
+* @param mesh Mesh to draw in each cell
+* @param material Appearance of all the copies
+* @param transform Modeling matrix of the copy in the cell (0, 0, 0)
+* @param grid Cells of the grid and distance between them
+*/
+void cgvCommandList::submit_grid(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& transform,
+                                 const cgvGrid& grid)
+{ set_material(material);
+    set_transform(transform);
+    draw_grid(mesh, grid);
+}
+
+/**
+* Records a local point light. The lights are not commands: they light all the
+* draws of the list
+* @param light Light to add
+*/
+void cgvCommandList::add_light(const cgvPointLight& light)
+{ lights.push_back(light);
+}
+
+/**
+* Adds the commands of another list at the end of this one, giving the same
+* commands as recording the draws of both lists here, one after the other. Only
+* the first material and transform of the other list can repeat the current
+* ones, since after them it was recorded with the same state as this list
+* @param list List to add, recorded from an empty list
+*/
+void cgvCommandList::append(const cgvCommandList& list)
+{ std::vector<uint32_t> material_index(list.materials.size());
+    for (size_t i = 0; i < list.materials.size(); i++)
+    { material_index[i] = add_material(list.materials[i]);
+    }
+
+    // the transforms are copied at once, without the first one if it is the current one
+    uint32_t skipped = 0;
+    if (!transforms.empty() && !list.transforms.empty()
+        && memcmp(transforms.back().data(), list.transforms[0].data(), sizeof(cgvMat4::m)) == 0)
+    { skipped = 1;
+    }
+    uint32_t transform_offset = (uint32_t) transforms.size() - skipped;
+    transforms.insert(transforms.end(), list.transforms.begin() + skipped, list.transforms.end());
+    uint32_t grid_offset = (uint32_t) grids.size();
+    grids.insert(grids.end(), list.grids.begin(), list.grids.end());
+    lights.insert(lights.end(), list.lights.begin(), list.lights.end());
+
+    commands.reserve(commands.size() + list.commands.size());
+    bool first_material = true;
+    for (const cgvCommand& command: list.commands)
+    { switch (command.type)
+        { case CGV_CMD_SET_MATERIAL:
+            { uint32_t index = material_index[command.index];
+                if (first_material)
+                { first_material = false;
+                    if (index == current_material)
+                    { break;
+                    }
+                }
+                commands.push_back({ CGV_CMD_SET_MATERIAL, index });
+                current_material = index;
+                break;
+            }
+            case CGV_CMD_SET_TRANSFORM:
+                if (command.index >= skipped)
+                { commands.push_back({ CGV_CMD_SET_TRANSFORM, transform_offset + command.index });
+                }
+                break;
+            case CGV_CMD_DRAW_GRID:
+                commands.push_back({ CGV_CMD_DRAW_GRID, grid_offset + command.index });
+                break;
+            default:
+                commands.push_back(command);
+                break;
+        }
+    }
+}
+
+/**
+* Submits the recorded draws to a renderer, in the order they were recorded
+* @param renderer Renderer between begin_frame and end_frame
+*/
+void cgvCommandList::replay(cgvRenderer* renderer) const
+{ const cgvMaterial* material = nullptr;
+    const cgvMat4* transform = nullptr;
+
+    for (const cgvCommand& command: commands)
+    { switch (command.type)
+        { case CGV_CMD_SET_MATERIAL:
+                material = &materials[command.index];
+                break;
+            case CGV_CMD_SET_TRANSFORM:
+                transform = &transforms[command.index];
+                break;
+            case CGV_CMD_DRAW_MESH:
+                renderer->submit((cgvMesh) command.index, *material, *transform);
+                break;
+            case CGV_CMD_DRAW_GRID:
+                renderer->submit_grid(grids[command.index].mesh, *material, *transform, grids[command.index].grid);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+* Method to access the recorded commands
+* @return The commands, in order
+*/
+const std::vector<cgvCommand>& cgvCommandList::get_commands() const
+{ return commands;
+}
+
+/**
+* Method to access a material set by a CGV_CMD_SET_MATERIAL command
+* @param index Argument of the command
+* @return The material
+*/
+const cgvMaterial& cgvCommandList::get_material(uint32_t index) const
+{ return materials[index];
+}
+
+/**
+* Method to access a transform set by a CGV_CMD_SET_TRANSFORM command
+* @param index Argument of the command
+* @return The transform
+*/
+const cgvMat4& cgvCommandList::get_transform(uint32_t index) const
+{ return transforms[index];
+}
+
+/**
+* Method to access a grid drawn by a CGV_CMD_DRAW_GRID command
+* @param index Argument of the command
+* @return The mesh and the cells of the grid
+*/
+const cgvGridDraw& cgvCommandList::get_grid(uint32_t index) const
+{ return grids[index];
+}
+
+/**
+* Method to access the local lights recorded with add_light
+* @return The lights, in the order they were added
+*/
+const std::vector<cgvPointLight>& cgvCommandList::get_lights() const
+{ return lights;
+}
+
+/**
+* Tags the list with the version of the geometry it holds. clear does not reset
+* it: the recorder sets it for each recording
+* @param _version Version of the geometry, changed by the recorder whenever the
+* meshes change
+*/
+void cgvCommandList::set_version(unsigned long _version)
+{ version = _version;
+}
+
+/**
+* Method to query the version of the geometry the list holds
+* @return The version set by the recorder; 0 if it has not set one
+*/
+unsigned long cgvCommandList::get_version() const
+{ return version;
+}
+
+/**
+* Method to query the number of different materials the commands use
+* @return The size of the material table
+*/
+unsigned long cgvCommandList::get_materials() const
+{ return materials.size();
+}
+
+/**
+* Method to count the commands of a type
+* @param type Type of the commands to count
+* @return The number of commands of that type
+*/
+unsigned long cgvCommandList::count(cgvCommandType type) const
+{ unsigned long n = 0;
+    for (const cgvCommand& command: commands)
+    { if (command.type == type)
+        { n++;
+        }
+    }
+    return n;
+}
+
+/**
+* Prints the commands, one per line, with the values they set
+* @param file File to print to, such as stdout
+*/
+void cgvCommandList::dump(FILE* file) const
+{ fprintf(file, "%lu commands: %lu material changes (%lu materials), %lu transforms, %lu draws, %lu grids, "
+                  "%lu lights\n",
+            (unsigned long) commands.size(), count(CGV_CMD_SET_MATERIAL), get_materials(),
+            count(CGV_CMD_SET_TRANSFORM), count(CGV_CMD_DRAW_MESH), count(CGV_CMD_DRAW_GRID),
+            (unsigned long) lights.size());
+
+    for (size_t i = 0; i < commands.size(); i++)
+    { const cgvCommand& command = commands[i];
+        fprintf(file, "%6lu %-9s ", (unsigned long) i, command_names[command.type]);
+        switch (command.type)
+        { case CGV_CMD_SET_MATERIAL:
+            { const cgvMaterial& m = materials[command.index];
+                fprintf(file, "#%u color (%g, %g, %g)%s%s width %g\n", command.index, m.color[0], m.color[1], m.color[2],
+                        m.lit ? " lit" : "", m.polygon_mode == GL_LINE ? " line" : "", m.line_width);
+                break;
+            }
+            case CGV_CMD_SET_TRANSFORM:
+            { const cgvMat4& t = transforms[command.index];
+                fprintf(file, "translation (%g, %g, %g) scale (%g, %g, %g)\n", t(0, 3), t(1, 3), t(2, 3),
+                        length(t.column(0).xyz()), length(t.column(1).xyz()), length(t.column(2).xyz()));
+                break;
+            }
+            case CGV_CMD_DRAW_MESH:
+                fprintf(file, "%s\n", command.index < CGV_MESHES ? mesh_names[command.index] : "?");
+                break;
+            case CGV_CMD_DRAW_GRID:
+            { const cgvGridDraw& g = grids[command.index];
+                fprintf(file, "%s %dx%dx%d spacing (%g, %g, %g)\n", mesh_names[g.mesh], g.grid.cells[0], g.grid.cells[1],
+                        g.grid.cells[2], g.grid.spacing[0], g.grid.spacing[1], g.grid.spacing[2]);
+                break;
+            }
+            default:
+                fprintf(file, "\n");
+                break;
+        }
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef __CGVCOMMANDLIST
+#define __CGVCOMMANDLIST
+
+#include <cstdint>
+#include <stdio.h>
+#include <vector>
+
+#include "cgvRenderer.h"
+
+/**
+ * Types of the commands of a cgvCommandList
+ */
+typedef enum {
+    CGV_CMD_SET_MATERIAL, ///< Makes a material of the list the current one
+    CGV_CMD_SET_TRANSFORM, ///< Makes a transform of the list the current one
+    CGV_CMD_DRAW_MESH, ///< Draws a mesh with the current material and transform
+    CGV_CMD_DRAW_GRID, ///< Draws a grid of the list with the current material and transform
+    CGV_CMD_TYPES
+} cgvCommandType;
+
+/**
+ * Recorded command: its type and its argument
+ */
+struct cgvCommand {
+    cgvCommandType type; ///< What the command does
+    uint32_t index; ///< Material, transform or grid of the list, or the cgvMesh to draw
+};
+
+/**
+ * Grid of copies of a mesh drawn by a CGV_CMD_DRAW_GRID command
+ */
+struct cgvGridDraw {
+    cgvMesh mesh; ///< Mesh of the cells
+    cgvGrid grid; ///< Cells and distance between them
+};
+
+/**
+ * Sequence of draws recorded once and replayed on every frame, so a scene that
+ * has not changed does not have to be traversed again. Materials and transforms
+ * live in their own tables and the commands refer to them by index: scenes use
+ * a few materials, so each one is stored once, and a material or transform
+ * command is only recorded when it differs from the current one. A grid of
+ * copies of a mesh is recorded as a single command. The local lights of the
+ * scene are kept with the draws, apart from the commands. The recorder can tag
+ * the list with the version of the geometry it was recorded from, so lists
+ * recorded again from the same geometry can be told apart from changed ones
+ */
+class cgvCommandList {
+private:
+    std::vector<cgvCommand> commands; ///< Commands, in order
+    std::vector<cgvMaterial> materials; ///< Materials set by the commands
+    std::vector<cgvMat4> transforms; ///< Transforms set by the commands
+    std::vector<cgvGridDraw> grids; ///< Grids drawn by the commands
+    std::vector<cgvPointLight> lights; ///< Local lights of the scene
+    uint32_t current_material = UINT32_MAX; ///< Material of the next draw; UINT32_MAX if none
+    unsigned long version = 0; ///< Version of the geometry recorded, set by the recorder
+
+public:
+    /// Default constructor: an empty list
+    cgvCommandList() = default;
+
+    /// Destructor
+    ~cgvCommandList() = default;
+
+    // Methods
+    void clear(); // removes the commands, keeping the memory for the next recording
+
+    void set_material(const cgvMaterial& material);
+    void set_transform(const cgvMat4& transform);
+    void draw_mesh(cgvMesh mesh);
+    void submit(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& transform); // same as cgvRenderer::submit
+    void draw_grid(cgvMesh mesh, const cgvGrid& grid);
+    void submit_grid(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& transform,
+                     const cgvGrid& grid); // same as cgvRenderer::submit_grid
+    void add_light(const cgvPointLight& light);
+
+    void append(const cgvCommandList& list); // as if the draws of list had been recorded here
+    void replay(cgvRenderer* renderer) const; // submits the draws, between begin_frame and end_frame
+
+    const std::vector<cgvCommand>& get_commands() const;
+    const cgvMaterial& get_material(uint32_t index) const;
+    const cgvMat4& get_transform(uint32_t index) const;
+    const cgvGridDraw& get_grid(uint32_t index) const;
+    const std::vector<cgvPointLight>& get_lights() const; // for cgvRenderer::set_local_lights
+    void set_version(unsigned long _version);
+    unsigned long get_version() const;
+    unsigned long get_materials() const; // different materials used
+    unsigned long count(cgvCommandType type) const;
+    void dump(FILE* file) const; // prints the commands, one per line
+
+private:
+    uint32_t add_material(const cgvMaterial& material);
+};
+
+#endif   // __CGVCOMMANDLIST
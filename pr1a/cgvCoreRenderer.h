@@ -0,0 +1,217 @@
+#ifndef __CGVCORERENDERER
+#define __CGVCORERENDERER
+
+#include <vector>
+
+#include "cgvGLCore.h"
+#include "cgvLightClusters.h"
+#include "cgvRenderer.h"
+#include "cgvStreamBuffer.h"
+
+/**
+ * Per-instance attributes of a mesh drawn by the core-profile renderer
+ */
+struct cgvCoreInstance {
+    GLfloat transform[16]; ///< Modeling matrix, column-major
+    GLfloat color[4]; ///< Material color; alpha is 1 if the material is lit
+};
+
+/**
+ * Meshes drawn together with a single instanced draw call: same mesh, polygon
+ * mode and line width
+ */
+struct cgvCoreBatch {
+    cgvMesh mesh; ///< Mesh of the instances
+    GLenum polygon_mode; ///< Polygon mode of the instances
+    GLfloat line_width; ///< Line width of the instances
+    std::vector<cgvCoreInstance> instances; ///< Instances submitted in the frame
+    std::vector<cgvViewMask> visible; ///< Views each instance is visible in
+    GLsizei view_counts[CGV_MAX_VIEWS]; ///< Instances visible in each view
+    size_t view_first[CGV_MAX_VIEWS]; ///< First instance of each view in the stream buffer, set by end_frame
+    size_t shadow_first; ///< First instance of the shadow map in the stream buffer, set by end_frame
+};
+
+/**
+ * Range of the vertex buffer used by a mesh
+ */
+struct cgvCoreMesh {
+    GLenum primitive; ///< GL_TRIANGLES or GL_LINES
+    GLint first; ///< First vertex
+    GLsizei count; ///< Number of vertices
+};
+
+/**
+ * Contents of the uniform buffer of the compute shader that culls a grid
+ * (std140 layout)
+ */
+struct cgvCoreGridCull {
+    GLfloat transform[16]; ///< Modeling matrix of the cell (0, 0, 0), column-major
+    GLfloat color[4]; ///< Material color; alpha is 1 if the material is lit
+    GLfloat bounds[4]; ///< Center and radius of the bounding sphere of the cell (0, 0, 0)
+    GLfloat spacing[4]; ///< Distance between the cells along X, Y and Z
+    GLint cells[4]; ///< Cells along X, Y and Z, and in the whole grid
+    GLfloat frusta[CGV_MAX_VIEWS * 6][4]; ///< Planes of the frustum of each view
+    GLint views[4]; ///< Views, whether they are culled, first instance and first command of the grid
+};
+
+/**
+ * Grid drawn with an indirect draw call, after the compute shader has written
+ * the instances of the cells visible in each view
+ */
+struct cgvCoreGrid {
+    cgvMesh mesh; ///< Mesh of the cells
+    GLenum polygon_mode; ///< Polygon mode of the cells
+    GLfloat line_width; ///< Line width of the cells
+    cgvCoreGridCull cull; ///< Arguments of the compute shader
+};
+
+/**
+ * Arguments of an indirect draw call, as glDrawArraysInstancedBaseInstance takes them
+ */
+struct cgvCoreDrawCommand {
+    GLuint count; ///< Vertices of the mesh
+    GLuint instance_count; ///< Instances drawn, counted by the compute shader
+    GLuint first; ///< First vertex of the mesh
+    GLuint base_instance; ///< First instance of the command in the instance buffer
+};
+
+/**
+ * Contents of the uniform buffer shared by the shaders (std140 layout)
+ */
+struct cgvCoreCamera {
+    GLfloat projection[CGV_MAX_VIEWS][16]; ///< Projection matrix of each view, column-major
+    GLfloat view[CGV_MAX_VIEWS][16]; ///< View matrix of each view, column-major
+    GLfloat light_position[4]; ///< Position of the point light, in world coordinates
+};
+
+/**
+ * Contents of the uniform buffer with the shadow map of the point light (std140
+ * layout)
+ */
+struct cgvCoreShadow {
+    GLfloat faces[6][16]; ///< Projection times view matrix of each face of the cube map, column-major
+    GLfloat light[4]; ///< Position of the light the map was drawn from, and 1 if the shadows are drawn
+    GLfloat depth_range[4]; ///< Near and far distance of the faces
+};
+
+/**
+ * Renderer that draws with an OpenGL 3.3 core-profile pipeline: all the meshes
+ * live in one vertex buffer, the instances submitted in a frame are grouped by
+ * mesh and drawn with one instanced draw call per group, and the lighting of
+ * GL_LIGHT0 is computed in the shaders. The per-instance attributes are
+ * rewritten on every frame, through a cgvStreamBuffer, only for the views each
+ * instance is visible in
+ */
+class cgvCoreRenderer: public cgvRenderer {
+private:
+    GLuint program = 0; ///< Shader program with the lighting of GL_LIGHT0
+    GLuint triangles_program = 0; ///< Program with a geometry shader that picks the viewport of the triangles
+    GLuint lines_program = 0; ///< Program with a geometry shader that picks the viewport of the lines
+    GLuint current_program = 0; ///< Program in use
+    GLuint camera_buffer = 0; ///< Uniform buffer with the camera matrices and the light
+    GLuint vao = 0; ///< Vertex array of the meshes and the instance attributes
+    GLuint vertices = 0; ///< Vertices of all the meshes
+    cgvStreamBuffer instances; ///< Per-instance attributes of the frame
+    cgvCoreMesh meshes[CGV_MESHES]; ///< Range of each mesh in vertices
+
+    GLuint cull_program = 0; ///< Compute shader that culls the grids; 0 if they are submitted by cells
+    GLuint cull_buffer = 0; ///< Uniform buffer with the arguments of the compute shader
+    GLuint grid_instances = 0; ///< Instances of the visible cells, written by the compute shader
+    GLuint grid_views = 0; ///< View of each of those instances
+    GLuint grid_commands = 0; ///< Indirect draw commands of the grids, one per view
+    GLsizeiptr grid_capacity = 0; ///< Instances grid_instances and grid_views have room for
+    GLsizeiptr command_capacity = 0; ///< Commands grid_commands has room for
+    std::vector<cgvCoreGrid> grids; ///< Grids submitted in the frame
+    std::vector<cgvCoreDrawCommand> commands; ///< Commands of the frame, before the compute shader counts the instances
+
+    cgvLightClusters clusters; ///< Local lights, binned into the clusters of the views
+
+    GLuint shadow_program = 0; ///< Program that draws the casters into the six faces of the shadow map
+    GLint shadow_grid_location = -1; ///< Uniform of that program that tells the grids from the batches
+    GLuint shadow_buffer = 0; ///< Uniform buffer with the faces of the shadow map and the light
+    GLuint shadow_map = 0; ///< Depth cube map around the point light
+    GLuint shadow_framebuffer = 0; ///< Framebuffer with the faces of the shadow map as its layers
+    GLuint shadow_query = 0; ///< Timer query of the last shadow map drawn
+    bool shadow_query_pending = false; ///< Whether the result of the query has not been read yet
+    cgvCoreShadow shadow = {}; ///< Copy of the uniform buffer
+    bool shadows = false; ///< Whether the shadows are drawn
+    bool shadows_available = true; ///< Whether the shadow map can be created; false once it has failed
+    bool shadows_valid = false; ///< Whether the shadow map holds the meshes and the light of the frame
+    bool shadow_frame = false; ///< Whether the frame draws the shadow map
+    GLfloat shadow_far = 0; ///< Distance from the light to the farthest caster of the frame
+
+    GLuint outline_program = 0; ///< Program of the full-screen pass that draws the outlines
+    GLint outline_bounds_location = -1; ///< Uniform of that program with the pixels of the view
+    GLint outline_color_location = -1; ///< Uniform of that program with the color of the outlines
+    GLuint outline_vao = 0; ///< Vertex array without attributes of the full-screen pass
+    GLuint outline_framebuffer = 0; ///< Framebuffer the frames with outlines are drawn to
+    GLuint outline_textures[4] = {}; ///< Color, normal, object and depth of its pixels
+    GLsizei outline_width = 0, outline_height = 0; ///< Size of the textures
+    GLuint outline_target = 0; ///< Framebuffer the frame is copied to, the one of the frames when it was cleared
+    GLfloat outline_color[3] = {}; ///< Color of the outlines
+    bool outlines = false; ///< Whether the filled meshes are outlined
+    bool outlines_available = true; ///< Whether the outlines can be drawn; false once they have failed
+    bool outline_frame = false; ///< Whether the frame is drawn to the offscreen framebuffer
+    bool outline_surfaces = false; ///< Whether the draws write the normal and the object of their pixels
+
+    cgvCoreCamera camera = {}; ///< Copy of the uniform buffer
+    bool camera_changed = true; ///< Whether the uniform buffer has to be uploaded
+    std::vector<cgvCoreBatch> batches; ///< Groups of instances, in order of first submission
+
+    GLenum polygon_mode = GL_FILL; ///< Current polygon mode
+    GLfloat line_width = 1; ///< Current line width
+    size_t frame_instances = 0; ///< Instances written to the stream buffer by the frame, once per view
+
+public:
+    /// Default constructor. The GL objects are created by initialize
+    cgvCoreRenderer() = default;
+
+    /// Destructor
+    ~cgvCoreRenderer() override = default;
+
+    // Methods
+    const char* get_name() override;
+    bool requires_core_profile() override;
+    bool initialize() override;
+
+    void present() override;
+
+    void set_camera(const cgvMat4& projection, const cgvMat4& view) override;
+    void set_views(const cgvView* _views, int count) override;
+    void set_light(const cgvVec4& position) override;
+    void set_local_lights(const cgvPointLight* lights, int count) override;
+    void set_shadows(bool enabled) override;
+    void invalidate_shadows() override;
+    bool set_outlines(bool enabled, const GLfloat color[3]) override;
+
+    void clear() override;
+
+    void begin_frame() override;
+    void submit(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& transform) override;
+    void submit_grid(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& transform,
+                     const cgvGrid& grid) override;
+    bool culls_grids() override;
+    unsigned long end_frame() override;
+
+    unsigned long get_streamed_bytes() override;
+    unsigned long get_stream_waits() override;
+
+private:
+    unsigned long draw_batch(const cgvCoreBatch& batch, GLintptr offset, size_t first, GLsizei count,
+                             GLuint batch_program);
+    void cull_grids(); // runs the compute shader on each grid
+    unsigned long draw_grids(bool together);
+    void set_state(GLenum _polygon_mode, GLfloat _line_width, GLuint _program);
+    bool create_shadow_map(); // on the first frame with shadows
+    bool is_surface(cgvMesh mesh, GLenum _polygon_mode); // casts shadows and is outlined
+    void add_caster(const cgvBounds& bounds);
+    GLuint get_frame_framebuffer(); // the one bound while the meshes are drawn
+    unsigned long draw_shadows(GLintptr offset);
+    void read_shadow_query(); // once its result is available
+    bool create_outlines(); // the first time they are turned on
+    bool bind_outlines(); // at clear, resizing the textures to the pixels drawn to
+    void set_outline_surfaces(bool surfaces);
+    unsigned long draw_outlines();
+};
+
+#endif   // __CGVCORERENDERER
@@ -0,0 +1,52 @@
+#include <stdio.h>
+
+#include "cgvDisplayListRenderer.h"
+
+/**
+* Destructor
+*/
+cgvDisplayListRenderer::~cgvDisplayListRenderer()
+{ if (lists)
+    { glDeleteLists(lists, CGV_MESHES);
+    }
+}
+
+/**
+* Method to query the name of the backend
+* @return The name accepted by cgvRenderer::create
+*/
+const char* cgvDisplayListRenderer::get_name()
+{ return "lists";
+}
+
+/**
+* Compiles the display lists of all the meshes
+* @retval true If the lists could be created
+* @retval false Otherwise
+*/
+bool cgvDisplayListRenderer::initialize()
+{ if (!cgvImmediateRenderer::initialize())
+    { return false;
+    }
+
+    lists = glGenLists(CGV_MESHES);
+    if (!lists)
+    { fprintf(stderr, "[renderer] display lists not available\n");
+        return false;
+    }
+
+    for (int mesh = 0; mesh < CGV_MESHES; mesh++)
+    { glNewList(lists + mesh, GL_COMPILE);
+        cgvImmediateRenderer::draw_mesh((cgvMesh) mesh);
+        glEndList();
+    }
+    return true;
+}
+
+/**
+* Draws a unit mesh by calling its display list
+* @param mesh Mesh to draw
+*/
+void cgvDisplayListRenderer::draw_mesh(cgvMesh mesh)
+{ glCallList(lists + mesh);
+}
@@ -0,0 +1,56 @@
+#ifndef __CGVDYNAMICRESOLUTION
+#define __CGVDYNAMICRESOLUTION
+
+#define CGV_RESOLUTION_SETTLE_FRAMES 8 ///< Frames measured after a change of scale before deciding again
+#define CGV_RESOLUTION_STEP_UP 0.05f ///< Scale added when the frames are well under the target
+#define CGV_RESOLUTION_HIGH 1.05 ///< Frames slower than the target times this lower the scale
+#define CGV_RESOLUTION_LOW 0.8 ///< Frames faster than the target times this raise the scale
+
+/**
+ * Decisions of the control loop
+ */
+typedef enum {
+    CGV_RESOLUTION_DOWN = -1, ///< The scale was lowered
+    CGV_RESOLUTION_HOLD = 0, ///< The scale was kept
+    CGV_RESOLUTION_UP = 1 ///< The scale was raised
+} cgvResolutionStep;
+
+/**
+ * Objects of this class choose the fraction of the window resolution the frames
+ * are drawn at, so the frame time holds a target. It is enabled with the
+ * CGV_DYNAMIC_RESOLUTION_MS environment variable, the target frame time in ms;
+ * CGV_RESOLUTION_MIN sets the smallest scale (0.25 by default). The control
+ * loop averages the frame times since its last change; when the average is over
+ * the target, the scale drops at once by the square root of the ratio, as the
+ * cost of a frame follows its pixels, and when it is well under the target the
+ * scale rises by small steps, so it does not oscillate around it
+ */
+class cgvDynamicResolution {
+private:
+    double target_ms = 0; ///< Target frame time, 0 if the scale is not controlled
+    float min_scale = 0.25f; ///< Smallest scale
+    float scale = 1; ///< Current scale
+    double average_ms = 0; ///< Moving average of the frame times since the last change
+    int frames = 0; ///< Frames measured since the last change
+    cgvResolutionStep step = CGV_RESOLUTION_HOLD; ///< Decision of the last frame
+
+    // Implementing the Singleton pattern
+    static cgvDynamicResolution* _instance; ///< Pointer to the singleton object of the class
+    cgvDynamicResolution();
+
+public:
+    static cgvDynamicResolution& getInstance();
+
+    /// Destructor
+    ~cgvDynamicResolution() = default;
+
+    // Methods
+    bool is_enabled();
+
+    cgvResolutionStep update(double frame_ms); // after each frame
+    float get_scale();
+    double get_target_ms();
+    cgvResolutionStep get_step(); // decision of the last frame
+};
+
+#endif   // __CGVDYNAMICRESOLUTION
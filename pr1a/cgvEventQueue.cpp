@@ -0,0 +1,51 @@
+#include "cgvEventQueue.h"
+
+/**
+* Adds an event at the end of the queue. Only called from the producer thread
+* @param event Event to add
+* @retval true If it has been added
+* @retval false If the queue was full, so the event has been dropped
+*/
+bool cgvEventQueue::push(const cgvInputEvent& event)
+{ unsigned int position = tail.load(std::memory_order_relaxed);
+    if (position - head.load(std::memory_order_acquire) == CGV_EVENT_CAPACITY)
+    { dropped++;
+        return false;
+    }
+    events[position & (CGV_EVENT_CAPACITY - 1)] = event;
+    tail.store(position + 1); // sequentially consistent, for the wake-up of the consumer
+    return true;
+}
+
+/**
+* Takes the event at the front of the queue. Only called from the consumer thread
+* @param event Event taken
+* @retval true If there was an event
+* @retval false If the queue was empty
+*/
+bool cgvEventQueue::pop(cgvInputEvent& event)
+{ unsigned int position = head.load(std::memory_order_relaxed);
+    if (position == tail.load(std::memory_order_acquire))
+    { return false;
+    }
+    event = events[position & (CGV_EVENT_CAPACITY - 1)];
+    head.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+* Method to check whether there are events to pop
+* @retval true If the queue is empty
+* @retval false If there are events
+*/
+bool cgvEventQueue::empty()
+{ return head.load() == tail.load();
+}
+
+/**
+* Method to query the events dropped because the queue was full
+* @return The number of events dropped
+*/
+unsigned long cgvEventQueue::get_dropped()
+{ return dropped;
+}
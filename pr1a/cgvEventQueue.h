@@ -0,0 +1,53 @@
+#ifndef __CGVEVENTQUEUE
+#define __CGVEVENTQUEUE
+
+#include <atomic>
+
+#define CGV_EVENT_CAPACITY 256 ///< Events the queue can hold (power of 2)
+
+/**
+ * Kinds of input events
+ */
+typedef enum {
+    CGV_EVENT_KEY, ///< Key pressed: value is the key
+    CGV_EVENT_MENU ///< Menu entry selected: value is the entry
+} cgvEventType;
+
+/**
+ * Input event received by a GLUT callback
+ */
+struct cgvInputEvent {
+    cgvEventType type; ///< Kind of event
+    int value; ///< Key or menu entry
+    int x, y; ///< Position of the mouse cursor, for keys
+};
+
+/**
+ * Lock-free queue of input events with a single producer thread and a single
+ * consumer thread. Each index is only written by one of the threads, and they
+ * are kept on separate cache lines so pushing and popping do not slow each
+ * other down
+ */
+class cgvEventQueue {
+private:
+    cgvInputEvent events[CGV_EVENT_CAPACITY]; ///< Ring of events
+    std::atomic<unsigned int> tail{0}; ///< Events pushed, written by the producer
+    char padding[64]; ///< Keeps tail and head on different cache lines
+    std::atomic<unsigned int> head{0}; ///< Events popped, written by the consumer
+    unsigned long dropped = 0; ///< Events pushed while the queue was full, for the producer
+
+public:
+    /// Default constructor: an empty queue
+    cgvEventQueue() = default;
+
+    /// Destructor
+    ~cgvEventQueue() = default;
+
+    // Methods
+    bool push(const cgvInputEvent& event); // producer only; false if the queue is full
+    bool pop(cgvInputEvent& event); // consumer only; false if the queue is empty
+    bool empty();
+    unsigned long get_dropped(); // producer only
+};
+
+#endif   // __CGVEVENTQUEUE
@@ -0,0 +1,183 @@
+#define CGV_GL_CORE_IMPLEMENTATION
+#include "cgvGLCore.h"
+
+#include <cstring>
+#include <stdio.h>
+
+#if !(defined(__APPLE__) && defined(__MACH__))
+#define CGV_GL_CORE_DEFINE(type, name) type cgvGLCore_##name = nullptr;
+CGV_GL_CORE_PROCS(CGV_GL_CORE_DEFINE)
+CGV_GL_CORE_OPTIONAL_PROCS(CGV_GL_CORE_DEFINE)
+#undef CGV_GL_CORE_DEFINE
+
+// Inside this file the loaded entry points are called through their pointers
+#define CGV_GL_CORE_CALL(name) cgvGLCore_##name
+#else
+#define CGV_GL_CORE_CALL(name) name
+#endif   // !(defined(__APPLE__) && defined(__MACH__))
+
+/**
+* Sets the display mode and asks GLUT for an OpenGL 3.3 core-profile context.
+* Must be called between glutInit and glutCreateWindow
+* @param display_mode Display mode flags (GLUT_RGB, GLUT_DOUBLE...)
+*/
+void cgvGLCore::request_context(unsigned int display_mode)
+{
+#if defined(__APPLE__) && defined(__MACH__)
+    glutInitDisplayMode(display_mode | GLUT_3_2_CORE_PROFILE); // macOS gives the newest core version
+#else
+    glutInitDisplayMode(display_mode);
+    glutInitContextVersion(3, 3);
+    glutInitContextProfile(GLUT_CORE_PROFILE);
+#endif   // defined(__APPLE__) && defined(__MACH__)
+}
+
+/**
+* Loads the core entry points of the current context, and the optional ones it
+* has
+* @retval true If all the core entry points are available
+* @retval false Otherwise; the missing entry points are reported on stderr
+*/
+bool cgvGLCore::load()
+{ bool loaded = true;
+
+#if !(defined(__APPLE__) && defined(__MACH__))
+#define CGV_GL_CORE_LOAD(type, name) \
+    cgvGLCore_##name = (type) glutGetProcAddress(#name); \
+    if (!cgvGLCore_##name) \
+    { fprintf(stderr, "[gl-core] %s not available\n", #name); \
+        loaded = false; \
+    }
+    CGV_GL_CORE_PROCS(CGV_GL_CORE_LOAD)
+#undef CGV_GL_CORE_LOAD
+
+#define CGV_GL_CORE_LOAD_OPTIONAL(type, name) cgvGLCore_##name = (type) glutGetProcAddress(#name);
+    CGV_GL_CORE_OPTIONAL_PROCS(CGV_GL_CORE_LOAD_OPTIONAL)
+#undef CGV_GL_CORE_LOAD_OPTIONAL
+#endif   // !(defined(__APPLE__) && defined(__MACH__))
+
+    return loaded;
+}
+
+/**
+* Method to check whether the current context has an extension. The entry point
+* of an extension can be found even if the context does not have it, so it has
+* to be checked before using them
+* @param name Name of the extension, such as "GL_ARB_buffer_storage"
+* @retval true If the context has it
+* @retval false Otherwise
+* @pre The core entry points have been loaded
+*/
+bool cgvGLCore::has_extension(const char* name)
+{ GLint extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+    for (GLint i = 0; i < extensions; i++)
+    { const char* extension = (const char*) CGV_GL_CORE_CALL(glGetStringi)(GL_EXTENSIONS, i);
+        if (extension && strcmp(extension, name) == 0)
+        { return true;
+        }
+    }
+    return false;
+}
+
+// Compiles a shader, reporting the errors on stderr. Returns 0 if it fails
+static GLuint compile_shader(GLenum type, const char* source)
+{ GLuint shader = CGV_GL_CORE_CALL(glCreateShader)(type);
+    CGV_GL_CORE_CALL(glShaderSource)(shader, 1, &source, nullptr);
+    CGV_GL_CORE_CALL(glCompileShader)(shader);
+
+    GLint compiled = GL_FALSE;
+    CGV_GL_CORE_CALL(glGetShaderiv)(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled)
+    { char log[1024];
+        CGV_GL_CORE_CALL(glGetShaderInfoLog)(shader, sizeof(log), nullptr, log);
+        const char* stage = (type == GL_VERTEX_SHADER) ? "vertex" : (type == GL_GEOMETRY_SHADER) ? "geometry"
+                            : (type == GL_FRAGMENT_SHADER) ? "fragment" : "compute";
+        fprintf(stderr, "[gl-core] %s shader: %s\n", stage, log);
+        CGV_GL_CORE_CALL(glDeleteShader)(shader);
+        return 0;
+    }
+    return shader;
+}
+
+// Checks that a program has been linked, reporting the errors on stderr and
+// deleting it if not. Returns the program, or 0 if it was not linked
+static GLuint check_program(GLuint program)
+{ GLint linked = GL_FALSE;
+    CGV_GL_CORE_CALL(glGetProgramiv)(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    { char log[1024];
+        CGV_GL_CORE_CALL(glGetProgramInfoLog)(program, sizeof(log), nullptr, log);
+        fprintf(stderr, "[gl-core] program: %s\n", log);
+        CGV_GL_CORE_CALL(glDeleteProgram)(program);
+        return 0;
+    }
+    return program;
+}
+
+/**
+* Compiles and links a shader program
+* @param vertex_source GLSL source of the vertex shader
+* @param fragment_source GLSL source of the fragment shader
+* @param geometry_source GLSL source of the geometry shader, or null if it has none
+* @return The program, or 0 if it could not be built; the compiler and linker
+* messages are reported on stderr
+*/
+GLuint cgvGLCore::compile_program(const char* vertex_source, const char* fragment_source,
+                                  const char* geometry_source)
+{ GLuint vertex = compile_shader(GL_VERTEX_SHADER, vertex_source);
+    GLuint fragment = compile_shader(GL_FRAGMENT_SHADER, fragment_source);
+    GLuint geometry = geometry_source ? compile_shader(GL_GEOMETRY_SHADER, geometry_source) : 0;
+    if (!vertex || !fragment || (geometry_source && !geometry))
+    { if (vertex)
+        { CGV_GL_CORE_CALL(glDeleteShader)(vertex);
+        }
+        if (fragment)
+        { CGV_GL_CORE_CALL(glDeleteShader)(fragment);
+        }
+        if (geometry)
+        { CGV_GL_CORE_CALL(glDeleteShader)(geometry);
+        }
+        return 0;
+    }
+
+    GLuint program = CGV_GL_CORE_CALL(glCreateProgram)();
+    CGV_GL_CORE_CALL(glAttachShader)(program, vertex);
+    CGV_GL_CORE_CALL(glAttachShader)(program, fragment);
+    if (geometry)
+    { CGV_GL_CORE_CALL(glAttachShader)(program, geometry);
+    }
+    CGV_GL_CORE_CALL(glLinkProgram)(program);
+    CGV_GL_CORE_CALL(glDeleteShader)(vertex); // they are freed along with the program
+    CGV_GL_CORE_CALL(glDeleteShader)(fragment);
+    if (geometry)
+    { CGV_GL_CORE_CALL(glDeleteShader)(geometry);
+    }
+
+    return check_program(program);
+}
+
+/**
+* Compiles and links a compute shader program
+* @param compute_source GLSL source of the compute shader
+* @return The program, or 0 if it could not be built or the platform has no
+* compute shaders; the compiler and linker messages are reported on stderr
+* @pre The context has GL_ARB_compute_shader
+*/
+GLuint cgvGLCore::compile_compute_program(const char* compute_source)
+{
+#if defined(__APPLE__) && defined(__MACH__)
+    return 0; // macOS stops at OpenGL 4.1
+#else
+    GLuint compute = compile_shader(GL_COMPUTE_SHADER, compute_source);
+    if (!compute)
+    { return 0;
+    }
+
+    GLuint program = CGV_GL_CORE_CALL(glCreateProgram)();
+    CGV_GL_CORE_CALL(glAttachShader)(program, compute);
+    CGV_GL_CORE_CALL(glLinkProgram)(program);
+    CGV_GL_CORE_CALL(glDeleteShader)(compute);
+    return check_program(program);
+#endif   // defined(__APPLE__) && defined(__MACH__)
+}
@@ -0,0 +1,194 @@
+#ifndef __CGVGLCORE
+#define __CGVGLCORE
+
+#if defined(__APPLE__) && defined(__MACH__)
+#define GL_DO_NOT_WARN_IF_MULTI_GL_VERSION_HEADERS_INCLUDED
+#include <GLUT/glut.h>
+#include <OpenGL/gl3.h>
+#else
+#include <GL/glut.h>
+#include <GL/freeglut_ext.h>
+#include <GL/glext.h>
+#endif   // defined(__APPLE__) && defined(__MACH__)
+
+#include "cgvGLStats.h"
+
+#if !(defined(__APPLE__) && defined(__MACH__))
+
+/**
+ * OpenGL 3.3 core entry points used by the core-profile renderer, and by the
+ * offscreen target of every backend that draws at a reduced resolution. They are
+ * not exported by the system libraries on every platform, so they are loaded at
+ * run time with glutGetProcAddress
+ */
+#define CGV_GL_CORE_PROCS(X) \
+    X(PFNGLGENVERTEXARRAYSPROC, glGenVertexArrays) \
+    X(PFNGLDELETEVERTEXARRAYSPROC, glDeleteVertexArrays) \
+    X(PFNGLBINDVERTEXARRAYPROC, glBindVertexArray) \
+    X(PFNGLGENBUFFERSPROC, glGenBuffers) \
+    X(PFNGLDELETEBUFFERSPROC, glDeleteBuffers) \
+    X(PFNGLBINDBUFFERPROC, glBindBuffer) \
+    X(PFNGLBINDBUFFERBASEPROC, glBindBufferBase) \
+    X(PFNGLBUFFERDATAPROC, glBufferData) \
+    X(PFNGLBUFFERSUBDATAPROC, glBufferSubData) \
+    X(PFNGLMAPBUFFERRANGEPROC, glMapBufferRange) \
+    X(PFNGLUNMAPBUFFERPROC, glUnmapBuffer) \
+    X(PFNGLFENCESYNCPROC, glFenceSync) \
+    X(PFNGLCLIENTWAITSYNCPROC, glClientWaitSync) \
+    X(PFNGLDELETESYNCPROC, glDeleteSync) \
+    X(PFNGLGETSTRINGIPROC, glGetStringi) \
+    X(PFNGLVERTEXATTRIBPOINTERPROC, glVertexAttribPointer) \
+    X(PFNGLVERTEXATTRIBIPOINTERPROC, glVertexAttribIPointer) \
+    X(PFNGLVERTEXATTRIBDIVISORPROC, glVertexAttribDivisor) \
+    X(PFNGLVERTEXATTRIBI4UIPROC, glVertexAttribI4ui) \
+    X(PFNGLVERTEXATTRIB3FPROC, glVertexAttrib3f) \
+    X(PFNGLENABLEVERTEXATTRIBARRAYPROC, glEnableVertexAttribArray) \
+    X(PFNGLDISABLEVERTEXATTRIBARRAYPROC, glDisableVertexAttribArray) \
+    X(PFNGLCREATESHADERPROC, glCreateShader) \
+    X(PFNGLDELETESHADERPROC, glDeleteShader) \
+    X(PFNGLSHADERSOURCEPROC, glShaderSource) \
+    X(PFNGLCOMPILESHADERPROC, glCompileShader) \
+    X(PFNGLGETSHADERIVPROC, glGetShaderiv) \
+    X(PFNGLGETSHADERINFOLOGPROC, glGetShaderInfoLog) \
+    X(PFNGLCREATEPROGRAMPROC, glCreateProgram) \
+    X(PFNGLDELETEPROGRAMPROC, glDeleteProgram) \
+    X(PFNGLATTACHSHADERPROC, glAttachShader) \
+    X(PFNGLLINKPROGRAMPROC, glLinkProgram) \
+    X(PFNGLGETPROGRAMIVPROC, glGetProgramiv) \
+    X(PFNGLGETPROGRAMINFOLOGPROC, glGetProgramInfoLog) \
+    X(PFNGLUSEPROGRAMPROC, glUseProgram) \
+    X(PFNGLGETUNIFORMBLOCKINDEXPROC, glGetUniformBlockIndex) \
+    X(PFNGLUNIFORMBLOCKBINDINGPROC, glUniformBlockBinding) \
+    X(PFNGLGETUNIFORMLOCATIONPROC, glGetUniformLocation) \
+    X(PFNGLUNIFORM1IPROC, glUniform1i) \
+    X(PFNGLUNIFORM3FPROC, glUniform3f) \
+    X(PFNGLUNIFORM4IPROC, glUniform4i) \
+    X(PFNGLDRAWARRAYSINSTANCEDPROC, glDrawArraysInstanced) \
+    X(PFNGLACTIVETEXTUREPROC, glActiveTexture) \
+    X(PFNGLTEXBUFFERPROC, glTexBuffer) \
+    X(PFNGLGENQUERIESPROC, glGenQueries) \
+    X(PFNGLBEGINQUERYPROC, glBeginQuery) \
+    X(PFNGLENDQUERYPROC, glEndQuery) \
+    X(PFNGLGETQUERYOBJECTIVPROC, glGetQueryObjectiv) \
+    X(PFNGLGETQUERYOBJECTUI64VPROC, glGetQueryObjectui64v) \
+    X(PFNGLGENFRAMEBUFFERSPROC, glGenFramebuffers) \
+    X(PFNGLDELETEFRAMEBUFFERSPROC, glDeleteFramebuffers) \
+    X(PFNGLBINDFRAMEBUFFERPROC, glBindFramebuffer) \
+    X(PFNGLFRAMEBUFFERRENDERBUFFERPROC, glFramebufferRenderbuffer) \
+    X(PFNGLFRAMEBUFFERTEXTUREPROC, glFramebufferTexture) \
+    X(PFNGLDRAWBUFFERSPROC, glDrawBuffers) \
+    X(PFNGLCLEARBUFFERFVPROC, glClearBufferfv) \
+    X(PFNGLCLEARBUFFERUIVPROC, glClearBufferuiv) \
+    X(PFNGLCHECKFRAMEBUFFERSTATUSPROC, glCheckFramebufferStatus) \
+    X(PFNGLBLITFRAMEBUFFERPROC, glBlitFramebuffer) \
+    X(PFNGLGENRENDERBUFFERSPROC, glGenRenderbuffers) \
+    X(PFNGLDELETERENDERBUFFERSPROC, glDeleteRenderbuffers) \
+    X(PFNGLBINDRENDERBUFFERPROC, glBindRenderbuffer) \
+    X(PFNGLRENDERBUFFERSTORAGEPROC, glRenderbufferStorage)
+
+/**
+ * Entry points of extensions the core-profile renderer uses when the context has
+ * them; they stay null otherwise
+ */
+#define CGV_GL_CORE_OPTIONAL_PROCS(X) \
+    X(PFNGLBUFFERSTORAGEPROC, glBufferStorage) \
+    X(PFNGLVIEWPORTINDEXEDFPROC, glViewportIndexedf) \
+    X(PFNGLDISPATCHCOMPUTEPROC, glDispatchCompute) \
+    X(PFNGLMEMORYBARRIERPROC, glMemoryBarrier) \
+    X(PFNGLMULTIDRAWARRAYSINDIRECTPROC, glMultiDrawArraysIndirect)
+
+#define CGV_GL_CORE_DECLARE(type, name) extern type cgvGLCore_##name;
+CGV_GL_CORE_PROCS(CGV_GL_CORE_DECLARE)
+CGV_GL_CORE_OPTIONAL_PROCS(CGV_GL_CORE_DECLARE)
+#undef CGV_GL_CORE_DECLARE
+
+// From here on, every translation unit that includes this header calls the loaded entry points
+#ifndef CGV_GL_CORE_IMPLEMENTATION
+#define glGenVertexArrays cgvGLCore_glGenVertexArrays
+#define glDeleteVertexArrays cgvGLCore_glDeleteVertexArrays
+#define glBindVertexArray cgvGLCore_glBindVertexArray
+#define glGenBuffers cgvGLCore_glGenBuffers
+#define glDeleteBuffers cgvGLCore_glDeleteBuffers
+#define glBindBuffer cgvGLCore_glBindBuffer
+#define glBindBufferBase cgvGLCore_glBindBufferBase
+#define glBufferData cgvGLCore_glBufferData
+#define glBufferSubData cgvGLCore_glBufferSubData
+#define glMapBufferRange cgvGLCore_glMapBufferRange
+#define glUnmapBuffer cgvGLCore_glUnmapBuffer
+#define glFenceSync cgvGLCore_glFenceSync
+#define glClientWaitSync cgvGLCore_glClientWaitSync
+#define glDeleteSync cgvGLCore_glDeleteSync
+#define glGetStringi cgvGLCore_glGetStringi
+#define glVertexAttribPointer cgvGLCore_glVertexAttribPointer
+#define glVertexAttribIPointer cgvGLCore_glVertexAttribIPointer
+#define glVertexAttribDivisor cgvGLCore_glVertexAttribDivisor
+#define glVertexAttribI4ui cgvGLCore_glVertexAttribI4ui
+#define glVertexAttrib3f cgvGLCore_glVertexAttrib3f
+#define glEnableVertexAttribArray cgvGLCore_glEnableVertexAttribArray
+#define glDisableVertexAttribArray cgvGLCore_glDisableVertexAttribArray
+#define glCreateShader cgvGLCore_glCreateShader
+#define glDeleteShader cgvGLCore_glDeleteShader
+#define glShaderSource cgvGLCore_glShaderSource
+#define glCompileShader cgvGLCore_glCompileShader
+#define glGetShaderiv cgvGLCore_glGetShaderiv
+#define glGetShaderInfoLog cgvGLCore_glGetShaderInfoLog
+#define glCreateProgram cgvGLCore_glCreateProgram
+#define glDeleteProgram cgvGLCore_glDeleteProgram
+#define glAttachShader cgvGLCore_glAttachShader
+#define glLinkProgram cgvGLCore_glLinkProgram
+#define glGetProgramiv cgvGLCore_glGetProgramiv
+#define glGetProgramInfoLog cgvGLCore_glGetProgramInfoLog
+#define glUseProgram cgvGLCore_glUseProgram
+#define glGetUniformBlockIndex cgvGLCore_glGetUniformBlockIndex
+#define glUniformBlockBinding cgvGLCore_glUniformBlockBinding
+#define glGetUniformLocation cgvGLCore_glGetUniformLocation
+#define glUniform1i cgvGLCore_glUniform1i
+#define glUniform3f cgvGLCore_glUniform3f
+#define glUniform4i cgvGLCore_glUniform4i
+#define glDrawArraysInstanced cgvGLCore_glDrawArraysInstanced
+#define glActiveTexture cgvGLCore_glActiveTexture
+#define glTexBuffer cgvGLCore_glTexBuffer
+#define glGenQueries cgvGLCore_glGenQueries
+#define glBeginQuery cgvGLCore_glBeginQuery
+#define glEndQuery cgvGLCore_glEndQuery
+#define glGetQueryObjectiv cgvGLCore_glGetQueryObjectiv
+#define glGetQueryObjectui64v cgvGLCore_glGetQueryObjectui64v
+#define glGenFramebuffers cgvGLCore_glGenFramebuffers
+#define glDeleteFramebuffers cgvGLCore_glDeleteFramebuffers
+#define glBindFramebuffer cgvGLCore_glBindFramebuffer
+#define glFramebufferRenderbuffer cgvGLCore_glFramebufferRenderbuffer
+#define glFramebufferTexture cgvGLCore_glFramebufferTexture
+#define glDrawBuffers cgvGLCore_glDrawBuffers
+#define glClearBufferfv cgvGLCore_glClearBufferfv
+#define glClearBufferuiv cgvGLCore_glClearBufferuiv
+#define glCheckFramebufferStatus cgvGLCore_glCheckFramebufferStatus
+#define glBlitFramebuffer cgvGLCore_glBlitFramebuffer
+#define glGenRenderbuffers cgvGLCore_glGenRenderbuffers
+#define glDeleteRenderbuffers cgvGLCore_glDeleteRenderbuffers
+#define glBindRenderbuffer cgvGLCore_glBindRenderbuffer
+#define glRenderbufferStorage cgvGLCore_glRenderbufferStorage
+#define glBufferStorage cgvGLCore_glBufferStorage
+#define glViewportIndexedf cgvGLCore_glViewportIndexedf
+#define glDispatchCompute cgvGLCore_glDispatchCompute
+#define glMemoryBarrier cgvGLCore_glMemoryBarrier
+#define glMultiDrawArraysIndirect cgvGLCore_glMultiDrawArraysIndirect
+#endif   // CGV_GL_CORE_IMPLEMENTATION
+
+#endif   // !(defined(__APPLE__) && defined(__MACH__))
+
+/**
+ * Helper functions to create an OpenGL 3.3 core-profile context and the shader
+ * programs used with it
+ */
+class cgvGLCore {
+public:
+    static void request_context(unsigned int display_mode);
+    static bool load();
+    static bool has_extension(const char* name); // of the current context
+
+    static GLuint compile_program(const char* vertex_source, const char* fragment_source,
+                                  const char* geometry_source = nullptr);
+    static GLuint compile_compute_program(const char* compute_source); // 0 without compute shaders
+};
+
+#endif   // __CGVGLCORE
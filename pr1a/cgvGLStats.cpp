@@ -0,0 +1,858 @@
+#define CGV_GL_STATS_IMPLEMENTATION
+#include "cgvGLStats.h"
+
+#ifdef CGV_GL_STATS
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdio.h>
+
+#if !(defined(__APPLE__) && defined(__MACH__))
+#include <GL/freeglut_ext.h>
+#include <GL/glext.h>
+
+// Fence sync entry points (GL 3.2 / ARB_sync), loaded at run time
+static PFNGLFENCESYNCPROC fence_sync = nullptr;
+static PFNGLCLIENTWAITSYNCPROC client_wait_sync = nullptr;
+static PFNGLDELETESYNCPROC delete_sync = nullptr;
+#endif   // !(defined(__APPLE__) && defined(__MACH__))
+
+// Names of the intercepted entry points, in the same order as cgvGLCall
+static const char* call_names[] = {
+#define CGV_GL_STATS_NAME(name) #name,
+    CGV_GL_STATS_CALLS(CGV_GL_STATS_NAME)
+#undef CGV_GL_STATS_NAME
+};
+
+// Singleton Pattern Application
+cgvGLStats* cgvGLStats::_instance = nullptr;
+
+// Names of the types of input events, in the same order as cgvGLInputType
+static const char* input_names[] = { "keyboard", "special", "menu" };
+
+// Upper limit of each latency bucket, in ms
+static const double bucket_limits[CGV_GL_LATENCY_BUCKETS - 1] = { 1, 2, 4, 8, 16, 32, 64, 128, 256 };
+
+// Current time, in ms
+static double now_ms()
+{ return std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Prints the stall and latency summaries when the application exits
+static void print_summary_at_exit()
+{ cgvGLStats::getInstance().print_stalls();
+    cgvGLStats::getInstance().print_latency();
+}
+
+// Polls the fences of the frames drawn after an input event until all of them
+// have been completed, even if no more frames are drawn
+static void poll_fences_timer(int /*value*/)
+{ if (cgvGLStats::getInstance().poll_fences())
+    { glutTimerFunc(1, poll_fences_timer, 0);
+    }
+}
+
+/**
+* Default constructor. The report interval is read from the CGV_GL_STATS_EVERY
+* environment variable (1 by default, 0 disables the report), and the number of
+* frames of a benchmark run from CGV_BENCH_FRAMES (no benchmark by default)
+*/
+cgvGLStats::cgvGLStats()
+{ memset(&current, 0, sizeof(current));
+    memset(&last, 0, sizeof(last));
+    current.max_depth[0] = current.max_depth[1] = current.max_depth[2] = 1;
+
+    memset(latency, 0, sizeof(latency));
+    for (int i = 0; i < CGV_GL_MAX_INPUT_EVENTS; i++)
+    { events[i].type = -1;
+    }
+    for (int i = 0; i < CGV_GL_MAX_FENCES; i++)
+    { fences[i] = nullptr;
+    }
+
+    const char* every = getenv("CGV_GL_STATS_EVERY");
+    if (every)
+    { report_every = strtoul(every, nullptr, 10);
+    }
+
+    const char* bench = getenv("CGV_BENCH_FRAMES");
+    if (bench)
+    { bench_frames = strtoul(bench, nullptr, 10);
+    }
+
+    atexit(print_summary_at_exit);
+}
+
+/**
+* Method to access the class's singleton object, applying the Singleton
+* design pattern
+* @return A reference to the class's singleton object
+*/
+cgvGLStats& cgvGLStats::getInstance()
+{ if ( !_instance )
+    { _instance = new cgvGLStats;
+    }
+
+    return *_instance;
+}
+
+/**
+* Counts a call to an intercepted entry point
+* @param call Entry point that has been called
+*/
+void cgvGLStats::count(cgvGLCall call)
+{ current.calls[call]++;
+
+    if (tracing)
+    { unsigned long n = trace_length[trace_current]++;
+        double now = now_ms();
+        if (n == 0)
+        { trace_start = now;
+        }
+        if (n < CGV_GL_MAX_TRACE)
+        { trace[trace_current][n] = { call, (float) (now - trace_start) };
+        }
+    }
+}
+
+/**
+* Adds vertices to the number of vertices submitted in the current frame
+* @param n Number of vertices
+*/
+void cgvGLStats::add_vertices(unsigned long n)
+{ current.vertices += n;
+}
+
+/**
+* Counts a draw call (a glBegin block or a GLU/GLUT solid) in the current frame
+*/
+void cgvGLStats::draw_call()
+{ current.draw_calls++;
+}
+
+/**
+* Keeps track of the matrix stack affected by glPushMatrix/glPopMatrix
+* @param _mode GL_MODELVIEW, GL_PROJECTION or GL_TEXTURE
+*/
+void cgvGLStats::matrix_mode(GLenum _mode)
+{ mode = (_mode == GL_PROJECTION) ? 1 : ((_mode == GL_TEXTURE) ? 2 : 0);
+}
+
+/**
+* Updates the depth and the high-water mark of the current matrix stack
+*/
+void cgvGLStats::push_matrix()
+{ depth[mode]++;
+    if (depth[mode] > current.max_depth[mode])
+    { current.max_depth[mode] = depth[mode];
+    }
+}
+
+/**
+* Updates the depth of the current matrix stack
+*/
+void cgvGLStats::pop_matrix()
+{ if (depth[mode] > 1)
+    { depth[mode]--;
+    }
+}
+
+/**
+* Closes the current frame: its counters become the last frame's counters
+* and, if it is time to, they are printed on stderr
+*/
+void cgvGLStats::end_frame()
+{ frame++;
+    last = current;
+
+    memset(&current, 0, sizeof(current));
+    trace_current = 1 - trace_current;
+    trace_length[trace_current] = 0;
+    for (int i = 0; i < 3; i++)
+    { current.max_depth[i] = depth[i];
+    }
+
+    if (report_every && (frame % report_every == 0))
+    { print(last, frame);
+    }
+
+    // benchmark run: keep drawing until the requested number of frames,
+    // then exit with an error status if a hot path has stalled the pipeline
+    if (bench_frames)
+    { if (frame >= bench_frames)
+        { fprintf(stderr, "[gl-stats] benchmark finished after %lu frames: %s\n", frame,
+                    hot_stall ? "FAILED, synchronizing GL calls in a hot path" : "OK");
+            exit(hot_stall ? 1 : 0);
+        }
+        glutPostRedisplay();
+    }
+}
+
+/**
+* Prints the counters of a frame on stderr
+* @param stats Counters to print
+* @param number Number of the frame the counters belong to
+*/
+void cgvGLStats::print(const cgvGLFrameStats& stats, unsigned long number)
+{ fprintf(stderr, "[gl-stats] frame %lu: draw calls %lu, vertices %lu, max stack depth (modelview/projection/texture) %d/%d/%d\n",
+            number, stats.draw_calls, stats.vertices,
+            stats.max_depth[0], stats.max_depth[1], stats.max_depth[2]);
+
+    for (int i = 0; i < CGV_CALL_COUNT; i++)
+    { if (stats.calls[i])
+        { fprintf(stderr, "[gl-stats]   %-20s %lu\n", call_names[i], stats.calls[i]);
+        }
+    }
+}
+
+/**
+* Enters a callback or hot path
+* @param _scope Name of the scope
+* @param _hot Whether the scope is a hot path
+* @param previous_hot Returns whether the previous scope was a hot path
+* @return The name of the previous scope, to be restored by leave_scope
+*/
+const char* cgvGLStats::enter_scope(const char* _scope, bool _hot, bool& previous_hot)
+{ const char* previous = scope;
+    previous_hot = hot;
+
+    scope = _scope;
+    hot = _hot || previous_hot; // anything called from a hot path is hot too
+    return previous;
+}
+
+/**
+* Leaves a callback or hot path, restoring the previous one
+* @param previous Name of the previous scope
+* @param previous_hot Whether the previous scope was a hot path
+*/
+void cgvGLStats::leave_scope(const char* previous, bool previous_hot)
+{ scope = previous;
+    hot = previous_hot;
+}
+
+/**
+* Records a synchronizing call. Calls made outside callbacks (initialization)
+* are ignored; the first call from each call site is reported on stderr
+* @param call Name of the synchronizing entry point
+* @param file Source file of the call site
+* @param line Line of the call site
+* @param ms Time blocked in the call, in milliseconds
+*/
+void cgvGLStats::stall(const char* call, const char* file, int line, double ms)
+{ if (!scope)
+    { return;
+    }
+
+    if (hot)
+    { hot_stall = true;
+    }
+
+    cgvGLStall* record = nullptr;
+    for (int i = 0; i < n_stalls && !record; i++)
+    { if (stalls[i].line == line && !strcmp(stalls[i].file, file) && !strcmp(stalls[i].scope, scope))
+        { record = &stalls[i];
+        }
+    }
+
+    if (!record)
+    { fprintf(stderr, "[gl-stats] stall: %s at %s:%d in %s%s blocked %.3f ms\n",
+                call, file, line, scope, hot ? " (hot path)" : "", ms);
+        if (n_stalls == CGV_GL_MAX_STALLS)
+        { return;
+        }
+        record = &stalls[n_stalls++];
+        *record = { call, file, line, scope, hot, 0, 0.0, 0.0 };
+    }
+
+    record->count++;
+    record->total_ms += ms;
+    if (ms > record->max_ms)
+    { record->max_ms = ms;
+    }
+}
+
+/**
+* Prints on stderr every synchronizing call found inside a callback
+*/
+void cgvGLStats::print_stalls()
+{ for (int i = 0; i < n_stalls; i++)
+    { fprintf(stderr, "[gl-stats] stall summary: %s at %s:%d in %s%s: %lu calls, %.3f ms total, %.3f ms max\n",
+                stalls[i].call, stalls[i].file, stalls[i].line, stalls[i].scope,
+                stalls[i].hot ? " (hot path)" : "",
+                stalls[i].count, stalls[i].total_ms, stalls[i].max_ms);
+    }
+}
+
+/**
+* Timestamps an input event as it enters its callback. Its latency is measured
+* when the GPU completes the first frame drawn after it, unless the callback
+* defers it with defer_input
+* @param type Type of the event
+*/
+void cgvGLStats::input_event(cgvGLInputType type)
+{ last_event = -1;
+    if (!sync_support)
+    { return;
+    }
+
+    for (int i = 0; i < CGV_GL_MAX_INPUT_EVENTS; i++)
+    { if (events[i].type < 0)
+        { events[i] = { type, now_ms(), -1, 0 };
+            last_event = i;
+            return;
+        }
+    }
+    dropped_events++;
+}
+
+/**
+* Makes the last event timestamped wait for a frame drawn from a snapshot that
+* has applied it, instead of the next frame
+* @param applied Number of events the snapshot must have applied, this one included
+*/
+void cgvGLStats::defer_input(unsigned long applied)
+{ if (last_event >= 0)
+    { events[last_event].after = applied;
+    }
+}
+
+/**
+* Stops measuring the last event timestamped, which its callback has dropped
+* and no frame will reflect
+*/
+void cgvGLStats::drop_input()
+{ if (last_event >= 0)
+    { events[last_event].type = -1;
+        last_event = -1;
+        dropped_events++;
+    }
+}
+
+/**
+* Sets the number of events applied in the snapshot the frame being drawn is
+* drawn from. Deferred events are only tagged with the fence of a frame whose
+* snapshot has applied them
+* @param applied Number of events applied in the snapshot
+*/
+void cgvGLStats::draw_input(unsigned long applied)
+{ drawn_events = applied;
+}
+
+/**
+* Inserts a fence after the frame just swapped if it is the first frame that
+* reflects some input events, and tags those events with it
+*/
+void cgvGLStats::fence_frame()
+{
+#if !(defined(__APPLE__) && defined(__MACH__))
+    if (sync_support < 0)
+    { // glGetString does not wait for the pipeline, unlike glGet*
+        const char* version = (const char*) glGetString(GL_VERSION);
+        const char* extensions = (const char*) glGetString(GL_EXTENSIONS);
+        int major = 0, minor = 0;
+        if (version)
+        { sscanf(version, "%d.%d", &major, &minor);
+        }
+        sync_support = (major > 3 || (major == 3 && minor >= 2)
+                        || (extensions && strstr(extensions, "GL_ARB_sync"))) ? 1 : 0;
+        if (sync_support)
+        { fence_sync = (PFNGLFENCESYNCPROC) glutGetProcAddress("glFenceSync");
+            client_wait_sync = (PFNGLCLIENTWAITSYNCPROC) glutGetProcAddress("glClientWaitSync");
+            delete_sync = (PFNGLDELETESYNCPROC) glutGetProcAddress("glDeleteSync");
+            sync_support = (fence_sync && client_wait_sync && delete_sync) ? 1 : 0;
+        }
+        if (!sync_support)
+        { fprintf(stderr, "[gl-stats] fence sync objects not available, input latency is not measured\n");
+        }
+    }
+#else
+    sync_support = 0;
+#endif   // !(defined(__APPLE__) && defined(__MACH__))
+
+    if (!sync_support)
+    { return;
+    }
+
+    bool waiting = false;
+    for (int i = 0; i < CGV_GL_MAX_INPUT_EVENTS && !waiting; i++)
+    { waiting = (events[i].type >= 0 && events[i].fence < 0 && events[i].after <= drawn_events);
+    }
+    if (!waiting)
+    { return;
+    }
+
+    int fence = -1;
+    for (int i = 0; i < CGV_GL_MAX_FENCES && fence < 0; i++)
+    { if (!fences[i])
+        { fence = i;
+        }
+    }
+    if (fence < 0)
+    { return; // the events will be tagged with the fence of a later frame
+    }
+
+#if !(defined(__APPLE__) && defined(__MACH__))
+    fences[fence] = fence_sync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif   // !(defined(__APPLE__) && defined(__MACH__))
+    for (int i = 0; i < CGV_GL_MAX_INPUT_EVENTS; i++)
+    { if (events[i].type >= 0 && events[i].fence < 0 && events[i].after <= drawn_events)
+        { events[i].fence = fence;
+        }
+    }
+
+    if (!polling)
+    { polling = true;
+        glutTimerFunc(1, poll_fences_timer, 0);
+    }
+}
+
+/**
+* Checks, without blocking, which pending fences have been signaled, and adds
+* the latency of the events tagged with them to their histogram
+* @return true if there are fences still pending
+*/
+bool cgvGLStats::poll_fences()
+{ bool pending = false;
+
+#if !(defined(__APPLE__) && defined(__MACH__))
+    for (int f = 0; f < CGV_GL_MAX_FENCES; f++)
+    { if (!fences[f])
+        { continue;
+        }
+
+        GLenum status = client_wait_sync((GLsync) fences[f], GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status == GL_TIMEOUT_EXPIRED)
+        { pending = true;
+            continue;
+        }
+
+        double now = now_ms();
+        for (int i = 0; i < CGV_GL_MAX_INPUT_EVENTS; i++)
+        { if (events[i].type >= 0 && events[i].fence == f)
+            { double ms = now - events[i].time;
+                cgvGLLatency& l = latency[events[i].type];
+                int bucket = 0;
+                while (bucket < CGV_GL_LATENCY_BUCKETS - 1 && ms >= bucket_limits[bucket])
+                { bucket++;
+                }
+                l.buckets[bucket]++;
+                l.count++;
+                l.total_ms += ms;
+                if (ms > l.max_ms)
+                { l.max_ms = ms;
+                }
+                events[i].type = -1;
+            }
+        }
+
+        delete_sync((GLsync) fences[f]);
+        fences[f] = nullptr;
+    }
+#endif   // !(defined(__APPLE__) && defined(__MACH__))
+
+    polling = pending;
+    return pending;
+}
+
+/**
+* Prints on stderr the input-to-photon latency histogram of each type of event
+*/
+void cgvGLStats::print_latency()
+{ for (int t = 0; t < CGV_INPUT_TYPES; t++)
+    { const cgvGLLatency& l = latency[t];
+        if (!l.count)
+        { continue;
+        }
+
+        fprintf(stderr, "[gl-stats] input latency %s: %lu events, %.3f ms mean, %.3f ms max\n",
+                input_names[t], l.count, l.total_ms / l.count, l.max_ms);
+        for (int b = 0; b < CGV_GL_LATENCY_BUCKETS; b++)
+        { if (b < CGV_GL_LATENCY_BUCKETS - 1)
+            { fprintf(stderr, "[gl-stats]   < %3.0f ms %lu\n", bucket_limits[b], l.buckets[b]);
+            }
+            else
+            { fprintf(stderr, "[gl-stats]  >= %3.0f ms %lu\n", bucket_limits[b - 1], l.buckets[b]);
+            }
+        }
+    }
+
+    if (dropped_events)
+    { fprintf(stderr, "[gl-stats] input latency: %lu events not measured\n", dropped_events);
+    }
+}
+
+/**
+* Starts recording every intercepted call in the trace of the frame
+*/
+void cgvGLStats::enable_trace()
+{ tracing = true;
+}
+
+/**
+* Method to query the trace of the last completed frame
+* @param length Returns the number of calls made in the frame
+* @param kept Returns the number of calls kept in the trace
+* @return The calls of the trace, in the order they were made
+*/
+const cgvGLTraceEntry* cgvGLStats::get_last_trace(unsigned long& length, unsigned long& kept)
+{ int last_trace = 1 - trace_current;
+    length = trace_length[last_trace];
+    kept = (length < CGV_GL_MAX_TRACE) ? length : CGV_GL_MAX_TRACE;
+    return trace[last_trace];
+}
+
+/**
+* Method to query the name of an intercepted entry point
+* @param call cgvGLCall of the entry point
+* @return The name of the entry point
+*/
+const char* cgvGLStats::call_name(int call)
+{ return call_names[call];
+}
+
+/**
+* Method to query the counters of the last completed frame
+* @return The counters gathered between the last two buffer swaps
+*/
+const cgvGLFrameStats& cgvGLStats::get_last_frame()
+{ return last;
+}
+
+/**
+* Method to query the number of completed frames
+* @return The number of calls to glutSwapBuffers so far
+*/
+unsigned long cgvGLStats::get_frame()
+{ return frame;
+}
+
+/**
+* Enters a callback or hot path
+* @param name Name of the scope
+* @param hot Whether the scope is a hot path
+*/
+cgvGLScope::cgvGLScope(const char* name, bool hot)
+{ previous = cgvGLStats::getInstance().enter_scope(name, hot, previous_hot);
+}
+
+/**
+* Leaves the callback or hot path
+*/
+cgvGLScope::~cgvGLScope()
+{ cgvGLStats::getInstance().leave_scope(previous, previous_hot);
+}
+
+// Counting wrappers -------------------------------------
+
+#define CGV_COUNT(name) cgvGLStats::getInstance().count(CGV_CALL_##name)
+
+void cgvGL_glBegin(GLenum mode)
+{ CGV_COUNT(glBegin);
+    cgvGLStats::getInstance().draw_call();
+    glBegin(mode);
+}
+
+void cgvGL_glEnd()
+{ CGV_COUNT(glEnd);
+    glEnd();
+}
+
+void cgvGL_glVertex3f(GLfloat x, GLfloat y, GLfloat z)
+{ CGV_COUNT(glVertex3f);
+    cgvGLStats::getInstance().add_vertices(1);
+    glVertex3f(x, y, z);
+}
+
+void cgvGL_glColor3f(GLfloat r, GLfloat g, GLfloat b)
+{ CGV_COUNT(glColor3f);
+    glColor3f(r, g, b);
+}
+
+void cgvGL_glMaterialfv(GLenum face, GLenum pname, const GLfloat* params)
+{ CGV_COUNT(glMaterialfv);
+    glMaterialfv(face, pname, params);
+}
+
+void cgvGL_glLightfv(GLenum light, GLenum pname, const GLfloat* params)
+{ CGV_COUNT(glLightfv);
+    glLightfv(light, pname, params);
+}
+
+void cgvGL_glEnable(GLenum cap)
+{ CGV_COUNT(glEnable);
+    glEnable(cap);
+}
+
+void cgvGL_glDisable(GLenum cap)
+{ CGV_COUNT(glDisable);
+    glDisable(cap);
+}
+
+void cgvGL_glClear(GLbitfield mask)
+{ CGV_COUNT(glClear);
+    glClear(mask);
+}
+
+void cgvGL_glClearColor(GLclampf r, GLclampf g, GLclampf b, GLclampf a)
+{ CGV_COUNT(glClearColor);
+    glClearColor(r, g, b, a);
+}
+
+void cgvGL_glViewport(GLint x, GLint y, GLsizei w, GLsizei h)
+{ CGV_COUNT(glViewport);
+    glViewport(x, y, w, h);
+}
+
+void cgvGL_glMatrixMode(GLenum mode)
+{ CGV_COUNT(glMatrixMode);
+    cgvGLStats::getInstance().matrix_mode(mode);
+    glMatrixMode(mode);
+}
+
+void cgvGL_glLoadIdentity()
+{ CGV_COUNT(glLoadIdentity);
+    glLoadIdentity();
+}
+
+void cgvGL_glPushMatrix()
+{ CGV_COUNT(glPushMatrix);
+    cgvGLStats::getInstance().push_matrix();
+    glPushMatrix();
+}
+
+void cgvGL_glPopMatrix()
+{ CGV_COUNT(glPopMatrix);
+    cgvGLStats::getInstance().pop_matrix();
+    glPopMatrix();
+}
+
+void cgvGL_glTranslatef(GLfloat x, GLfloat y, GLfloat z)
+{ CGV_COUNT(glTranslatef);
+    glTranslatef(x, y, z);
+}
+
+void cgvGL_glRotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z)
+{ CGV_COUNT(glRotatef);
+    glRotatef(angle, x, y, z);
+}
+
+void cgvGL_glScalef(GLfloat x, GLfloat y, GLfloat z)
+{ CGV_COUNT(glScalef);
+    glScalef(x, y, z);
+}
+
+void cgvGL_glLoadMatrixf(const GLfloat* m)
+{ CGV_COUNT(glLoadMatrixf);
+    glLoadMatrixf(m);
+}
+
+void cgvGL_glMultMatrixf(const GLfloat* m)
+{ CGV_COUNT(glMultMatrixf);
+    glMultMatrixf(m);
+}
+
+void cgvGL_glOrtho(GLdouble l, GLdouble r, GLdouble b, GLdouble t, GLdouble n, GLdouble f)
+{ CGV_COUNT(glOrtho);
+    glOrtho(l, r, b, t, n, f);
+}
+
+void cgvGL_glFrustum(GLdouble l, GLdouble r, GLdouble b, GLdouble t, GLdouble n, GLdouble f)
+{ CGV_COUNT(glFrustum);
+    glFrustum(l, r, b, t, n, f);
+}
+
+void cgvGL_glCallList(GLuint list)
+{ CGV_COUNT(glCallList);
+    cgvGLStats::getInstance().draw_call();
+    glCallList(list);
+}
+
+void cgvGL_glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{ CGV_COUNT(glDrawArrays);
+    cgvGLStats::getInstance().draw_call();
+    cgvGLStats::getInstance().add_vertices(count);
+    glDrawArrays(mode, first, count);
+}
+
+void cgvGL_glPolygonMode(GLenum face, GLenum mode)
+{ CGV_COUNT(glPolygonMode);
+    glPolygonMode(face, mode);
+}
+
+void cgvGL_glLineWidth(GLfloat width)
+{ CGV_COUNT(glLineWidth);
+    glLineWidth(width);
+}
+
+// Synchronizing calls are timed, since they wait for the pipeline to drain
+
+#define CGV_TIMED(name, file, line, call) \
+    CGV_COUNT(name); \
+    auto start = std::chrono::steady_clock::now(); \
+    call; \
+    std::chrono::duration<double, std::milli> blocked = std::chrono::steady_clock::now() - start; \
+    cgvGLStats::getInstance().stall(#name, file, line, blocked.count())
+
+void cgvGL_glGetFloatv(GLenum pname, GLfloat* params, const char* file, int line)
+{ CGV_TIMED(glGetFloatv, file, line, glGetFloatv(pname, params));
+}
+
+void cgvGL_glGetIntegerv(GLenum pname, GLint* params, const char* file, int line)
+{ CGV_TIMED(glGetIntegerv, file, line, glGetIntegerv(pname, params));
+}
+
+void cgvGL_glGetDoublev(GLenum pname, GLdouble* params, const char* file, int line)
+{ CGV_TIMED(glGetDoublev, file, line, glGetDoublev(pname, params));
+}
+
+void cgvGL_glGetBooleanv(GLenum pname, GLboolean* params, const char* file, int line)
+{ CGV_TIMED(glGetBooleanv, file, line, glGetBooleanv(pname, params));
+}
+
+void cgvGL_glReadPixels(GLint x, GLint y, GLsizei w, GLsizei h, GLenum format, GLenum type,
+                        GLvoid* pixels, const char* file, int line)
+{ CGV_TIMED(glReadPixels, file, line, glReadPixels(x, y, w, h, format, type, pixels));
+}
+
+void cgvGL_glFinish(const char* file, int line)
+{ CGV_TIMED(glFinish, file, line, glFinish());
+}
+
+void cgvGL_gluLookAt(GLdouble eyeX, GLdouble eyeY, GLdouble eyeZ,
+                     GLdouble centerX, GLdouble centerY, GLdouble centerZ,
+                     GLdouble upX, GLdouble upY, GLdouble upZ)
+{ CGV_COUNT(gluLookAt);
+    gluLookAt(eyeX, eyeY, eyeZ, centerX, centerY, centerZ, upX, upY, upZ);
+}
+
+void cgvGL_gluPerspective(GLdouble fovy, GLdouble aspect, GLdouble zNear, GLdouble zFar)
+{ CGV_COUNT(gluPerspective);
+    gluPerspective(fovy, aspect, zNear, zFar);
+}
+
+GLUquadric* cgvGL_gluNewQuadric()
+{ CGV_COUNT(gluNewQuadric);
+    return gluNewQuadric();
+}
+
+void cgvGL_gluDeleteQuadric(GLUquadric* quad)
+{ CGV_COUNT(gluDeleteQuadric);
+    gluDeleteQuadric(quad);
+}
+
+void cgvGL_gluQuadricDrawStyle(GLUquadric* quad, GLenum draw)
+{ CGV_COUNT(gluQuadricDrawStyle);
+    gluQuadricDrawStyle(quad, draw);
+}
+
+// GLU and GLUT solids count as one draw call, and their vertices are
+// estimated from the tessellation grid they generate
+
+void cgvGL_gluCylinder(GLUquadric* quad, GLdouble base, GLdouble top, GLdouble height,
+                       GLint slices, GLint stacks)
+{ CGV_COUNT(gluCylinder);
+    cgvGLStats::getInstance().draw_call();
+    cgvGLStats::getInstance().add_vertices(2 * (slices + 1) * stacks);
+    gluCylinder(quad, base, top, height, slices, stacks);
+}
+
+void cgvGL_glutSolidCube(GLdouble size)
+{ CGV_COUNT(glutSolidCube);
+    cgvGLStats::getInstance().draw_call();
+    cgvGLStats::getInstance().add_vertices(24);
+    glutSolidCube(size);
+}
+
+void cgvGL_glutSolidCone(GLdouble base, GLdouble height, GLint slices, GLint stacks)
+{ CGV_COUNT(glutSolidCone);
+    cgvGLStats::getInstance().draw_call();
+    cgvGLStats::getInstance().add_vertices((slices + 1) * (stacks + 2));
+    glutSolidCone(base, height, slices, stacks);
+}
+
+void cgvGL_glutSolidSphere(GLdouble radius, GLint slices, GLint stacks)
+{ CGV_COUNT(glutSolidSphere);
+    cgvGLStats::getInstance().draw_call();
+    cgvGLStats::getInstance().add_vertices((slices + 1) * (stacks + 1));
+    glutSolidSphere(radius, slices, stacks);
+}
+
+void cgvGL_glutSwapBuffers()
+{ CGV_COUNT(glutSwapBuffers);
+    glutSwapBuffers();
+    cgvGLStats::getInstance().fence_frame();
+    cgvGLStats::getInstance().poll_fences();
+    cgvGLStats::getInstance().end_frame();
+}
+
+void cgvGL_glutPostRedisplay()
+{ CGV_COUNT(glutPostRedisplay);
+    glutPostRedisplay();
+}
+
+// Callback trampolines ----------------------------------
+
+static void (*display_callback)() = nullptr;
+static void (*reshape_callback)(int, int) = nullptr;
+static void (*keyboard_callback)(unsigned char, int, int) = nullptr;
+static void (*special_callback)(int, int, int) = nullptr;
+static void (*menu_callback)(int) = nullptr;
+
+static void display_trampoline()
+{ cgvGLScope scope("displayFunc", true);
+    display_callback();
+}
+
+static void reshape_trampoline(int w, int h)
+{ cgvGLScope scope("reshapeFunc", false);
+    reshape_callback(w, h);
+}
+
+static void keyboard_trampoline(unsigned char key, int x, int y)
+{ cgvGLStats::getInstance().input_event(CGV_INPUT_KEYBOARD);
+    cgvGLScope scope("keyboardFunc", false);
+    keyboard_callback(key, x, y);
+}
+
+static void special_trampoline(int key, int x, int y)
+{ cgvGLStats::getInstance().input_event(CGV_INPUT_SPECIAL);
+    cgvGLScope scope("specialFunc", false);
+    special_callback(key, x, y);
+}
+
+static void menu_trampoline(int value)
+{ cgvGLStats::getInstance().input_event(CGV_INPUT_MENU);
+    cgvGLScope scope("menuFunc", false);
+    menu_callback(value);
+}
+
+void cgvGL_glutDisplayFunc(void (*callback)())
+{ display_callback = callback;
+    glutDisplayFunc(callback ? display_trampoline : nullptr);
+}
+
+void cgvGL_glutReshapeFunc(void (*callback)(int, int))
+{ reshape_callback = callback;
+    glutReshapeFunc(callback ? reshape_trampoline : nullptr);
+}
+
+void cgvGL_glutKeyboardFunc(void (*callback)(unsigned char, int, int))
+{ keyboard_callback = callback;
+    glutKeyboardFunc(callback ? keyboard_trampoline : nullptr);
+}
+
+void cgvGL_glutSpecialFunc(void (*callback)(int, int, int))
+{ special_callback = callback;
+    glutSpecialFunc(callback ? special_trampoline : nullptr);
+}
+
+// Only one menu callback is kept, which is enough for the menus of these programs
+int cgvGL_glutCreateMenu(void (*callback)(int))
+{ menu_callback = callback;
+    return glutCreateMenu(menu_trampoline);
+}
+
+#endif   // CGV_GL_STATS
@@ -1,6 +1,15 @@
+#include <chrono>
 #include <cstdlib>
+#include <cstring>
+#include <stdio.h>
 
 #include "cgvInterface.h"
+#include "cgvGLCore.h"
+#include "cgvDynamicResolution.h"
+#include "cgvFlightRecorder.h"
+#include "cgvFrameArena.h"
+#include "cgvJobSystem.h"
+#include "cgvMetrics.h"
 
 // Singleton Pattern Application
 cgvInterface* cgvInterface::_instance = nullptr;
@@ -39,7 +48,15 @@ cgvInterface& cgvInterface::getInstance()
 * @param _pos_Y Y coordinate of the initial position of the display * window
 * @param _title Title of the display window
 * @pre All parameters are assumed to be Parameters have valid values
-* @post Changes the height and width of the window stored in the object
+* @post Changes the height and width of the window stored in the object. The
+* renderer backend is chosen with the --renderer=<name> option (immediate by
+* default); the core backend gets an OpenGL 3.3 core-profile context. With
+* --headless, no window is created and the scenes are drawn to files by
+* start_display_loop, which needs a backend that draws to memory; --frames=<n>
+* draws each of them n times, so the steady frames can be checked. The job system
+* is started here; --bench-jobs measures its overhead and exits. With
+* --threaded-input, the input changes the scene on a simulation thread, and the
+* display draws the last snapshot of the scene it has published
 */
 void cgvInterface::configure_environment (int argc, char** argv
         , int _window_width, int _window_height
@@ -49,20 +66,82 @@ void cgvInterface::configure_environment (int argc, char** argv
     window_width = _window_width;
     window_height = _window_height;
 
+    const char* renderer_name = "immediate";
+    bool bench_jobs = false;
+    bool threaded_input = false;
+    for ( int i = 1; i < argc; i++ )
+    { if ( strncmp ( argv[i], "--renderer=", 11 ) == 0 )
+        { renderer_name = argv[i] + 11;
+        }
+        else if ( strcmp ( argv[i], "--headless" ) == 0 )
+        { headless = true;
+        }
+        else if ( strncmp ( argv[i], "--frames=", 9 ) == 0 && atoi ( argv[i] + 9 ) > 0 )
+        { headless_frames = atoi ( argv[i] + 9 );
+        }
+        else if ( strcmp ( argv[i], "--bench-jobs" ) == 0 )
+        { bench_jobs = true;
+        }
+        else if ( strcmp ( argv[i], "--threaded-input" ) == 0 )
+        { threaded_input = true;
+        }
+        else
+        { fprintf ( stderr, "Unknown option %s (use --renderer=<name>, --headless, --frames=<n>"
+                            ", --threaded-input or --bench-jobs)\n", argv[i] );
+        }
+    }
+
+    // workers for the parallel parts of the frames
+    cgvJobSystem::getInstance().initialize();
+    if ( bench_jobs )
+    { cgvJobSystem::getInstance().benchmark( stdout, 100000 );
+        exit( 0 );
+    }
+
+    renderer = cgvRenderer::create ( renderer_name );
+    if ( !renderer )
+    { fprintf ( stderr, "Unknown renderer %s (available: %s)\n", renderer_name, cgvRenderer::get_names() );
+        exit ( 1 );
+    }
+    if ( headless && renderer->requires_window() )
+    { fprintf ( stderr, "The %s renderer needs a window; use --renderer=software with --headless\n"
+                , renderer->get_name() );
+        exit ( 1 );
+    }
+
+    cgvMetrics::getInstance().open( "pr1a" ); // live metrics, if CGV_METRICS_SHM is set
+
 // initialize the display window
-    glutInit ( &argc, argv );
-    glutInitDisplayMode ( GLUT_RGB | GLUT_DOUBLE | GLUT_DEPTH );
-    glutInitWindowSize ( _window_width, _window_height );
-    glutInitWindowPosition ( _x_pos, _y_pos );
-    glutCreateWindow( _title.c_str() );
+    if ( !headless )
+    { glutInit ( &argc, argv );
+        if ( renderer->requires_core_profile() )
+        { cgvGLCore::request_context ( GLUT_RGB | GLUT_DOUBLE | GLUT_DEPTH );
+        }
+        else
+        { glutInitDisplayMode ( GLUT_RGB | GLUT_DOUBLE | GLUT_DEPTH );
+        }
+        glutInitWindowSize ( _window_width, _window_height );
+        glutInitWindowPosition ( _x_pos, _y_pos );
+        glutCreateWindow( _title.c_str() );
 
-    create_menu();
+        create_menu();
+    }
 
-    glEnable( GL_DEPTH_TEST ); // enable z-buffer surface hiding
-    glClearColor( 1.0, 1.0, 1.0, 0.0 ); // set the window background color
+    // the renderer enables the depth test, and the lighting for the materials that are lit
+    if ( !renderer->initialize() )
+    { fprintf( stderr, "The %s renderer is not available\n", renderer->get_name() );
+        exit( 1 );
+    }
+    renderer->set_clear_color( 1.0, 1.0, 1.0 ); // set the window background color
+    scene.set_renderer( renderer );
+    fprintf( stderr, "[renderer] drawing with the %s renderer\n", renderer->get_name() );
 
-    glEnable( GL_LIGHTING ); // enable scene lighting
-    glEnable( GL_NORMALIZE ); // normalize normal vectors for lighting calculations
+    // from here on, the scene and menuSelection only change on the simulation thread
+    if ( threaded_input )
+    { simulation = new cgvSimulation( [this] ( const cgvInputEvent& event ) { apply_event( event ); }
+                , [this] ( cgvSceneSnapshot& snapshot ) { scene.record( menuSelection, snapshot ); } );
+        fprintf( stderr, "[simulation] input applied on its own thread\n" );
+    }
 }
 
 /**
@@ -84,7 +163,55 @@ void cgvInterface::create_menu ()
 * Method to display the scene and wait for events on the interface
 */
 void cgvInterface::start_display_loop()
-{ glutMainLoop(); // starts the GLUT display loop
+{ if ( headless )
+    { render_headless();
+        return;
+    }
+    glutMainLoop(); // starts the GLUT display loop
+}
+
+/**
+* Method to draw every scene without a window, as many frames as --frames asks,
+* and save the last frame of each one to pr1a_scene<A|B|C>.ppm in the working
+* directory. Each scene starts a new warm-up of CGV_ARENA_CHECK; if a frame after
+* it allocates from the heap, the program exits with 1 once all are drawn
+*/
+void cgvInterface::render_headless()
+{ const int scenes[] = { scene.SceneA, scene.SceneB, scene.SceneC };
+    const char* names[] = { "A", "B", "C" };
+
+    reshapeFunc( window_width, window_height );
+    for ( int i = 0; i < 3; i++ )
+    { if ( simulation )
+        { // select the scene as the menu would, and wait for its snapshot
+            simulation->push( { CGV_EVENT_MENU, scenes[i], 0, 0 } );
+            while ( simulation->latest().events < (unsigned long) i + 1 )
+            { std::this_thread::yield();
+            }
+        }
+        else
+        { menuSelection = scenes[i];
+        }
+        cgvFrameArena::getInstance().restart_check();
+        for ( int frame = 0; frame < headless_frames; frame++ )
+        { displayFunc();
+        }
+
+        std::string path = std::string( "pr1a_scene" ) + names[i] + ".ppm";
+        if ( renderer->save_frame( path.c_str() ) )
+        { printf( "%s: %lu meshes\n", path.c_str()
+                    , simulation ? simulation->latest().instances : scene.get_instances() );
+        }
+        else
+        { fprintf( stderr, "Could not write %s\n", path.c_str() );
+        }
+    }
+
+    unsigned long allocations = cgvFrameArena::getInstance().get_checked_allocations();
+    if ( allocations > 0 )
+    { fprintf( stderr, "[arena] %lu heap allocations after the warm-up frames\n", allocations );
+        exit( 1 );
+    }
 }
 
 /**
@@ -98,36 +225,107 @@ void cgvInterface::start_display_loop()
 * @post The scene may change depending on the key pressed
 */
 void cgvInterface::keyboardFunc (unsigned char key, int x, int y)
+{ cgvFlightRecorder::getInstance().input( "keyboardFunc", key, x, y );
+
+    // the keys that change the scene are applied by the simulation thread
+    if ( _instance->simulation && key != 'c' && key != 27 )
+    { _instance->queue( { CGV_EVENT_KEY, key, x, y } );
+        return;
+    }
+
+    _instance->apply_key( key );
+    glutPostRedisplay (); // refresh the contents of the viewport
+}
+
+/**
+* Method to change the scene as a key asks. Called from keyboardFunc, or from the
+* simulation thread with --threaded-input
+* @param key Code of the key pressed
+*/
+void cgvInterface::apply_key (unsigned char key)
 { switch ( key )
     { case 'e': // toggle the display of the axes
-            _instance->scene.set_axes(_instance->scene.get_axes() ? false : true);
+            scene.set_axes(scene.get_axes() ? false : true);
             break;
         case 'E': // toggle the display of the axes
-            _instance->scene.set_axes(_instance->scene.get_axes() ? false : true);
+            scene.set_axes(scene.get_axes() ? false : true);
             break;
         case 'X':
-            _instance->scene.incrStacksX();
+            scene.incrStacksX();
             break;
         case 'x':
-            _instance->scene.decrStacksX();
+            scene.decrStacksX();
             break;
         case 'Y':
-            _instance->scene.incrStacksY();
+            scene.incrStacksY();
             break;
         case 'y':
-            _instance->scene.decrStacksY();
+            scene.decrStacksY();
             break;
         case 'Z':
-            _instance->scene.incrStacksZ();
+            scene.incrStacksZ();
             break;
         case 'z':
-            _instance->scene.decrStacksZ();
+            scene.decrStacksZ();
+            break;
+        case 'a': // start or stop the animation of the shoe boxes of scene C
+        case 'A':
+            scene.set_animated( !scene.get_animated() );
+            break;
+        case 'l': // add or remove the lights over the aisles of scene C
+        case 'L':
+            scene.set_aisle_lights( !scene.get_aisle_lights() );
+            break;
+        case 's': // turn the shadows of the point light on or off
+        case 'S':
+            scene.set_shadows( !scene.get_shadows() );
+            break;
+        case 'o': // outline the shoe boxes or stop outlining them
+        case 'O':
+            scene.set_outlines( !scene.get_outlines() );
+            break;
+        case 'c': // print the commands the scene is replayed from
+            if ( simulation )
+            { const cgvSceneSnapshot& snapshot = simulation->latest();
+                snapshot.commands.dump( stdout );
+                printf( "recorded %lu times\n", snapshot.recordings );
+            }
+            else
+            { scene.get_commands().dump( stdout );
+                printf( "recorded %lu times\n", scene.get_recordings() );
+            }
             break;
         case 27: // escape key to EXIT
             exit ( 1 );
             break;
     }
-    glutPostRedisplay (); // refresh the contents of the viewport
+}
+
+/**
+* Method to queue the event of a GLUT callback for the simulation thread. Its
+* latency is measured up to the first frame drawn from a snapshot that has applied it
+* @param event Event received by the callback
+*/
+void cgvInterface::queue (const cgvInputEvent& event)
+{ if ( simulation->push( event ) )
+    { CGV_GL_INPUT_AFTER( simulation->get_queued() );
+    }
+    else
+    { CGV_GL_INPUT_DROPPED();
+    }
+}
+
+/**
+* Method to apply an input event on the simulation thread
+* @param event Event pushed by a GLUT callback
+*/
+void cgvInterface::apply_event (const cgvInputEvent& event)
+{ if ( event.type == CGV_EVENT_KEY )
+    { apply_key( (unsigned char) event.value );
+    }
+    else
+    { menuSelection = event.value;
+    }
 }
 
 /**
@@ -139,31 +337,93 @@ void cgvInterface::keyboardFunc (unsigned char key, int x, int y)
 */
 void cgvInterface::reshapeFunc (int w, int h)
 { // reshape the viewport to the new window width and height
-    glViewport ( 0, 0, (GLsizei) w, (GLsizei) h );
+    _instance->renderer->set_viewport ( 0, 0, (GLsizei) w, (GLsizei) h );
 
 // save the new viewport values
     _instance->set_window_width ( w );
     _instance->set_window_height ( h );
 
-// sets the projection type to use
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-
-    glOrtho(-1*5, 1*5, -1*5, 1*5, -1*5, 200);
-
-// define the view camera
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-
-    gluLookAt(1.5, 1.0, 2.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0); // perspective view
-// gluLookAt(1.5, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0); // plan view from the positive X axis
+// sets the projection type to use and defines the view camera
+    cgvMat4 projection = cgvMat4::ortho( -1*5, 1*5, -1*5, 1*5, -1*5, 200 );
+    cgvMat4 view = cgvMat4::look_at( cgvVec3( 1.5, 1.0, 2.0 ), cgvVec3( 0.0, 0.0, 0.0 ), cgvVec3( 0.0, 1.0, 0.0 ) ); // perspective view
+// cgvMat4 view = cgvMat4::look_at( cgvVec3( 1.5, 0.0, 0.0 ), cgvVec3( 0.0, 0.0, 0.0 ), cgvVec3( 0.0, 1.0, 0.0 ) ); // plan view from the positive X axis
+    _instance->renderer->set_camera( projection, view );
 }
 
 /**
 * Method for displaying the scene
 */
 void cgvInterface::displayFunc ()
-{ _instance->scene.display( _instance->menuSelection );
+{ auto start = std::chrono::steady_clock::now();
+
+    cgvFlightRecorder& recorder = cgvFlightRecorder::getInstance();
+    recorder.begin_frame();
+    unsigned long instances;
+    bool animated;
+    if ( _instance->simulation )
+    { // draw the last state published, without reading the scene the simulation changes
+        const cgvSceneSnapshot& snapshot = _instance->simulation->latest();
+        recorder.value( "scene", snapshot.scene );
+        recorder.value( "axes", snapshot.axes );
+        recorder.value( "nStacksX", snapshot.nStacksX );
+        recorder.value( "nStacksY", snapshot.nStacksY );
+        recorder.value( "nStacksZ", snapshot.nStacksZ );
+        recorder.value( "commands", snapshot.commands.get_commands().size() );
+        recorder.value( "events", snapshot.events );
+
+        CGV_GL_INPUT_DRAWN( snapshot.events );
+        _instance->scene.display( snapshot.commands, snapshot.animated, snapshot.shadows, snapshot.outlines );
+        instances = snapshot.instances;
+        animated = snapshot.animated;
+    }
+    else
+    { recorder.value( "scene", _instance->menuSelection );
+        recorder.value( "axes", _instance->scene.get_axes() );
+        recorder.value( "nStacksX", _instance->scene.get_stacksX() );
+        recorder.value( "nStacksY", _instance->scene.get_stacksY() );
+        recorder.value( "nStacksZ", _instance->scene.get_stacksZ() );
+        recorder.value( "commands", _instance->scene.get_commands().get_commands().size() );
+
+        _instance->scene.display( _instance->menuSelection );
+        instances = _instance->scene.get_instances();
+        animated = _instance->scene.get_animated() && _instance->menuSelection == _instance->scene.SceneC;
+    }
+    if ( !_instance->headless )
+    { _instance->renderer->present();
+        if ( animated )
+        { glutPostRedisplay (); // the boxes move on every frame
+        }
+    }
+    recorder.value( "streamed_bytes", _instance->renderer->get_streamed_bytes() );
+    recorder.value( "stream_waits", _instance->renderer->get_stream_waits() );
+    recorder.value( "culled_instances", _instance->renderer->get_culled_instances() );
+    recorder.value( "shadow_rebuilds", _instance->renderer->get_shadow_rebuilds() );
+    recorder.value( "shadow_ms", _instance->renderer->get_shadow_ms() );
+
+    std::chrono::duration<double, std::milli> frame_time = std::chrono::steady_clock::now() - start;
+
+    // the control loop of the dynamic resolution sets the scale of the next frames
+    cgvDynamicResolution& resolution = cgvDynamicResolution::getInstance();
+    GLfloat scale = _instance->renderer->get_resolution_scale();
+    cgvResolutionStep step = resolution.update( frame_time.count() );
+    if ( step != CGV_RESOLUTION_HOLD )
+    { _instance->renderer->set_resolution_scale( resolution.get_scale() );
+    }
+    recorder.value( "resolution_scale", scale );
+
+    cgvMetrics::getInstance().set_counts( _instance->scene.get_draw_calls(), instances
+                                          , _instance->renderer->get_culled_instances() );
+    cgvMetrics::getInstance().set_resolution( scale, resolution.get_target_ms(), step );
+    cgvMetrics::getInstance().set_shadows( _instance->renderer->get_shadow_rebuilds()
+                                           , _instance->renderer->get_shadow_ms() );
+    cgvMetrics::getInstance().end_frame( frame_time.count() );
+
+    // the buffers have been swapped: the data of the frame is no longer needed
+    cgvFrameArena& arena = cgvFrameArena::getInstance();
+    recorder.value( "arena_bytes", arena.get_used() );
+    recorder.value( "heap_allocations", arena.get_frame_allocations() );
+    arena.reset();
+    recorder.end_frame();
 }
 
 /**
@@ -173,17 +433,40 @@ void cgvInterface::displayFunc ()
 * @post Stores the selected option in the object
 */
 void cgvInterface::menuHandle (int value )
-{ _instance->menuSelection = value;
+{ cgvFlightRecorder::getInstance().input( "menuHandle", value, 0, 0 );
+    if ( _instance->simulation )
+    { _instance->queue( { CGV_EVENT_MENU, value, 0, 0 } );
+        return;
+    }
+    _instance->menuSelection = value;
     glutPostRedisplay (); // renew the contents of the window
 }
 
+/**
+* Method to check, with --threaded-input, whether the simulation thread has
+* published a snapshot to draw. Registered again on every call
+* @param value Not used
+*/
+void cgvInterface::timerFunc (int /*value*/)
+{ if ( _instance->simulation->has_new_snapshot() )
+    { glutPostRedisplay ();
+    }
+    glutTimerFunc ( CGV_SNAPSHOT_POLL_MS, timerFunc, 0 );
+}
+
 /**
 * Method to initialize callbacks
 */
 void cgvInterface::initialize_callbacks()
-{ glutKeyboardFunc ( keyboardFunc );
+{ if ( headless )
+    { return; // there is no window to receive events
+    }
+    glutKeyboardFunc ( keyboardFunc );
     glutReshapeFunc ( reshapeFunc );
     glutDisplayFunc ( displayFunc );
+    if ( simulation )
+    { glutTimerFunc ( CGV_SNAPSHOT_POLL_MS, timerFunc, 0 );
+    }
 }
 
 /**
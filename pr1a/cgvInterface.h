@@ -11,8 +11,14 @@
 #include <GL/glut.h>
 #endif   // defined(__APPLE__) && defined(__MACH__)
 
+#include "cgvGLStats.h"
+
 #include <string>
 #include "cgvScene3D.h"
+#include "cgvRenderer.h"
+#include "cgvSimulation.h"
+
+#define CGV_SNAPSHOT_POLL_MS 5 ///< Interval between the checks for new snapshots, with --threaded-input
 
 /**
 * Objects of this class encapsulate the interface and state of the application.
@@ -27,6 +33,11 @@ class cgvInterface
 
     int menuSelection = 0; ///< Last selected menu item
 
+    cgvRenderer* renderer = nullptr; ///< Renderer backend the scene is drawn with
+    bool headless = false; ///< Whether the scenes are drawn to files instead of a window
+    int headless_frames = 1; ///< Frames each scene is drawn with --headless, set with --frames=<n>
+    cgvSimulation* simulation = nullptr; ///< Thread that applies the input, with --threaded-input; nullptr otherwise
+
     // Implementing the Singleton pattern
     static cgvInterface* _instance; ///< Pointer to the singleton object of the class
     cgvInterface();
@@ -43,6 +54,7 @@ public:
     // Automatically called when the window is resized
     static void displayFunc (); // Method for displaying the scene
     static void menuHandle(int value); // method to manage menu option selection
+    static void timerFunc(int value); // Asks for a redisplay when the simulation has published a snapshot
 
     // Methods
     // initializes all parameters to create a display window
@@ -57,6 +69,12 @@ public:
 
     void start_display_loop(); // Displays the scene and waits for events on the interface
 
+    void render_headless(); // Draws every scene and saves them as PPM files
+
+    void apply_key(unsigned char key); // Changes the scene as a key asks
+    void queue(const cgvInputEvent& event); // Queues the event of a GLUT callback for the simulation thread
+    void apply_event(const cgvInputEvent& event); // Applies an event queued for the simulation thread
+
     // Get_ and set_ methods for accessing attributes
     int get_window_width();
     int get_window_height();
@@ -0,0 +1,315 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#include "cgvJobSystem.h"
+
+// Initialization of the static singleton pointer
+cgvJobSystem* cgvJobSystem::_instance = nullptr;
+
+// Worker of the calling thread, -1 for threads that are not workers
+static thread_local int worker_index = -1;
+
+/**
+ * Loop run by parallel_for: its body and the iterations below which ranges are
+ * not split
+ */
+struct cgvParallelFor {
+    const std::function<void(int first, int last)>* body; ///< Body of the loop
+    int grain; ///< Largest range that is not split
+};
+
+/**
+* Method to get the only instance of the class, following the Singleton pattern
+* @return Reference to the job system
+*/
+cgvJobSystem& cgvJobSystem::getInstance()
+{ if (!_instance)
+    { _instance = new cgvJobSystem;
+    }
+    return *_instance;
+}
+
+/**
+* Destructor that waits for the workers to exit
+*/
+cgvJobSystem::~cgvJobSystem()
+{ { std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread: threads)
+    { thread.join();
+    }
+}
+
+/**
+* Starts the workers, with the calling thread as the first one. Does nothing if
+* the job system has already been initialized
+* @param _threads Number of workers, calling thread included; 0 to take it from
+* CGV_JOB_THREADS or, if it is not set, from the hardware threads
+*/
+void cgvJobSystem::initialize(unsigned int _threads)
+{ if (workers)
+    { return;
+    }
+
+    if (_threads == 0)
+    { _threads = std::thread::hardware_concurrency();
+        const char* requested = getenv("CGV_JOB_THREADS");
+        if (requested && atoi(requested) > 0)
+        { _threads = (unsigned int) atoi(requested);
+        }
+    }
+    count = _threads > 0 ? _threads : 1;
+
+    workers.reset(new cgvJobWorker[count]);
+    worker_index = 0;
+    for (unsigned int i = 1; i < count; i++)
+    { threads.emplace_back(&cgvJobSystem::work, this, i);
+    }
+    fprintf(stderr, "[jobs] job system with %u threads\n", count);
+}
+
+/**
+* Method to query the number of workers
+* @return The workers, including the thread that initialized the job system; 1
+* if it has not been initialized
+*/
+unsigned int cgvJobSystem::get_threads()
+{ return workers ? count : 1;
+}
+
+/**
+* Creates a job, which does not run until it is passed to run. Jobs are taken in
+* turn from CGV_JOB_CAPACITY slots of the calling thread; if the next one is still
+* in use, other jobs are run until it is finished
+* @param function Work of the job, called with the job
+* @param data Argument for the function, in cgvJob::data
+* @param parent Job that is not finished until this one is, or nullptr
+* @return The job
+* @pre The job system has been initialized, and it is called from the thread that
+* initialized it or from a job
+*/
+cgvJob* cgvJobSystem::create(void (*function)(cgvJob* job), void* data, cgvJob* parent)
+{ cgvJobWorker& worker = workers[worker_index];
+    cgvJob* job = &worker.jobs[worker.created++ & (CGV_JOB_CAPACITY - 1)];
+    wait(job);
+
+    job->function = function;
+    job->data = data;
+    job->first = job->last = 0;
+    job->parent = parent;
+    job->unfinished = 1;
+    if (parent)
+    { parent->unfinished++;
+    }
+    return job;
+}
+
+/**
+* Queues a job on the calling thread, waking up a worker to steal it if one is idle
+* @param job Job made by create
+* @pre It is called from the thread that created the job
+*/
+void cgvJobSystem::run(cgvJob* job)
+{ cgvJobWorker& worker = workers[worker_index];
+    { std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queue[worker.tail++ & (CGV_JOB_CAPACITY - 1)] = job;
+    }
+    pending++;
+
+    if (sleeping > 0)
+    { std::lock_guard<std::mutex> lock(sleep_mutex);
+        wake.notify_one();
+    }
+}
+
+/**
+* Runs queued jobs until a job and its children are finished
+* @param job Job to wait for
+*/
+void cgvJobSystem::wait(cgvJob* job)
+{ while (job->unfinished > 0)
+    { cgvJob* other = take();
+        if (other)
+        { execute(other);
+        }
+        else
+        { std::this_thread::yield();
+        }
+    }
+}
+
+/**
+* Runs body over a range of iterations on all the workers, and returns once it
+* has finished. The range is split in halves down to grain iterations; the
+* calling thread keeps the first half and the second one can be stolen, so idle
+* workers take the largest ranges left. The grain is raised if needed so that a
+* loop does not create more than CGV_JOB_CAPACITY / 2 jobs. Threads that are not
+* workers run the whole loop themselves
+* @param iterations Number of iterations
+* @param grain Largest range that is not split; 0 to split in about 8 ranges per worker
+* @param body Function called with ranges [first, last) of the iterations
+*/
+void cgvJobSystem::parallel_for(int iterations, int grain, const std::function<void(int first, int last)>& body)
+{ if (iterations <= 0)
+    { return;
+    }
+    if (grain <= 0)
+    { grain = std::max(1, iterations / (int) (get_threads() * 8));
+    }
+    grain = std::max(grain, (iterations + CGV_JOB_CAPACITY / 2 - 1) / (CGV_JOB_CAPACITY / 2));
+    if (get_threads() == 1 || worker_index < 0 || iterations <= grain)
+    { body(0, iterations);
+        return;
+    }
+
+    cgvParallelFor loop = { &body, grain };
+    cgvJob* root = create(run_range, &loop);
+    root->first = 0;
+    root->last = iterations;
+    execute(root);
+    wait(root);
+}
+
+/**
+* Measures the cost of running small tasks as jobs and as one std::thread per
+* task, and prints it
+* @param file File to print to, such as stdout
+* @param tasks Number of tasks of each measure
+*/
+void cgvJobSystem::benchmark(FILE* file, int tasks)
+{ typedef std::chrono::steady_clock clock;
+    std::atomic<long> sum{0};
+    auto task = [](cgvJob* job) { ((std::atomic<long>*) job->data)->fetch_add(1, std::memory_order_relaxed); };
+    auto elapsed_us = [](clock::time_point start)
+    { return std::chrono::duration<double, std::micro>(clock::now() - start).count();
+    };
+
+    // a thread per task, at most get_threads() at a time
+    clock::time_point start = clock::now();
+    for (int done = 0; done < tasks; )
+    { std::vector<std::thread> batch;
+        for (unsigned int i = 0; i < get_threads() && done < tasks; i++, done++)
+        { batch.emplace_back([&sum] { sum.fetch_add(1, std::memory_order_relaxed); });
+        }
+        for (std::thread& thread: batch)
+        { thread.join();
+        }
+    }
+    double thread_us = elapsed_us(start);
+
+    // a job per task, children of a job per batch so the slots are not all in use
+    start = clock::now();
+    for (int done = 0; done < tasks; )
+    { cgvJob* batch = create(nullptr);
+        for (int i = 0; i < CGV_JOB_CAPACITY / 2 && done < tasks; i++, done++)
+        { run(create(task, &sum, batch));
+        }
+        execute(batch);
+        wait(batch);
+    }
+    double job_us = elapsed_us(start);
+
+    // an iteration per task
+    start = clock::now();
+    parallel_for(tasks, 1, [&sum](int first, int last) { sum.fetch_add(last - first, std::memory_order_relaxed); });
+    double for_us = elapsed_us(start);
+
+    fprintf(file, "[jobs] %d tasks on %u threads: std::thread %.3f us/task, job %.3f us/task, "
+                  "parallel_for %.3f us/iteration%s\n", tasks, get_threads(), thread_us / tasks, job_us / tasks,
+            for_us / tasks, sum == 3L * tasks ? "" : " (WRONG RESULT)");
+}
+
+/**
+* Loop of the workers: runs jobs, and sleeps while there are none
+* @param index Worker of the thread
+*/
+void cgvJobSystem::work(unsigned int index)
+{ worker_index = (int) index;
+    for (;;)
+    { cgvJob* job = take();
+        if (job)
+        { execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        sleeping++;
+        wake.wait(lock, [this] { return stopping || pending > 0; });
+        sleeping--;
+        if (stopping)
+        { return;
+        }
+    }
+}
+
+/**
+* Takes a job to run: the newest one of the calling thread or, if it has none,
+* the oldest one of another worker
+* @return The job, or nullptr if all the queues are empty
+*/
+cgvJob* cgvJobSystem::take()
+{ for (unsigned int i = 0; i < count; i++)
+    { cgvJobWorker& worker = workers[(worker_index + i) % count];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.head != worker.tail)
+        { cgvJob* job;
+            if (i == 0)
+            { job = worker.queue[--worker.tail & (CGV_JOB_CAPACITY - 1)];
+            }
+            else
+            { job = worker.queue[worker.head++ & (CGV_JOB_CAPACITY - 1)];
+            }
+            pending--;
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+/**
+* Runs the function of a job and finishes it
+* @param job Job to run
+*/
+void cgvJobSystem::execute(cgvJob* job)
+{ if (job->function)
+    { job->function(job);
+    }
+    finish(job);
+}
+
+/**
+* Marks a job or one of its children as finished, and finishes its parent when
+* the last of its children finishes
+* @param job Job that has finished
+*/
+void cgvJobSystem::finish(cgvJob* job)
+{ cgvJob* parent = job->parent; // the slot can be reused once unfinished is 0
+    if (job->unfinished.fetch_sub(1) == 1 && parent)
+    { finish(parent);
+    }
+}
+
+/**
+* Function of the parallel_for jobs: splits off the second half of the range
+* as a new job while it is larger than the grain, and runs the rest
+* @param job Job with the range and the cgvParallelFor loop
+*/
+void cgvJobSystem::run_range(cgvJob* job)
+{ cgvParallelFor* loop = (cgvParallelFor*) job->data;
+    cgvJobSystem& jobs = getInstance();
+    int first = job->first;
+    int last = job->last;
+
+    while (last - first > loop->grain)
+    { int middle = first + (last - first) / 2;
+        cgvJob* half = jobs.create(run_range, loop, job);
+        half->first = middle;
+        half->last = last;
+        jobs.run(half);
+        last = middle;
+    }
+    (*loop->body)(first, last);
+}
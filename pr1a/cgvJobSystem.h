@@ -0,0 +1,94 @@
+#ifndef __CGVJOBSYSTEM
+#define __CGVJOBSYSTEM
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#define CGV_JOB_CAPACITY 4096 ///< Jobs each thread can have created and not finished (power of 2)
+
+/**
+ * Unit of work of the job system. A job is finished when its function has
+ * returned and all its children are finished
+ */
+struct cgvJob {
+    void (*function)(cgvJob* job) = nullptr; ///< Work of the job
+    void* data = nullptr; ///< Argument of the function
+    int first = 0, last = 0; ///< Range of iterations, for parallel_for
+    cgvJob* parent = nullptr; ///< Job that waits for this one, or nullptr
+    std::atomic<int> unfinished{0}; ///< The job itself plus its unfinished children
+};
+
+/**
+ * State of a thread of the job system: its queue and the jobs it creates. The
+ * queue only holds jobs of the thread that are not finished, so it fits in as
+ * many slots as there are jobs
+ */
+struct cgvJobWorker {
+    std::mutex mutex; ///< Protects the queue
+    cgvJob* queue[CGV_JOB_CAPACITY]; ///< Ring of the jobs to run: the owner takes the newest, thieves the oldest
+    unsigned int head = 0; ///< Jobs ever taken from the oldest end of the queue; the oldest is queue[head % capacity]
+    unsigned int tail = 0; ///< Jobs ever queued minus the ones taken from the newest end
+    cgvJob jobs[CGV_JOB_CAPACITY]; ///< Jobs created by the thread, reused in turn
+    unsigned int created = 0; ///< Jobs created by the thread
+};
+
+/**
+ * Work-stealing scheduler for the work done in each frame. Every thread has its
+ * own queue: it runs the newest of its jobs first, and when its queue is empty
+ * it steals the oldest job of another thread, which is usually the largest part
+ * of the work left. Jobs can have a parent, which is not finished until all of
+ * them are, and wait runs other jobs while it waits, so jobs can wait for their
+ * children. The thread that calls initialize is one of the workers; jobs can
+ * only be created from it and from the jobs themselves, and parallel_for runs
+ * serially on other threads. The number of threads
+ * can be set with the CGV_JOB_THREADS environment variable
+ */
+class cgvJobSystem {
+private:
+    std::unique_ptr<cgvJobWorker[]> workers; ///< Worker 0 is the thread that called initialize
+    std::vector<std::thread> threads; ///< Threads of the workers other than 0
+    unsigned int count = 1; ///< Number of workers
+
+    std::atomic<int> pending{0}; ///< Jobs in the queues
+    std::atomic<int> sleeping{0}; ///< Workers waiting for jobs
+    std::mutex sleep_mutex; ///< Protects the waits for jobs
+    std::condition_variable wake; ///< Wakes up the workers when there are jobs
+    bool stopping = false; ///< Whether the workers have to exit
+
+    // Implementing the Singleton pattern
+    static cgvJobSystem* _instance; ///< Pointer to the singleton object of the class
+    cgvJobSystem() = default;
+
+public:
+    static cgvJobSystem& getInstance();
+
+    /// Destructor
+    ~cgvJobSystem();
+
+    // Methods
+    void initialize(unsigned int threads = 0); // 0 = CGV_JOB_THREADS or the hardware threads
+    unsigned int get_threads();
+
+    cgvJob* create(void (*function)(cgvJob* job), void* data = nullptr, cgvJob* parent = nullptr);
+    void run(cgvJob* job); // queues the job on the thread that created it, which calls it
+    void wait(cgvJob* job); // runs jobs until job is finished
+
+    void parallel_for(int iterations, int grain, const std::function<void(int first, int last)>& body);
+
+    void benchmark(FILE* file, int tasks); // compares jobs with a std::thread per task
+
+private:
+    void work(unsigned int index);
+    cgvJob* take();
+    void execute(cgvJob* job);
+    void finish(cgvJob* job);
+    static void run_range(cgvJob* job);
+};
+
+#endif   // __CGVJOBSYSTEM
@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdio.h>
+
+#include "cgvLightClusters.h"
+
+#define CGV_CLUSTERS_PER_VIEW (CGV_CLUSTERS_X * CGV_CLUSTERS_Y * CGV_CLUSTERS_Z)
+
+// Texture buffers, in the order of the texture units they are bound to
+static const GLenum texture_formats[3] = { GL_RGBA32F, GL_RG32UI, GL_R32UI };
+static const char* sampler_names[3] = { "light_data", "cluster_ranges", "light_indices" };
+
+/**
+* Creates the uniform buffer and the texture buffers, and binds the uniform
+* buffer to CGV_CLUSTERS_BINDING. Must be called once the core entry points
+* are loaded
+*/
+void cgvLightClusters::initialize()
+{ glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &max_texels);
+
+    glGenBuffers(1, &grid_buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, grid_buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(cgvClusterGrid), &grid, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, CGV_CLUSTERS_BINDING, grid_buffer);
+
+    glGenBuffers(3, buffers);
+    glGenTextures(3, textures);
+    for (int i = 0; i < 3; i++)
+    { glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+        glBufferData(GL_TEXTURE_BUFFER, 4 * sizeof(GLfloat), nullptr, GL_STREAM_DRAW);
+        glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        glTexBuffer(GL_TEXTURE_BUFFER, texture_formats[i], buffers[i]);
+    }
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+/**
+* Sets the lights binned by the next update
+* @param _lights Lights, copied
+* @param count Number of lights; 0 removes them
+*/
+void cgvLightClusters::set_lights(const cgvPointLight* _lights, int count)
+{ if (count == (int) lights.size() && (count == 0 || memcmp(lights.data(), _lights, count * sizeof(cgvPointLight)) == 0))
+    { return;
+    }
+    lights.assign(_lights, _lights + count);
+    lights_changed = true;
+}
+
+/**
+* Method to query the number of lights
+* @return The lights set by set_lights
+*/
+int cgvLightClusters::get_lights()
+{ return (int) lights.size();
+}
+
+/**
+* Bins the lights into the clusters of the views the frame is drawn in, and
+* uploads the buffers, if the lights or the views have changed since they were
+* last binned; otherwise the buffers are kept
+* @param views Viewport, in the pixels drawn to, and camera of each view
+* @param count Number of views
+*/
+void cgvLightClusters::update(const cgvView* views, int count)
+{ bool views_changed = count != binned_count || memcmp(binned_views, views, count * sizeof(cgvView)) != 0;
+    if (!lights_changed && !views_changed)
+    { return;
+    }
+    binned_count = count;
+    std::copy(views, views + count, binned_views);
+
+    if (lights_changed)
+    { light_data.resize(lights.size() * 8);
+        for (size_t i = 0; i < lights.size(); i++)
+        { const cgvPointLight& light = lights[i];
+            GLfloat* data = &light_data[i * 8];
+            data[0] = light.position[0];
+            data[1] = light.position[1];
+            data[2] = light.position[2];
+            data[3] = light.radius;
+            data[4] = light.color[0];
+            data[5] = light.color[1];
+            data[6] = light.color[2];
+            data[7] = 0;
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[0]);
+        glBufferData(GL_TEXTURE_BUFFER, light_data.size() * sizeof(GLfloat), light_data.data(), GL_STATIC_DRAW);
+        lights_changed = false;
+    }
+
+    grid.size[0] = CGV_CLUSTERS_X;
+    grid.size[1] = CGV_CLUSTERS_Y;
+    grid.size[2] = CGV_CLUSTERS_Z;
+    grid.size[3] = (GLint) lights.size();
+    if (!lights.empty())
+    { ranges.assign(2 * CGV_CLUSTERS_PER_VIEW * count, 0);
+        indices.clear();
+        for (int i = 0; i < count; i++)
+        { bin(i, views[i]);
+        }
+
+        // the clusters past the largest texture buffer lose their lights
+        if ((GLint) indices.size() > max_texels)
+        { for (size_t cluster = 0; cluster < ranges.size(); cluster += 2)
+            { GLuint first = std::min(ranges[cluster], (GLuint) max_texels);
+                ranges[cluster + 1] = std::min(ranges[cluster + 1], (GLuint) max_texels - first);
+            }
+            indices.resize(max_texels);
+            if (!truncated)
+            { fprintf(stderr, "[lights] the clusters hold more than %d light indices; the rest are dropped\n",
+                        max_texels);
+                truncated = true;
+            }
+        }
+
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[1]);
+        glBufferData(GL_TEXTURE_BUFFER, ranges.size() * sizeof(GLuint), ranges.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[2]);
+        glBufferData(GL_TEXTURE_BUFFER, std::max(indices.size(), (size_t) 1) * sizeof(GLuint), indices.data(),
+                     GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, grid_buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(cgvClusterGrid), &grid);
+}
+
+/**
+* Binds the texture buffers to the texture units the shaders read them from,
+* from CGV_CLUSTER_TEXTURE_UNIT on
+*/
+void cgvLightClusters::bind()
+{ for (int i = 0; i < 3; i++)
+    { glActiveTexture(GL_TEXTURE0 + CGV_CLUSTER_TEXTURE_UNIT + i);
+        glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+/**
+* Points the Clusters uniform block of a program at CGV_CLUSTERS_BINDING, and
+* its light_data, cluster_ranges and light_indices samplers at the texture
+* units of the buffers
+* @param program Program that shades with the clusters
+*/
+void cgvLightClusters::set_bindings(GLuint program)
+{ GLuint block = glGetUniformBlockIndex(program, "Clusters");
+    if (block != GL_INVALID_INDEX)
+    { glUniformBlockBinding(program, block, CGV_CLUSTERS_BINDING);
+    }
+
+    glUseProgram(program);
+    for (int i = 0; i < 3; i++)
+    { glUniform1i(glGetUniformLocation(program, sampler_names[i]), CGV_CLUSTER_TEXTURE_UNIT + i);
+    }
+    glUseProgram(0);
+}
+
+/**
+* Bins the lights into the clusters of a view. The bounds of each light are the
+* box around its sphere, in view coordinates, cut to the depth range of the
+* view: its depth gives the slices it overlaps, and the projection of its
+* corners the tiles. The lights of the clusters are counted first, then each
+* cluster gets its range of the indices and they are written
+* @param view Index of the view
+* @param v Viewport and camera of the view
+*/
+void cgvLightClusters::bin(int view, const cgvView& v)
+{ const cgvMat4& projection = v.projection;
+    bool perspective = projection(3, 2) != 0;
+    GLfloat near_depth, far_depth;
+    if (perspective)
+    { near_depth = projection(2, 3) / (projection(2, 2) - 1);
+        far_depth = projection(2, 3) / (projection(2, 2) + 1);
+    }
+    else
+    { near_depth = (projection(2, 3) + 1) / projection(2, 2);
+        far_depth = (projection(2, 3) - 1) / projection(2, 2);
+    }
+    GLfloat log_ratio = perspective ? logf(far_depth / near_depth) : 0;
+
+    GLfloat* depth_range = grid.depth_ranges[view];
+    depth_range[0] = near_depth;
+    depth_range[1] = far_depth;
+    depth_range[2] = perspective ? 1.0f : 0.0f;
+    depth_range[3] = log_ratio;
+    GLfloat* viewport = grid.viewports[view];
+    viewport[0] = (GLfloat) v.x;
+    viewport[1] = (GLfloat) v.y;
+    viewport[2] = (GLfloat) v.width;
+    viewport[3] = (GLfloat) v.height;
+
+    // the same slices as the fragment shader
+    auto slice = [=](GLfloat depth)
+    { GLfloat s = perspective ? logf(depth / near_depth) / log_ratio : (depth - near_depth) / (far_depth - near_depth);
+        return std::min(std::max((int) floorf(s * CGV_CLUSTERS_Z), 0), CGV_CLUSTERS_Z - 1);
+    };
+    auto tile = [](GLfloat ndc, int tiles)
+    { return std::min(std::max((int) floorf((ndc + 1) * 0.5f * tiles), 0), tiles - 1);
+    };
+
+    GLuint* view_ranges = &ranges[2 * CGV_CLUSTERS_PER_VIEW * view];
+    bounds.resize(lights.size() * 6);
+    for (size_t i = 0; i < lights.size(); i++)
+    { GLint* b = &bounds[i * 6];
+        b[0] = 1; // no clusters unless it is in the frustum
+        b[1] = 0;
+
+        const cgvPointLight& light = lights[i];
+        cgvVec4 center = v.view * cgvVec4(light.position);
+        GLfloat r = light.radius;
+        GLfloat d0 = std::max(-center[2] - r, near_depth);
+        GLfloat d1 = std::min(-center[2] + r, far_depth);
+        if (!(near_depth < far_depth) || d0 > d1)
+        { continue;
+        }
+
+        GLfloat lo[2] = { 1, 1 }, hi[2] = { -1, -1 };
+        for (int corner = 0; corner < 8; corner++)
+        { cgvVec4 clip = projection * cgvVec4(center[0] + ((corner & 1) ? r : -r), center[1] + ((corner & 2) ? r : -r),
+                                                  (corner & 4) ? -d1 : -d0);
+            for (int axis = 0; axis < 2; axis++)
+            { GLfloat ndc = clip[axis] / clip[3];
+                lo[axis] = std::min(lo[axis], ndc);
+                hi[axis] = std::max(hi[axis], ndc);
+            }
+        }
+        if (hi[0] < -1 || lo[0] > 1 || hi[1] < -1 || lo[1] > 1)
+        { continue;
+        }
+
+        b[0] = tile(lo[0], CGV_CLUSTERS_X);
+        b[1] = tile(hi[0], CGV_CLUSTERS_X);
+        b[2] = tile(lo[1], CGV_CLUSTERS_Y);
+        b[3] = tile(hi[1], CGV_CLUSTERS_Y);
+        b[4] = slice(d0);
+        b[5] = slice(d1);
+        for (int z = b[4]; z <= b[5]; z++)
+        { for (int y = b[2]; y <= b[3]; y++)
+            { for (int x = b[0]; x <= b[1]; x++)
+                { view_ranges[2 * ((z * CGV_CLUSTERS_Y + y) * CGV_CLUSTERS_X + x) + 1]++;
+                }
+            }
+        }
+    }
+
+    GLuint first = (GLuint) indices.size();
+    for (int cluster = 0; cluster < CGV_CLUSTERS_PER_VIEW; cluster++)
+    { view_ranges[2 * cluster] = first;
+        first += view_ranges[2 * cluster + 1];
+        view_ranges[2 * cluster + 1] = 0;
+    }
+    indices.resize(first);
+
+    for (size_t i = 0; i < lights.size(); i++)
+    { const GLint* b = &bounds[i * 6];
+        for (int z = b[4]; b[0] <= b[1] && z <= b[5]; z++)
+        { for (int y = b[2]; y <= b[3]; y++)
+            { for (int x = b[0]; x <= b[1]; x++)
+                { GLuint* range = &view_ranges[2 * ((z * CGV_CLUSTERS_Y + y) * CGV_CLUSTERS_X + x)];
+                    indices[range[0] + range[1]++] = (GLuint) i;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,223 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdio.h>
+
+#include "cgvMetrics.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif   // !defined(_WIN32)
+
+// Singleton Pattern Application
+cgvMetrics* cgvMetrics::_instance = nullptr;
+
+static char segment_name[64] = ""; ///< Name of the segment, removed at exit
+
+// Current time, in ms
+static double now_ms()
+{ return std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Resident memory of the process, in bytes. Uses plain system calls so that
+// nothing is allocated in the render loop
+static uint64_t resident_memory()
+{
+#if defined(__linux__)
+    char buffer[128];
+    int fd = ::open("/proc/self/statm", O_RDONLY);
+    if (fd < 0)
+    { return 0;
+    }
+    ssize_t n = ::read(fd, buffer, sizeof(buffer) - 1);
+    ::close(fd);
+    if (n <= 0)
+    { return 0;
+    }
+    buffer[n] = '\0';
+
+    unsigned long size = 0, resident = 0;
+    sscanf(buffer, "%lu %lu", &size, &resident);
+    return (uint64_t) resident * sysconf(_SC_PAGESIZE);
+#elif !defined(_WIN32)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__) && defined(__MACH__)
+    return (uint64_t) usage.ru_maxrss; // peak, in bytes
+#else
+    return (uint64_t) usage.ru_maxrss * 1024; // peak, in KB
+#endif
+#else
+    return 0;
+#endif
+}
+
+// Removes the segment when the application exits
+static void remove_segment()
+{
+#if !defined(_WIN32)
+    shm_unlink(segment_name);
+#endif   // !defined(_WIN32)
+}
+
+/**
+* Method to access the class's singleton object, applying the Singleton
+* design pattern
+* @return A reference to the class's singleton object
+*/
+cgvMetrics& cgvMetrics::getInstance()
+{ if ( !_instance )
+    { _instance = new cgvMetrics;
+    }
+
+    return *_instance;
+}
+
+/**
+* Creates the shared-memory segment named by the CGV_METRICS_SHM environment
+* variable (for example /pr1a). Nothing is published if it is not defined
+* @param program Name of the program publishing the metrics
+* @post If the segment can be created, the metrics of each frame are published
+*/
+void cgvMetrics::open(const char* program)
+{
+#if !defined(_WIN32)
+    const char* name = getenv("CGV_METRICS_SHM");
+    if (!name || data)
+    { return;
+    }
+
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0 || ftruncate(fd, sizeof(cgvMetricsData)) < 0)
+    { perror("[metrics] shm_open");
+        if (fd >= 0)
+        { ::close(fd);
+        }
+        return;
+    }
+
+    void* segment = mmap(nullptr, sizeof(cgvMetricsData), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (segment == MAP_FAILED)
+    { perror("[metrics] mmap");
+        return;
+    }
+
+    data = (cgvMetricsData*) segment;
+    data->sequence.store(0, std::memory_order_relaxed);
+    data->values = values;
+    data->size = sizeof(cgvMetricsData);
+    data->pid = (uint32_t) getpid();
+    strncpy(data->program, program, sizeof(data->program) - 1);
+    data->program[sizeof(data->program) - 1] = '\0';
+    data->version = CGV_METRICS_VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    data->magic = CGV_METRICS_MAGIC; // written last: readers check it first
+
+    strncpy(segment_name, name, sizeof(segment_name) - 1);
+    atexit(remove_segment);
+    fprintf(stderr, "[metrics] publishing in shared memory segment %s\n", name);
+#endif   // !defined(_WIN32)
+}
+
+/**
+* Method to check whether the metrics are being published
+* @retval true If the shared-memory segment is open
+* @retval false Otherwise
+*/
+bool cgvMetrics::is_open()
+{ return data != nullptr;
+}
+
+/**
+* Sets the counters of the frame being drawn
+* @param draw_calls Draw calls issued
+* @param instances Objects drawn
+* @param culled_instances Objects discarded by culling
+*/
+void cgvMetrics::set_counts(uint64_t draw_calls, uint64_t instances, uint64_t culled_instances)
+{ values.draw_calls = draw_calls;
+    values.instances = instances;
+    values.culled_instances = culled_instances;
+}
+
+/**
+* Sets the resolution the frame being drawn was drawn at, and what the control
+* loop of the dynamic resolution decided after it
+* @param scale Fraction of the window resolution
+* @param target_ms Frame time the resolution is scaled to hold, 0 if it is not
+* @param step -1 if the scale was lowered, 1 if it was raised, 0 if it was kept
+*/
+void cgvMetrics::set_resolution(double scale, double target_ms, int step)
+{ values.resolution_scale = scale;
+    values.resolution_target_ms = target_ms;
+    values.resolution_step = step;
+}
+
+/**
+* Sets the counters of the shadow map of the point light
+* @param rebuilds Times the shadow map has been drawn
+* @param shadow_ms GPU time of the last one drawn, in ms
+*/
+void cgvMetrics::set_shadows(uint64_t rebuilds, double shadow_ms)
+{ values.shadow_rebuilds = rebuilds;
+    values.shadow_ms = shadow_ms;
+}
+
+/**
+* Closes the current frame and publishes its values. It never blocks: readers
+* detect a concurrent update through the seqlock and retry
+* @param frame_ms Time spent drawing the frame, in ms
+*/
+void cgvMetrics::end_frame(double frame_ms)
+{ values.frame++;
+    values.frame_ms = frame_ms;
+    values.frame_ms_avg = (values.frame == 1) ? frame_ms : 0.9 * values.frame_ms_avg + 0.1 * frame_ms;
+
+    if (!data)
+    { return;
+    }
+
+    double now = now_ms();
+    if (now - memory_time > 500)
+    { values.memory_bytes = resident_memory();
+        memory_time = now;
+    }
+
+    uint32_t sequence = data->sequence.load(std::memory_order_relaxed);
+    data->sequence.store(sequence + 1, std::memory_order_relaxed); // odd: update in progress
+    std::atomic_thread_fence(std::memory_order_release);
+    data->values = values;
+    data->sequence.store(sequence + 2, std::memory_order_release); // even: consistent
+}
+
+/**
+* Reads a consistent copy of the values published in a segment
+* @param segment Mapped segment
+* @param frame Returns the values of the last frame
+* @retval true If a consistent copy could be read
+* @retval false If the segment is not valid or the writer kept updating it
+*/
+bool cgvMetrics::read(const cgvMetricsData* segment, cgvMetricsFrame& frame)
+{ if (segment->magic != CGV_METRICS_MAGIC || segment->version != CGV_METRICS_VERSION)
+    { return false;
+    }
+
+    for (int attempt = 0; attempt < 1000; attempt++)
+    { uint32_t before = segment->sequence.load(std::memory_order_acquire);
+        if (before & 1)
+        { continue;
+        }
+
+        memcpy(&frame, (const void*) &segment->values, sizeof(frame));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (segment->sequence.load(std::memory_order_relaxed) == before)
+        { return true;
+        }
+    }
+    return false;
+}
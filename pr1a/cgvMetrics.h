@@ -0,0 +1,77 @@
+#ifndef __CGVMETRICS
+#define __CGVMETRICS
+
+#include <atomic>
+#include <cstdint>
+
+#define CGV_METRICS_MAGIC 0x4d564743u ///< "CGVM", identifies a metrics segment
+#define CGV_METRICS_VERSION 3 ///< Layout version of cgvMetricsData
+
+/**
+ * Values published for each frame
+ */
+struct cgvMetricsFrame {
+    uint64_t frame; ///< Number of frames drawn
+    double frame_ms; ///< Time spent in the last display callback, swap included
+    double frame_ms_avg; ///< Exponential moving average of frame_ms
+    uint64_t draw_calls; ///< Draw calls issued in the last frame
+    uint64_t instances; ///< Objects drawn in the last frame
+    uint64_t culled_instances; ///< Objects discarded by culling in the last frame
+    uint64_t memory_bytes; ///< Resident memory of the process
+    double resolution_scale; ///< Fraction of the window resolution the last frame was drawn at
+    double resolution_target_ms; ///< Frame time the resolution is scaled to hold, 0 if it is not scaled
+    int32_t resolution_step; ///< Decision of the control loop after the last frame: -1 lower, 0 hold, 1 raise
+    uint64_t shadow_rebuilds; ///< Times the shadow map has been drawn
+    double shadow_ms; ///< GPU time of the last shadow map drawn
+};
+
+/**
+ * Layout of the shared-memory segment. The frame values are protected by a
+ * seqlock: the writer makes sequence odd while it updates them, and readers
+ * retry until they read the same even sequence before and after copying them
+ */
+struct cgvMetricsData {
+    uint32_t magic; ///< CGV_METRICS_MAGIC
+    uint32_t version; ///< CGV_METRICS_VERSION
+    uint32_t size; ///< sizeof(cgvMetricsData) of the writer
+    uint32_t pid; ///< Process publishing the metrics
+    char program[16]; ///< Name of the program publishing the metrics
+    std::atomic<uint32_t> sequence; ///< Seqlock counter
+    cgvMetricsFrame values; ///< Values of the last frame
+};
+
+/**
+ * Objects of this class publish the live metrics of the application in a POSIX
+ * shared-memory segment, so that an external monitor (cgvMetricsMonitor) can
+ * read them without stopping or slowing down the render loop
+ */
+class cgvMetrics {
+private:
+    cgvMetricsData* data = nullptr; ///< Mapped segment, nullptr if metrics are not published
+    cgvMetricsFrame values = {}; ///< Values of the frame being drawn
+    double memory_time = 0; ///< Last time the resident memory was read, in ms
+
+    // Implementing the Singleton pattern
+    static cgvMetrics* _instance; ///< Pointer to the singleton object of the class
+    cgvMetrics() = default;
+
+public:
+    static cgvMetrics& getInstance();
+
+    /// Destructor
+    ~cgvMetrics() = default;
+
+    // Methods
+    void open(const char* program);
+    bool is_open();
+
+    void set_counts(uint64_t draw_calls, uint64_t instances, uint64_t culled_instances);
+    void set_resolution(double scale, double target_ms, int step);
+    void set_shadows(uint64_t rebuilds, double shadow_ms);
+    void end_frame(double frame_ms);
+
+    // Reader side, used by the monitor
+    static bool read(const cgvMetricsData* segment, cgvMetricsFrame& frame);
+};
+
+#endif   // __CGVMETRICS
@@ -0,0 +1,117 @@
+#include <cstdlib>
+#include <stdio.h>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "cgvMetrics.h"
+
+/**
+* Prints the usage of the monitor
+* @param program Name of the executable
+*/
+static void usage(const char* program)
+{ fprintf(stderr, "Usage: %s [-i interval_ms] [-n samples] [-o log.csv] segment\n"
+                    "Reads the live metrics published by pr1a/pr2b with CGV_METRICS_SHM=segment\n",
+            program);
+}
+
+int main (int argc, char** argv)
+{ int interval_ms = 1000; // time between samples
+    long samples = 0; // number of samples to take, 0 = until the writer exits
+    const char* log_path = nullptr; // CSV file to append the samples to
+
+    int option;
+    while ((option = getopt(argc, argv, "i:n:o:h")) != -1)
+    { switch (option)
+        { case 'i': interval_ms = atoi(optarg); break;
+            case 'n': samples = atol(optarg); break;
+            case 'o': log_path = optarg; break;
+            default: usage(argv[0]); return(1);
+        }
+    }
+    if (optind != argc - 1 || interval_ms <= 0)
+    { usage(argv[0]);
+        return(1);
+    }
+
+    int fd = shm_open(argv[optind], O_RDONLY, 0);
+    if (fd < 0)
+    { perror(argv[optind]);
+        return(1);
+    }
+    void* segment = mmap(nullptr, sizeof(cgvMetricsData), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (segment == MAP_FAILED)
+    { perror("mmap");
+        return(1);
+    }
+    const cgvMetricsData* data = (const cgvMetricsData*) segment;
+
+    if (data->magic != CGV_METRICS_MAGIC || data->version != CGV_METRICS_VERSION)
+    { fprintf(stderr, "%s: not a metrics segment of version %d\n", argv[optind], CGV_METRICS_VERSION);
+        return(1);
+    }
+    printf("%s (pid %u)\n", data->program, data->pid);
+
+    FILE* log = nullptr;
+    if (log_path)
+    { log = fopen(log_path, "a");
+        if (!log)
+        { perror(log_path);
+            return(1);
+        }
+        fprintf(log, "frame,frame_ms,frame_ms_avg,draw_calls,instances,culled_instances,memory_bytes,"
+                     "resolution_scale,resolution_target_ms,resolution_step,shadow_rebuilds,shadow_ms\n");
+    }
+
+    for (long n = 0; !samples || n < samples; n++)
+    { if (n)
+        { usleep(interval_ms * 1000);
+        }
+
+        // the writer removes the segment when it exits
+        if (kill((pid_t) data->pid, 0) != 0)
+        { printf("%s exited\n", data->program);
+            break;
+        }
+
+        cgvMetricsFrame frame;
+        if (!cgvMetrics::read(data, frame))
+        { continue;
+        }
+
+        printf("frame %llu: %.3f ms (avg %.3f ms), %llu draw calls, %llu instances, %llu culled, %.1f MB",
+               (unsigned long long) frame.frame, frame.frame_ms, frame.frame_ms_avg,
+               (unsigned long long) frame.draw_calls, (unsigned long long) frame.instances,
+               (unsigned long long) frame.culled_instances, frame.memory_bytes / (1024.0 * 1024.0));
+        if (frame.resolution_target_ms > 0)
+        { const char* steps[] = { "lowered", "held", "raised" };
+            printf(", resolution %.2f for %.3f ms (%s)", frame.resolution_scale, frame.resolution_target_ms,
+                   steps[frame.resolution_step + 1]);
+        }
+        if (frame.shadow_rebuilds > 0)
+        { printf(", %llu shadow maps (last %.3f ms)", (unsigned long long) frame.shadow_rebuilds, frame.shadow_ms);
+        }
+        printf("\n");
+        fflush(stdout);
+
+        if (log)
+        { fprintf(log, "%llu,%.3f,%.3f,%llu,%llu,%llu,%llu,%.3f,%.3f,%d,%llu,%.3f\n",
+                    (unsigned long long) frame.frame, frame.frame_ms, frame.frame_ms_avg,
+                    (unsigned long long) frame.draw_calls, (unsigned long long) frame.instances,
+                    (unsigned long long) frame.culled_instances, (unsigned long long) frame.memory_bytes,
+                    frame.resolution_scale, frame.resolution_target_ms, (int) frame.resolution_step,
+                    (unsigned long long) frame.shadow_rebuilds, frame.shadow_ms);
+            fflush(log);
+        }
+    }
+
+    if (log)
+    { fclose(log);
+    }
+    munmap(segment, sizeof(cgvMetricsData));
+    return(0);
+}
@@ -0,0 +1,651 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdio.h>
+
+#include "cgvRenderer.h"
+#include "cgvImmediateRenderer.h"
+#include "cgvDisplayListRenderer.h"
+#include "cgvCoreRenderer.h"
+#include "cgvSoftwareRenderer.h"
+#include "cgvRenderTarget.h"
+
+// Unit cube centered at the origin, as glutSolidCube(1): position and normal of each vertex
+static const GLfloat cube[36][6] = {
+    { 0.5f, -0.5f, -0.5f, 1, 0, 0 }, { 0.5f, 0.5f, -0.5f, 1, 0, 0 }, { 0.5f, 0.5f, 0.5f, 1, 0, 0 },
+    { 0.5f, -0.5f, -0.5f, 1, 0, 0 }, { 0.5f, 0.5f, 0.5f, 1, 0, 0 }, { 0.5f, -0.5f, 0.5f, 1, 0, 0 },
+    { -0.5f, -0.5f, 0.5f, -1, 0, 0 }, { -0.5f, 0.5f, 0.5f, -1, 0, 0 }, { -0.5f, 0.5f, -0.5f, -1, 0, 0 },
+    { -0.5f, -0.5f, 0.5f, -1, 0, 0 }, { -0.5f, 0.5f, -0.5f, -1, 0, 0 }, { -0.5f, -0.5f, -0.5f, -1, 0, 0 },
+    { -0.5f, 0.5f, -0.5f, 0, 1, 0 }, { -0.5f, 0.5f, 0.5f, 0, 1, 0 }, { 0.5f, 0.5f, 0.5f, 0, 1, 0 },
+    { -0.5f, 0.5f, -0.5f, 0, 1, 0 }, { 0.5f, 0.5f, 0.5f, 0, 1, 0 }, { 0.5f, 0.5f, -0.5f, 0, 1, 0 },
+    { -0.5f, -0.5f, 0.5f, 0, -1, 0 }, { -0.5f, -0.5f, -0.5f, 0, -1, 0 }, { 0.5f, -0.5f, -0.5f, 0, -1, 0 },
+    { -0.5f, -0.5f, 0.5f, 0, -1, 0 }, { 0.5f, -0.5f, -0.5f, 0, -1, 0 }, { 0.5f, -0.5f, 0.5f, 0, -1, 0 },
+    { -0.5f, -0.5f, 0.5f, 0, 0, 1 }, { 0.5f, -0.5f, 0.5f, 0, 0, 1 }, { 0.5f, 0.5f, 0.5f, 0, 0, 1 },
+    { -0.5f, -0.5f, 0.5f, 0, 0, 1 }, { 0.5f, 0.5f, 0.5f, 0, 0, 1 }, { -0.5f, 0.5f, 0.5f, 0, 0, 1 },
+    { 0.5f, -0.5f, -0.5f, 0, 0, -1 }, { -0.5f, -0.5f, -0.5f, 0, 0, -1 }, { -0.5f, 0.5f, -0.5f, 0, 0, -1 },
+    { 0.5f, -0.5f, -0.5f, 0, 0, -1 }, { -0.5f, 0.5f, -0.5f, 0, 0, -1 }, { 0.5f, 0.5f, -0.5f, 0, 0, -1 }
+};
+
+// Bounding sphere of each unit mesh: center and radius, in model coordinates
+static const GLfloat mesh_bounds[CGV_MESHES][4] = {
+    { 0, 0, 0, 0.8660254f }, // cube: half its diagonal
+    { 0, 0, 0, 1 }, // sphere
+    { 0, 0, 0.5f, 1.1180340f }, // cone: from the middle of its axis to the rim of its base
+    { 0, 0, 0.5f, 1.1180340f }, // cylinder: from the middle of its axis to the rims
+    { 0, 0, 0, 1 } // axes
+};
+
+// Appends a vertex to a mesh
+static void add_vertex(std::vector<cgvVertex>& v, GLfloat x, GLfloat y, GLfloat z,
+                       GLfloat nx, GLfloat ny, GLfloat nz)
+{ v.push_back({ { x, y, z }, { nx, ny, nz }, { 0, 0, 0, 0 } });
+}
+
+// Appends the two triangles of a quad given by its corners in order
+static void add_quad(std::vector<cgvVertex>& v, const cgvVertex& a, const cgvVertex& b,
+                     const cgvVertex& c, const cgvVertex& d)
+{ v.push_back(a); v.push_back(b); v.push_back(c);
+    v.push_back(a); v.push_back(c); v.push_back(d);
+}
+
+// Sines and cosines of the angles 0, step, 2 * step, ..., count * step, computed in one batch
+static void sample_angles(GLfloat step, int count, std::vector<GLfloat>& sines, std::vector<GLfloat>& cosines)
+{ std::vector<GLfloat> angles(count + 1);
+    for (int i = 0; i <= count; i++)
+    { angles[i] = step * i;
+    }
+    sines.resize(count + 1);
+    cosines.resize(count + 1);
+    cgv_sincos(angles.data(), sines.data(), cosines.data(), count + 1);
+}
+
+// Sphere of radius 1, with the tessellation of glutSolidSphere(1, slices, stacks)
+static void build_sphere(std::vector<cgvVertex>& v, int slices, int stacks)
+{ std::vector<GLfloat> sin_theta, cos_theta, sin_phi, cos_phi;
+    sample_angles((GLfloat) M_PI / stacks, stacks, sin_theta, cos_theta);
+    sample_angles(2 * (GLfloat) M_PI / slices, slices, sin_phi, cos_phi);
+
+    for (int i = 0; i < stacks; i++)
+    { for (int j = 0; j < slices; j++)
+        { cgvVertex corner[4];
+            int theta[4] = { i, i + 1, i + 1, i };
+            int phi[4] = { j, j, j + 1, j + 1 };
+            for (int k = 0; k < 4; k++)
+            { GLfloat x = cos_phi[phi[k]] * sin_theta[theta[k]], y = sin_phi[phi[k]] * sin_theta[theta[k]];
+                GLfloat z = cos_theta[theta[k]];
+                corner[k] = { { x, y, z }, { x, y, z }, { 0, 0, 0, 0 } };
+            }
+            add_quad(v, corner[0], corner[1], corner[2], corner[3]);
+        }
+    }
+}
+
+// Cone with base radius 1 on z = 0 and apex on z = 1, with the tessellation of
+// glutSolidCone(1, 1, slices, stacks)
+static void build_cone(std::vector<cgvVertex>& v, int slices, int stacks)
+{ GLfloat side = 1 / sqrtf(2); // components of the normal of the side, which is at 45 degrees
+    std::vector<GLfloat> sin_phi, cos_phi;
+    sample_angles(2 * (GLfloat) M_PI / slices, slices, sin_phi, cos_phi);
+
+    for (int j = 0; j < slices; j++)
+    { // base
+        add_vertex(v, 0, 0, 0, 0, 0, -1);
+        add_vertex(v, cos_phi[j + 1], sin_phi[j + 1], 0, 0, 0, -1);
+        add_vertex(v, cos_phi[j], sin_phi[j], 0, 0, 0, -1);
+
+        // side
+        for (int i = 0; i < stacks; i++)
+        { GLfloat z0 = (GLfloat) i / stacks, z1 = (GLfloat) (i + 1) / stacks;
+            cgvVertex a = { { (1 - z0) * cos_phi[j], (1 - z0) * sin_phi[j], z0 }, { side * cos_phi[j], side * sin_phi[j], side }, { 0, 0, 0, 0 } };
+            cgvVertex b = { { (1 - z0) * cos_phi[j + 1], (1 - z0) * sin_phi[j + 1], z0 }, { side * cos_phi[j + 1], side * sin_phi[j + 1], side }, { 0, 0, 0, 0 } };
+            cgvVertex c = { { (1 - z1) * cos_phi[j + 1], (1 - z1) * sin_phi[j + 1], z1 }, { side * cos_phi[j + 1], side * sin_phi[j + 1], side }, { 0, 0, 0, 0 } };
+            cgvVertex d = { { (1 - z1) * cos_phi[j], (1 - z1) * sin_phi[j], z1 }, { side * cos_phi[j], side * sin_phi[j], side }, { 0, 0, 0, 0 } };
+            add_quad(v, a, b, c, d);
+        }
+    }
+}
+
+// Open tube of radius 1 from z = 0 to z = 1, with the tessellation of
+// gluCylinder(quadric, 1, 1, 1, slices, stacks)
+static void build_cylinder(std::vector<cgvVertex>& v, int slices, int stacks)
+{ std::vector<GLfloat> sin_a, cos_a;
+    sample_angles(2 * (GLfloat) M_PI / slices, slices, sin_a, cos_a);
+
+    for (int j = 0; j < slices; j++)
+    { for (int i = 0; i < stacks; i++)
+        { GLfloat z0 = (GLfloat) i / stacks, z1 = (GLfloat) (i + 1) / stacks;
+            cgvVertex a = { { sin_a[j], cos_a[j], z0 }, { sin_a[j], cos_a[j], 0 }, { 0, 0, 0, 0 } };
+            cgvVertex b = { { sin_a[j], cos_a[j], z1 }, { sin_a[j], cos_a[j], 0 }, { 0, 0, 0, 0 } };
+            cgvVertex c = { { sin_a[j + 1], cos_a[j + 1], z1 }, { sin_a[j + 1], cos_a[j + 1], 0 }, { 0, 0, 0, 0 } };
+            cgvVertex d = { { sin_a[j + 1], cos_a[j + 1], z0 }, { sin_a[j + 1], cos_a[j + 1], 0 }, { 0, 0, 0, 0 } };
+            add_quad(v, a, b, c, d);
+        }
+    }
+}
+
+// Coordinate axes; their own colors replace the material color
+static void build_axes(std::vector<cgvVertex>& v)
+{ v.push_back({ { 1, 0, 0 }, { 0, 0, 1 }, { 1, 0, 0, 1 } });
+    v.push_back({ { -1, 0, 0 }, { 0, 0, 1 }, { 1, 0, 0, 1 } });
+    v.push_back({ { 0, 1, 0 }, { 0, 0, 1 }, { 0, 1, 0, 1 } });
+    v.push_back({ { 0, -1, 0 }, { 0, 0, 1 }, { 0, 1, 0, 1 } });
+    v.push_back({ { 0, 0, 1 }, { 0, 0, 1 }, { 0, 0, 1, 1 } });
+    v.push_back({ { 0, 0, -1 }, { 0, 0, 1 }, { 0, 0, 1, 1 } });
+}
+
+/**
+* Creates a renderer backend
+* @param name Name of the backend: immediate, lists, core or software
+* @return The new renderer, or nullptr if there is no backend with that name
+*/
+cgvRenderer* cgvRenderer::create(const char* name)
+{ if (strcmp(name, "immediate") == 0)
+    { return new cgvImmediateRenderer;
+    }
+    if (strcmp(name, "lists") == 0)
+    { return new cgvDisplayListRenderer;
+    }
+    if (strcmp(name, "core") == 0)
+    { return new cgvCoreRenderer;
+    }
+    if (strcmp(name, "software") == 0)
+    { return new cgvSoftwareRenderer;
+    }
+    return nullptr;
+}
+
+/**
+* Constructor that reads CGV_CULLING: "off" draws every mesh in every view
+*/
+cgvRenderer::cgvRenderer()
+{ const char* mode = getenv("CGV_CULLING");
+    culling = !(mode && strcmp(mode, "off") == 0);
+}
+
+/**
+* Destructor. The framebuffer of the offscreen target is left to the context,
+* which may be gone
+*/
+cgvRenderer::~cgvRenderer()
+{ delete target;
+}
+
+/**
+* Method to query the names of the backends, for the usage messages
+* @return The names accepted by create
+*/
+const char* cgvRenderer::get_names()
+{ return "immediate, lists, core, software";
+}
+
+/**
+* Method to check whether the backend needs an OpenGL 3.3 core-profile context
+* @retval true If it does; the context must be requested before creating the window
+* @retval false If it draws with the default (compatibility) context
+*/
+bool cgvRenderer::requires_core_profile()
+{ return false;
+}
+
+/**
+* Method to check whether the backend draws through an OpenGL window
+* @retval true If it does; it cannot be used with --headless
+* @retval false If it draws to memory and can run without a window
+*/
+bool cgvRenderer::requires_window()
+{ return true;
+}
+
+/**
+* Sets the region of the window the next frames are drawn to. It is scaled by
+* the resolution scale before it reaches the backend
+* @param x Left edge, in window pixels
+* @param y Bottom edge, in window pixels
+* @param width Width, in window pixels
+* @param height Height, in window pixels
+*/
+void cgvRenderer::set_viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{ GLint* rect = window_rects[0];
+    rect[0] = x;
+    rect[1] = y;
+    rect[2] = width;
+    rect[3] = height;
+    scale_views();
+    update_target();
+    apply_viewport(views[0].x, views[0].y, views[0].width, views[0].height);
+}
+
+/**
+* Sets the region the next frames are drawn to, as glViewport, in the pixels
+* drawn to: the window's, or the offscreen target's while the resolution is
+* scaled
+*/
+void cgvRenderer::apply_viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{ glViewport(x, y, width, height);
+}
+
+/**
+* Sets the color the window is cleared to, as glClearColor, and keeps it so the
+* backends do not have to read it back from OpenGL
+*/
+void cgvRenderer::set_clear_color(GLfloat r, GLfloat g, GLfloat b)
+{ clear_value[0] = r;
+    clear_value[1] = g;
+    clear_value[2] = b;
+    clear_value[3] = 0;
+    glClearColor(r, g, b, 0);
+}
+
+/**
+* Clears the color and the depth of the whole window
+*/
+void cgvRenderer::clear()
+{ glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+/**
+* Shows the frame drawn since the last clear in the window. A frame drawn at a
+* lower resolution is stretched over the window first
+*/
+void cgvRenderer::present()
+{ if (target && resolution_scale < 1)
+    { target->blit(target_width, target_height, frame_width, frame_height);
+    }
+    glutSwapBuffers(); // used instead of glFlush() to prevent flickering
+}
+
+/**
+* Saves the last frame to a binary PPM file
+* @param path Path of the file
+* @retval false The backend keeps its frames in the GPU; use the software backend
+*/
+bool cgvRenderer::save_frame(const char* /*path*/)
+{ return false;
+}
+
+/**
+* Sets the camera of the view the frames are drawn in when there is one, and
+* the frustum the meshes are culled against. Each backend calls it from its own
+* set_camera
+* @param projection Projection matrix, column-major
+* @param view View matrix, column-major
+*/
+void cgvRenderer::set_camera(const cgvMat4& projection, const cgvMat4& view)
+{ views[0].projection = projection;
+    views[0].view = view;
+    set_frustum(projection * view, frusta[0]);
+}
+
+/**
+* Sets the views the next frames are drawn in. With one view it is the same as
+* set_viewport and set_camera; with more, such as the four views of a split
+* window, the scene is submitted once and the meshes are drawn in every view,
+* and the backends that can draw them all at once do
+* @param _views Viewport and camera of each view, with the viewports in window
+* pixels; they are scaled by the resolution scale
+* @param count Number of views, from 1 to CGV_MAX_VIEWS
+*/
+void cgvRenderer::set_views(const cgvView* _views, int count)
+{ view_count = count;
+    for (int i = 0; i < count; i++)
+    { views[i] = _views[i];
+    }
+    if (count == 1)
+    { set_viewport(views[0].x, views[0].y, views[0].width, views[0].height);
+        set_camera(views[0].projection, views[0].view);
+        return;
+    }
+
+    for (int i = 0; i < count; i++)
+    { GLint* rect = window_rects[i];
+        rect[0] = views[i].x;
+        rect[1] = views[i].y;
+        rect[2] = views[i].width;
+        rect[3] = views[i].height;
+        set_frustum(views[i].projection * views[i].view, frusta[i]);
+    }
+    scale_views();
+    update_target();
+}
+
+/**
+* Sets the fraction of the window resolution the next frames are drawn at. The
+* viewports set so far are scaled again, and the backends that draw with
+* OpenGL draw to an offscreen target while it is below 1; present stretches the
+* frame over the window. If the context cannot draw offscreen, the frames stay
+* at the full resolution
+* @param scale Fraction of the window width and height, from
+* CGV_MIN_RESOLUTION_SCALE to 1
+*/
+void cgvRenderer::set_resolution_scale(GLfloat scale)
+{ scale = std::min(std::max(scale, CGV_MIN_RESOLUTION_SCALE), 1.0f);
+    if (scale == resolution_scale)
+    { return;
+    }
+
+    resolution_scale = scale;
+    scale_views();
+    if (!update_target())
+    { fprintf(stderr, "[renderer] the %s renderer cannot draw offscreen: the frames stay at full resolution\n",
+                get_name());
+        resolution_scale = 1;
+        scale_views();
+        update_target();
+    }
+    if (view_count == 1)
+    { apply_viewport(views[0].x, views[0].y, views[0].width, views[0].height);
+    }
+}
+
+/**
+* Method to query the fraction of the window resolution the frames are drawn at
+* @return The scale of the width and height, 1 at full resolution
+*/
+GLfloat cgvRenderer::get_resolution_scale()
+{ return resolution_scale;
+}
+
+/**
+* Makes the frames go to the pixels drawn to, after their size changes: to the
+* offscreen target while the resolution is scaled, and to the window otherwise.
+* The backends that do not draw with OpenGL replace it
+* @retval true If the frames go where the resolution scale asks
+* @retval false If the context cannot draw offscreen
+*/
+bool cgvRenderer::update_target()
+{ if (resolution_scale < 1)
+    { if (!target)
+        { target = new cgvRenderTarget;
+        }
+        return target_width == 0 || target_height == 0 || target->bind(target_width, target_height);
+    }
+    if (target)
+    { cgvRenderTarget::unbind();
+    }
+    return true;
+}
+
+/**
+* Method to query the framebuffer the frames go to, as update_target left it,
+* so the backends that bind others can go back to it without querying OpenGL
+* @return The framebuffer of the offscreen target while the resolution is
+* scaled, 0 for the window
+*/
+GLuint cgvRenderer::get_target_framebuffer()
+{ return (target && resolution_scale < 1) ? target->get_framebuffer() : 0;
+}
+
+/**
+* Computes the viewports of the views, in the pixels drawn to, from the ones in
+* window pixels, and the window pixels they cover. The edges are scaled and
+* rounded, so views that share an edge in the window still share it
+*/
+void cgvRenderer::scale_views()
+{ frame_width = frame_height = 0;
+    for (int i = 0; i < view_count; i++)
+    { const GLint* rect = window_rects[i];
+        frame_width = std::max(frame_width, rect[0] + rect[2]);
+        frame_height = std::max(frame_height, rect[1] + rect[3]);
+        GLint left = (GLint) lroundf(rect[0] * resolution_scale);
+        GLint bottom = (GLint) lroundf(rect[1] * resolution_scale);
+        views[i].x = left;
+        views[i].y = bottom;
+        views[i].width = (GLsizei) lroundf((rect[0] + rect[2]) * resolution_scale) - left;
+        views[i].height = (GLsizei) lroundf((rect[1] + rect[3]) * resolution_scale) - bottom;
+    }
+    target_width = (GLsizei) lroundf(frame_width * resolution_scale);
+    target_height = (GLsizei) lroundf(frame_height * resolution_scale);
+}
+
+/**
+* Sets any number of local point lights for the next frames, besides the point
+* light of set_light; only the backends that shade per fragment draw them. By
+* default the backend only lights the meshes per vertex with the point light,
+* as the fixed-function pipeline does: the lights are reported once and ignored
+* @param lights Lights, copied by the backends that draw them
+* @param count Number of lights; 0 removes them
+*/
+void cgvRenderer::set_local_lights(const cgvPointLight* /*lights*/, int count)
+{ static bool reported = false;
+    if (count > 0 && !reported)
+    { fprintf(stderr, "[renderer] the %s renderer does not draw local lights; they are drawn by the core renderer\n",
+                get_name());
+        reported = true;
+    }
+}
+
+/**
+* Turns the shadows of the point light on or off. The backends that draw them
+* keep a shadow map, only drawn again when the light moves or after
+* invalidate_shadows. By default the backend does not draw them: they are
+* reported once and ignored
+* @param enabled Whether the lit meshes are shadowed
+*/
+void cgvRenderer::set_shadows(bool enabled)
+{ static bool reported = false;
+    if (enabled && !reported)
+    { fprintf(stderr, "[renderer] the %s renderer does not draw shadows; they are drawn by the core renderer\n",
+                get_name());
+        reported = true;
+    }
+}
+
+/**
+* Tells the backend that the meshes submitted from the next frame on are not
+* the ones of the shadow map. Does nothing in the backends without shadows
+*/
+void cgvRenderer::invalidate_shadows()
+{
+}
+
+/**
+* Turns on or off the outlines of the filled meshes, drawn over the frame after
+* the meshes by a post-process whose cost does not grow with the meshes. Takes
+* effect from the next clear
+* @param enabled Whether the meshes are outlined
+* @param color Color of the outlines
+* @retval true If the backend draws the outlines as asked
+* @retval false If they are asked for and the backend does not draw them, as by
+* default: the scene has to draw its own, such as the meshes again as wireframes
+*/
+bool cgvRenderer::set_outlines(bool enabled, const GLfloat /*color*/[3])
+{ return !enabled;
+}
+
+/**
+* Submits a copy of a mesh in each cell of a grid. By default each cell is
+* submitted on its own, in the order of the cells; the backends that cull on
+* the GPU replace it
+* @param mesh Mesh to draw
+* @param material Appearance of all the copies
+* @param transform Modeling matrix of the copy in the cell (0, 0, 0)
+* @param grid Cells of the grid and distance between them
+*/
+void cgvRenderer::submit_grid(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& transform,
+                              const cgvGrid& grid)
+{ int cells = grid.cells[0] * grid.cells[1] * grid.cells[2];
+    for (int cell = 0; cell < cells; cell++)
+    { submit(mesh, material, get_cell_transform(grid, transform, cell));
+    }
+}
+
+/**
+* Method to check whether the backend culls and draws the grids of submit_grid
+* without visiting their cells on the CPU, so scenes can submit large regular
+* layouts as grids
+* @retval true If the cost of submit_grid does not depend on its cells
+* @retval false If the cells are submitted one by one
+*/
+bool cgvRenderer::culls_grids()
+{ return false;
+}
+
+/**
+* Method to query the per-instance data uploaded to the GPU by the last frame
+* @return The bytes uploaded; 0 for the backends that do not stream it
+*/
+unsigned long cgvRenderer::get_streamed_bytes()
+{ return 0;
+}
+
+/**
+* Method to query the times the CPU has waited for the GPU to finish reading
+* the per-instance data of a previous frame, to write the data of a new one
+* @return The number of waits; 0 for the backends that do not stream it
+*/
+unsigned long cgvRenderer::get_stream_waits()
+{ return 0;
+}
+
+/**
+* Method to query the meshes culled by the last frame
+* @return The meshes skipped between the last begin_frame and end_frame, counted
+* once per view they were skipped in
+*/
+unsigned long cgvRenderer::get_culled_instances()
+{ return culled_instances;
+}
+
+/**
+* Method to query the times the shadow map has been drawn
+* @return The rebuilds since the renderer was created; 0 without shadows
+*/
+unsigned long cgvRenderer::get_shadow_rebuilds()
+{ return shadow_rebuilds;
+}
+
+/**
+* Method to query the GPU time of the last shadow map drawn. It is measured
+* with a timer query, read once its result is available, a few frames later
+* @return The time, in ms; 0 until the first one is measured
+*/
+double cgvRenderer::get_shadow_ms()
+{ return shadow_ms;
+}
+
+/**
+* Computes the bounding sphere of a submitted mesh. The radius is scaled by
+* the largest scale of the transform, so the sphere holds the mesh for any
+* transform
+* @param mesh Mesh submitted
+* @param transform Modeling matrix of the mesh
+* @return The bounding sphere, in world coordinates
+*/
+cgvBounds cgvRenderer::get_bounds(cgvMesh mesh, const cgvMat4& transform)
+{ const GLfloat* local = mesh_bounds[mesh];
+    cgvVec4 center = transform * cgvVec4(local[0], local[1], local[2]);
+    GLfloat scale = std::max(std::max(length(transform.column(0).xyz()), length(transform.column(1).xyz())),
+                             length(transform.column(2).xyz()));
+    return { center.xyz(), local[3] * scale };
+}
+
+/**
+* Computes the modeling matrix of the copy of a mesh in a cell of a grid
+* @param grid Cells of the grid and distance between them
+* @param transform Modeling matrix of the copy in the cell (0, 0, 0)
+* @param cell Number of the cell: by Y layer, then X row, then Z
+* @return The transform moved to the cell
+*/
+cgvMat4 cgvRenderer::get_cell_transform(const cgvGrid& grid, const cgvMat4& transform, int cell)
+{ int y = cell / (grid.cells[0] * grid.cells[2]);
+    int x = cell / grid.cells[2] % grid.cells[0];
+    int z = cell % grid.cells[2];
+    return cgvMat4::translation(x * grid.spacing[0], y * grid.spacing[1], z * grid.spacing[2]) * transform;
+}
+
+/**
+* Tests a bounding sphere against the frusta of all the views the frame is
+* drawn in, once per submitted mesh; each view then only draws the meshes whose
+* bit is set. The views it is outside of are counted as culled. CGV_CULLING=off
+* draws every mesh in every view
+* @param bounds Bounding sphere of a mesh, in world coordinates
+* @return The views it may be visible in; all of them if culling is off
+*/
+cgvViewMask cgvRenderer::cull(const cgvBounds& bounds)
+{ cgvViewMask all = (1u << view_count) - 1;
+    if (!culling)
+    { return all;
+    }
+
+    cgvVec4 center(bounds.center);
+    cgvViewMask visible = 0;
+    for (int i = 0; i < view_count; i++)
+    { bool inside = true;
+        for (int plane = 0; plane < 6 && inside; plane++)
+        { inside = dot(frusta[i][plane], center) >= -bounds.radius;
+        }
+        if (inside)
+        { visible |= 1u << i;
+        }
+        else
+        { culled_instances++;
+        }
+    }
+    return visible;
+}
+
+/**
+* Extracts the planes of a view frustum from its projection times view matrix:
+* a point is inside if it is on the positive side of the six of them. The planes
+* are normalized, so they give the distance to the point
+* @param view_projection Projection times view matrix
+* @param planes Returns the left, right, bottom, top, near and far planes
+*/
+void cgvRenderer::set_frustum(const cgvMat4& view_projection, cgvVec4 planes[6])
+{ for (int axis = 0; axis < 3; axis++)
+    { for (int side = 0; side < 2; side++)
+        { cgvVec4& plane = planes[axis * 2 + side];
+            GLfloat sign = side ? -1.0f : 1.0f;
+            for (int c = 0; c < 4; c++)
+            { plane[c] = view_projection(3, c) + sign * view_projection(axis, c);
+            }
+            GLfloat l = length(plane.xyz());
+            plane = (l > 0) ? plane * (1 / l) : plane;
+        }
+    }
+}
+
+/**
+* Appends the vertices of a unit mesh, as drawn by GLUT and GLU, for the backends
+* that draw their own triangles
+* @param mesh Mesh to tessellate
+* @param vertices Returns the vertices appended, three per triangle or two per line
+* @return GL_TRIANGLES, or GL_LINES for the axes
+*/
+GLenum cgvRenderer::tessellate(cgvMesh mesh, std::vector<cgvVertex>& vertices)
+{ switch (mesh)
+    { case CGV_MESH_CUBE:
+            for (int i = 0; i < 36; i++)
+            { add_vertex(vertices, cube[i][0], cube[i][1], cube[i][2], cube[i][3], cube[i][4], cube[i][5]);
+            }
+            break;
+        case CGV_MESH_SPHERE:
+            build_sphere(vertices, 32, 32);
+            break;
+        case CGV_MESH_CONE:
+            build_cone(vertices, 32, 32);
+            break;
+        case CGV_MESH_CYLINDER:
+            build_cylinder(vertices, CGV_CYLINDER_SLICES, CGV_CYLINDER_STACKS);
+            break;
+        case CGV_MESH_AXES:
+            build_axes(vertices);
+            return GL_LINES;
+        default:
+            break;
+    }
+    return GL_TRIANGLES;
+}
+
+/**
+* Appends the triangles of an open tube of radius 1 from z = 0 to z = 1, with
+* the tessellation of gluCylinder(quadric, 1, 1, 1, slices, stacks). Other radii
+* and lengths are given by the transform the tube is drawn with
+* @param slices Subdivisions around the axis
+* @param stacks Subdivisions along the axis
+* @param vertices Returns the vertices appended, three per triangle
+*/
+void cgvRenderer::tessellate_cylinder(int slices, int stacks, std::vector<cgvVertex>& vertices)
+{ build_cylinder(vertices, slices, stacks);
+}
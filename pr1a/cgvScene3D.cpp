@@ -1,164 +1,574 @@
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <stdio.h>
 
 #include "cgvScene3D.h"
 
 /**
-* Method for painting the coordinate axes by calling OpenGL functions
+* Method for recording the coordinate axes in a command list
+* @param list List to record the axes in
 */
-void cgvScene3D::paint_axes ()
+void cgvScene3D::paint_axes (cgvCommandList& list)
 {
-    GLfloat red[] = { 1,0,0,1.0 };
-    GLfloat green[] = { 0,1,0,1.0 };
-    GLfloat blue[] = { 0,0,1,1.0 };
-
-    glBegin(GL_LINES);
-    glMaterialfv(GL_FRONT, GL_EMISSION, red);
-    glVertex3f(1000, 0, 0);
-    glVertex3f(-1000, 0, 0);
-
-    glMaterialfv(GL_FRONT, GL_EMISSION, green);
-    glVertex3f(0, 1000, 0);
-    glVertex3f(0, -1000, 0);
-
-    glMaterialfv(GL_FRONT, GL_EMISSION, blue);
-    glVertex3f(0, 0, 1000);
-    glVertex3f(0, 0, -1000);
-    glEnd();
+    cgvMaterial axes_material = { { 0, 0, 0 }, true, GL_FILL, 1 };
+    cgvMat4 transform = cgvMat4::scaling(1000, 1000, 1000);
+    list.submit(CGV_MESH_AXES, axes_material, transform);
 }
 
-void cgvScene3D::shoeBox() {
-    GLfloat part_color[] = { 0,0.25,0 };
-    GLfloat part_color2[] = { 0,0.3,0 };
-
-    glMaterialfv(GL_FRONT, GL_EMISSION, part_color);
-
-    glPushMatrix();
-    glScalef(1, 1, 2);
-    glutSolidCube(1);
-    glPopMatrix();
+/**
+* Records a shoe box in a command list. Does not change the scene, so it can be
+* called from several threads with different lists
+* @param list List to record the box in
+* @param x X coordinate of the position of the box
+* @param y Y coordinate of the position of the box
+* @param z Z coordinate of the position of the box
+*/
+void cgvScene3D::record_shoe_box(cgvCommandList& list, GLfloat x, GLfloat y, GLfloat z) {
+    cgvMaterial material;
+    cgvMat4 transform;
+    for (int part = 0; part < CGV_SHOE_BOX_PARTS; part++) {
+        get_shoe_box_part(part, x, y, z, material, transform);
+        list.submit(CGV_MESH_CUBE, material, transform);
+    }
+}
 
-    glMaterialfv(GL_FRONT, GL_EMISSION, part_color2);
-    glPushMatrix();
-    glTranslatef(0, 0.4, 0);
-    glScalef(1.1, 0.2, 2.1);
-    glutSolidCube(1);
-    glPopMatrix();
+/**
+* Gives the material and the transform of a part of a shoe box: the box itself,
+* and then its lid
+* @param part Part of the box, from 0 to CGV_SHOE_BOX_PARTS - 1
+* @param x X coordinate of the position of the box
+* @param y Y coordinate of the position of the box
+* @param z Z coordinate of the position of the box
+* @param material Returns the material of the part
+* @param transform Returns the modeling matrix of the cube of the part
+*/
+void cgvScene3D::get_shoe_box_part(int part, GLfloat x, GLfloat y, GLfloat z, cgvMaterial& material,
+                                   cgvMat4& transform) {
+    if (part == 0) {
+        material = { { 0, 0.25, 0 }, true, GL_FILL, 1 };
+        transform = cgvMat4::translation(x, y, z).scale(1, 1, 2);
+    }
+    else {
+        material = { { 0, 0.3, 0 }, true, GL_FILL, 1 };
+        transform = cgvMat4::translation(x, y + 0.4, z).scale(1.1, 0.2, 2.1);
+    }
 }
 
+/**
+* Methods to change the number of stacks along each axis. The commands are
+* recorded again by the next call to display
+*/
 void cgvScene3D::incrStacksX() {
     nStacksX++;
+    recorded_scene = 0;
 };
 
 void cgvScene3D::decrStacksX() {
-    if (nStacksX > 1)
+    if (nStacksX > 1) {
         nStacksX--;
+        recorded_scene = 0;
+    }
 };
 
 void cgvScene3D::incrStacksY() {
     nStacksY++;
+    recorded_scene = 0;
 };
 
 void cgvScene3D::decrStacksY() {
-    if (nStacksY > 1)
+    if (nStacksY > 1) {
         nStacksY--;
+        recorded_scene = 0;
+    }
 };
 
 void cgvScene3D::incrStacksZ() {
     nStacksZ++;
+    recorded_scene = 0;
 };
 
 void cgvScene3D::decrStacksZ() {
-    if (nStacksZ > 1)
+    if (nStacksZ > 1) {
         nStacksZ--;
+        recorded_scene = 0;
+    }
 };
 
 /**
-* Method with OpenGL calls to display the scene
+* Method to display the scene by submitting it to the renderer. The scene is
+* only traversed when it has changed since the last call; otherwise the
+* recorded commands are replayed
 * @param scene Identifier of the scene type to draw
-* @pre Assumes the parameter value is correct
+* @pre Assumes the parameter value is correct and the renderer has been set
 */
 void cgvScene3D::display(int scene)
 {
+    if (scene != recorded_scene)
+    { record(scene, commands);
+    }
+    display(commands, animated && scene == SceneC, shadows, outlines);
+}
+
+/**
+* Method to display commands recorded for the scene, such as a snapshot made by
+* another thread. Only uses the renderer, so it does not read the state of the
+* scene
+* @param list Commands to replay
+* @param animate Whether the shoe boxes are moved to where the animation has
+* them now
+* @param shadowed Whether the point light casts shadows. The shadow map is only
+* drawn again when the commands hold another version of the geometry, or on
+* every frame while the boxes move
+* @param outlined Whether the filled meshes are outlined: in a post-process by
+* the renderers that do it, with the meshes drawn again as wireframes by the
+* others
+* @pre The renderer has been set
+*/
+void cgvScene3D::display(const cgvCommandList& list, bool animate, bool shadowed, bool outlined)
+{
+    static const GLfloat outline_color[3] = { 0, 0, 0 };
+    bool wireframes = !renderer->set_outlines(outlined, outline_color); // drawn to from the clear on
+
     // clear the window and Z-buffer
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    renderer->clear();
 
     // Lights
-    GLfloat light0[] = { 10, 8, 9, 1 }; // point light source
-    glLightfv(GL_LIGHT0, GL_POSITION, light0);
-    glEnable(GL_LIGHT0);
+    renderer->set_light(cgvVec4(10, 8, 9, 1)); // point light source
+    renderer->set_local_lights(list.get_lights().data(), (int) list.get_lights().size());
+    renderer->set_shadows(shadowed);
+    if (animate || list.get_version() != displayed_version)
+    { renderer->invalidate_shadows();
+        displayed_version = list.get_version();
+    }
+
+    renderer->begin_frame();
+    std::chrono::duration<float> time = std::chrono::steady_clock::now() - animation_start;
+    if (animate)
+    { replay_animated(list, time.count());
+    }
+    else
+    { list.replay(renderer);
+    }
+    if (wireframes)
+    { replay_wireframes(list, animate, time.count());
+    }
+    draw_calls = renderer->end_frame();
+}
+
+/**
+* Replays commands with every shoe box moved as the animation has it at a
+* time: it bobs up and down, sways around its vertical axis and its color
+* pulses, each box out of phase with the next one. The two parts of a box are
+* drawn one after the other, so the box of a draw is half the number of parts
+* drawn before it; the grids of parts are submitted cell by cell, and the box
+* of a cell is its number. The axes do not move
+* @param list Commands to replay
+* @param time Time since the animation started, in seconds
+*/
+void cgvScene3D::replay_animated(const cgvCommandList& list, float time)
+{
+    const cgvMaterial* material = nullptr;
+    const cgvMat4* transform = nullptr;
+    unsigned long part = 0;
 
-    glPushMatrix(); // save the modeling matrix
+    for (const cgvCommand& command: list.get_commands())
+    { switch (command.type)
+        { case CGV_CMD_SET_MATERIAL:
+                material = &list.get_material(command.index);
+                break;
+            case CGV_CMD_SET_TRANSFORM:
+                transform = &list.get_transform(command.index);
+                break;
+            case CGV_CMD_DRAW_MESH:
+                if (command.index == CGV_MESH_AXES)
+                { renderer->submit(CGV_MESH_AXES, *material, *transform);
+                }
+                else
+                { submit_animated((cgvMesh) command.index, *material, *transform, part / CGV_SHOE_BOX_PARTS, time);
+                    part++;
+                }
+                break;
+            case CGV_CMD_DRAW_GRID:
+            { const cgvGridDraw& grid = list.get_grid(command.index);
+                int cells = grid.grid.cells[0] * grid.grid.cells[1] * grid.grid.cells[2];
+                for (int cell = 0; cell < cells; cell++)
+                { submit_animated(grid.mesh, *material, cgvRenderer::get_cell_transform(grid.grid, *transform, cell),
+                                    cell, time);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+/**
+* Submits a part of a shoe box where the animation has it at a time
+* @param mesh Mesh of the part
+* @param material Material of the part when it is not animated
+* @param model Modeling matrix of the part when it is not animated
+* @param box Number of the box, which puts it out of phase with the others
+* @param time Time since the animation started, in seconds
+*/
+void cgvScene3D::submit_animated(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& model, unsigned long box,
+                                 float time)
+{ float phase = time + box * 0.37f;
+    cgvMaterial pulsed = material;
+    pulsed.color[0] += 0.1f * (1 + sinf(phase));
+    pulsed.color[1] += 0.1f * (1 + cosf(phase));
+    renderer->submit(mesh, pulsed, get_animated_transform(model, box, time));
+}
+
+/**
+* Gives the modeling matrix of a part of a shoe box where the animation has it
+* at a time: it bobs up and down and sways around the vertical axis through
+* its position
+* @param model Modeling matrix of the part when it is not animated
+* @param box Number of the box, which puts it out of phase with the others
+* @param time Time since the animation started, in seconds
+* @return The modeling matrix of the part
+*/
+cgvMat4 cgvScene3D::get_animated_transform(const cgvMat4& model, unsigned long box, float time)
+{ float phase = time + box * 0.37f;
+    return cgvMat4::translation(model(0, 3), model(1, 3) + 0.15f * sinf(2 * phase), model(2, 3))
+           * cgvMat4::rotation(10 * sinf(3 * phase), 0, 1, 0)
+           * cgvMat4::translation(-model(0, 3), -model(1, 3), -model(2, 3))
+           * model;
+}
+
+/**
+* Submits the filled meshes of commands again as black wireframes, where the
+* animation has them if it runs, as the outlines of the renderers that do not
+* draw them in a post-process. The axes and the meshes already drawn as lines
+* are left out
+* @param list Commands to replay
+* @param animate Whether the shoe boxes are moved to where the animation has them
+* @param time Time since the animation started, in seconds
+*/
+void cgvScene3D::replay_wireframes(const cgvCommandList& list, bool animate, float time)
+{
+    static const cgvMaterial wireframe = { { 0, 0, 0 }, false, GL_LINE, 1 };
+    const cgvMaterial* material = nullptr;
+    const cgvMat4* transform = nullptr;
+    unsigned long part = 0;
+
+    for (const cgvCommand& command: list.get_commands())
+    { switch (command.type)
+        { case CGV_CMD_SET_MATERIAL:
+                material = &list.get_material(command.index);
+                break;
+            case CGV_CMD_SET_TRANSFORM:
+                transform = &list.get_transform(command.index);
+                break;
+            case CGV_CMD_DRAW_MESH:
+                if (command.index == CGV_MESH_AXES)
+                { break;
+                }
+                if (material->polygon_mode == GL_FILL)
+                { renderer->submit((cgvMesh) command.index, wireframe,
+                                     animate ? get_animated_transform(*transform, part / CGV_SHOE_BOX_PARTS, time)
+                                             : *transform);
+                }
+                part++;
+                break;
+            case CGV_CMD_DRAW_GRID:
+            { const cgvGridDraw& grid = list.get_grid(command.index);
+                if (material->polygon_mode != GL_FILL)
+                { break;
+                }
+                if (!animate)
+                { renderer->submit_grid(grid.mesh, wireframe, *transform, grid.grid);
+                    break;
+                }
+                int cells = grid.grid.cells[0] * grid.grid.cells[1] * grid.grid.cells[2];
+                for (int cell = 0; cell < cells; cell++)
+                { renderer->submit(grid.mesh, wireframe,
+                                     get_animated_transform(cgvRenderer::get_cell_transform(grid.grid, *transform, cell),
+                                                            cell, time));
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+/**
+* Traverses a scene and records its draws in a command list, tagged with the
+* version of the geometry of the scene
+* @param scene Identifier of the scene type to record
+* @param list List to record the scene in; its commands are replaced
+*/
+void cgvScene3D::record(int scene, cgvCommandList& list)
+{
+    list.clear();
+    instances = 0;
+    if (scene != recorded_scene)
+    { geometry_version++; // the scene, or what it is made of, has changed
+    }
+    list.set_version(geometry_version);
 
     // paint the axes
     if(axes)
-    { paint_axes();
+    { paint_axes(list);
     }
 
     // Scene selected via the menu (right-click)
     if(scene == SceneA)
-    { renderSceneA();
+    { renderSceneA(list);
     }
     else
     { if ( scene == SceneB )
-        { renderSceneB();
+        { renderSceneB(list);
         }
         else
         { if ( scene == SceneC )
-            { renderSceneC();
+            { renderSceneC(list);
             }
         }
     }
 
-    glPopMatrix(); // restores the modeling matrix
-    glutSwapBuffers(); // used instead of glFlush() to prevent flickering
+    recorded_scene = scene;
+    recordings++;
 }
+
 /**
-* Renders scene A by calling OpenGL functions
+* Records a scene in a snapshot, with the state it was recorded from
+* @param scene Identifier of the scene type to record
+* @param snapshot Snapshot to fill
 */
-void cgvScene3D::renderSceneA()
+void cgvScene3D::record(int scene, cgvSceneSnapshot& snapshot)
 {
-    shoeBox();
+    record(scene, snapshot.commands);
+    snapshot.scene = scene;
+    snapshot.axes = axes;
+    snapshot.animated = animated && scene == SceneC;
+    snapshot.shadows = shadows;
+    snapshot.outlines = outlines;
+    snapshot.nStacksX = nStacksX;
+    snapshot.nStacksY = nStacksY;
+    snapshot.nStacksZ = nStacksZ;
+    snapshot.instances = instances;
+    snapshot.recordings = recordings;
 }
 
 /**
-* Paints scene B by calling OpenGL functions
+* Records scene A
+* @param list List to record the scene in
 */
-void cgvScene3D::renderSceneB ()
+void cgvScene3D::renderSceneA(cgvCommandList& list)
 {
-    GLfloat piece_color[] = { 0, 0, 0.5 };
+    record_shoe_box(list, 0, 0, 0);
+    instances++;
+}
 
-    glMaterialfv(GL_FRONT, GL_EMISSION, piece_color);
+/**
+* Records scene B
+* @param list List to record the scene in
+*/
+void cgvScene3D::renderSceneB (cgvCommandList& list)
+{
     for (int yStack = 0; yStack < nStacksY; yStack++) {
-        glPushMatrix();
-        glTranslatef(0, yStack, 0);
-        shoeBox();
-        glPopMatrix();
+        record_shoe_box(list, 0, yStack, 0);
+        instances++;
     }
 }
 
 /**
-* Paints scene C by calling OpenGL functions
+* Records scene C. Large grids are split into ranges of shoe boxes, in the order
+* of the traversal (Y layers, then X rows, then Z), that are recorded by the jobs
+* of a cgvJobSystem::parallel_for in lists of their own; the lists are then
+* appended in the order of the ranges, so the commands are the same as recording
+* the grid on one thread. If the renderer culls grids on the GPU, the boxes are
+* recorded as a grid per part instead, which takes the same commands for any
+* number of boxes. The lights over the aisles are recorded last
+* @param list List to record the scene in
 */
-void cgvScene3D::renderSceneC ()
+void cgvScene3D::renderSceneC (cgvCommandList& list)
 {
-    GLfloat part_color[] = { 0,0,0.5 };
-    GLfloat xSeparation = 1.5;
-    GLfloat zSeparation = 2.5;
-
-    glMaterialfv(GL_FRONT, GL_EMISSION, part_color);
-    for (int yStacks = 0; yStacks < nStacksY; yStacks++) {
-        for (int xStacks = 0; xStacks < nStacksX; xStacks++) {
-            for (int zStacks = 0; zStacks < nStacksZ; zStacks++) {
-                glPushMatrix();
-                glTranslatef(xStacks * xSeparation, yStacks, zStacks * zSeparation);
-                shoeBox();
-                glPopMatrix();
-            }
+    int boxes = nStacksX * nStacksY * nStacksZ;
+    cgvJobSystem& jobs = cgvJobSystem::getInstance();
+
+    if (renderer && renderer->culls_grids())
+    { record_grids(list);
+    }
+    else if (boxes < CGV_RECORD_MIN_BOXES || jobs.get_threads() == 1)
+    { record_boxes(list, 0, boxes);
+    }
+    else
+    { // several ranges per thread, so the threads finish at about the same time
+        int ranges = std::min(boxes, (int) jobs.get_threads() * 4);
+        if ((int) range_commands.size() < ranges)
+        { range_commands.resize(ranges);
+        }
+        jobs.parallel_for(ranges, 1, [this, boxes, ranges](int first, int last)
+                          { for (int range = first; range < last; range++)
+                              { range_commands[range].clear();
+                                  record_boxes(range_commands[range], (int) ((long long) boxes * range / ranges),
+                                               (int) ((long long) boxes * (range + 1) / ranges));
+                              }
+                          });
+
+        for (int range = 0; range < ranges; range++)
+        { list.append(range_commands[range]);
+        }
+    }
+
+    if (aisle_lights)
+    { record_aisle_lights(list);
+    }
+
+    instances += boxes;
+}
+
+/**
+* Records a range of the shoe boxes of scene C in a command list. Boxes are
+* numbered in the order of the traversal: by Y layer, then X row, then Z
+* @param list List to record the boxes in
+* @param first First box of the range
+* @param last Box after the last one of the range
+*/
+void cgvScene3D::record_boxes(cgvCommandList& list, int first, int last)
+{
+    for (int box = first; box < last; box++) {
+        int yStacks = box / (nStacksX * nStacksZ);
+        int xStacks = box / nStacksZ % nStacksX;
+        int zStacks = box % nStacksZ;
+        record_shoe_box(list, xStacks * CGV_STACK_SEPARATION_X, yStacks, zStacks * CGV_STACK_SEPARATION_Z);
+    }
+}
+
+/**
+* Records the shoe boxes of scene C as a grid for each part of the boxes. The
+* cells of the grids are numbered as the boxes of record_boxes
+* @param list List to record the grids in
+*/
+void cgvScene3D::record_grids(cgvCommandList& list)
+{
+    cgvGrid grid = { { nStacksX, nStacksY, nStacksZ }, { CGV_STACK_SEPARATION_X, 1, CGV_STACK_SEPARATION_Z } };
+    cgvMaterial material;
+    cgvMat4 transform;
+    for (int part = 0; part < CGV_SHOE_BOX_PARTS; part++) {
+        get_shoe_box_part(part, 0, 0, 0, material, transform);
+        list.submit_grid(CGV_MESH_CUBE, material, transform, grid);
+    }
+}
+
+/**
+* Method to check whether the point light casts shadows
+* @retval true If the scene is drawn with shadows
+* @retval false If it is only lit
+*/
+bool cgvScene3D::get_shadows()
+{ return shadows;
+}
+
+/**
+* Method to turn the shadows of the point light on or off. The commands do not
+* change: the renderer draws the shadows
+* @param _shadows Whether the point light casts shadows
+*/
+void cgvScene3D::set_shadows(bool _shadows)
+{ shadows = _shadows;
+}
+
+/**
+* Method to check whether the shoe boxes are outlined
+* @retval true If the filled meshes are outlined
+* @retval false Otherwise
+*/
+bool cgvScene3D::get_outlines()
+{ return outlines;
+}
+
+/**
+* Method to turn the outlines of the shoe boxes on or off. They are drawn by
+* the renderer over the whole frame, instead of a second pass with the boxes as
+* wireframes, so the commands do not change
+* @param _outlines Whether the filled meshes are outlined
+*/
+void cgvScene3D::set_outlines(bool _outlines)
+{ outlines = _outlines;
+}
+
+/**
+* Records a light over each aisle of scene C: along every row of stacks along
+* Z, one between each pair of stacks and one past each end of the row, just
+* above the top layer
+* @param list List to record the lights in
+*/
+void cgvScene3D::record_aisle_lights(cgvCommandList& list)
+{
+    for (int zStacks = 0; zStacks < nStacksZ; zStacks++) {
+        for (int aisle = -1; aisle < nStacksX; aisle++) {
+            cgvPointLight light = { cgvVec3((aisle + 0.5f) * CGV_STACK_SEPARATION_X, nStacksY + 0.5f,
+                                            zStacks * CGV_STACK_SEPARATION_Z),
+                                    CGV_AISLE_LIGHT_RADIUS, { 0.5f, 0.45f, 0.3f } };
+            list.add_light(light);
         }
     }
 }
 
+/**
+* Methods to query the number of stacks along each axis
+* @return The number of stacks
+*/
+int cgvScene3D::get_stacksX()
+{ return nStacksX;
+}
+
+int cgvScene3D::get_stacksY()
+{ return nStacksY;
+}
+
+int cgvScene3D::get_stacksZ()
+{ return nStacksZ;
+}
+
+/**
+* Method to set the renderer the scene is submitted to
+* @param _renderer Renderer to use
+* @pre The renderer has been initialized
+*/
+void cgvScene3D::set_renderer(cgvRenderer* _renderer)
+{ renderer = _renderer;
+}
+
+/**
+* Method to query the draw calls issued by the last call to display
+* @return The number of draw calls
+*/
+unsigned long cgvScene3D::get_draw_calls()
+{ return draw_calls;
+}
+
+/**
+* Method to query the shoe boxes drawn by the last call to display
+* @return The number of shoe boxes
+*/
+unsigned long cgvScene3D::get_instances()
+{ return instances;
+}
+
+/**
+* Method to access the commands replayed by display, for debugging
+* @return The commands recorded for the last scene displayed
+*/
+const cgvCommandList& cgvScene3D::get_commands()
+{ return commands;
+}
+
+/**
+* Method to query the times the scene has been traversed to record the commands
+* @return The number of recordings
+*/
+unsigned long cgvScene3D::get_recordings()
+{ return recordings;
+}
+
 /**
 * Method to check whether the axes should be drawn or not
 * @retval true If the axes should be drawn
@@ -175,9 +585,51 @@ bool cgvScene3D::get_axes()
 * according to the value passed as a parameter
 */
 void cgvScene3D::set_axes(bool _axes )
-{ axes = _axes;
+{ if ( axes != _axes )
+    { axes = _axes;
+        recorded_scene = 0; // the axes are part of the recorded commands
+    }
 }
 
 
 
 
+
+/**
+* Method to check whether the shoe boxes of scene C move
+* @retval true If they are animated
+* @retval false If they stand still
+*/
+bool cgvScene3D::get_animated()
+{ return animated;
+}
+
+/**
+* Method to start or stop the animation of the shoe boxes of scene C. The
+* commands do not change: the boxes are moved when they are replayed
+* @param _animated Whether the boxes move
+*/
+void cgvScene3D::set_animated(bool _animated)
+{ animated = _animated;
+}
+
+/**
+* Method to check whether scene C has a light over each aisle
+* @retval true If the aisles are lit
+* @retval false If the scene only has the point light
+*/
+bool cgvScene3D::get_aisle_lights()
+{ return aisle_lights;
+}
+
+/**
+* Method to add or remove the lights over the aisles of scene C. The commands
+* are recorded again by the next call to display
+* @param _aisle_lights Whether the aisles are lit
+*/
+void cgvScene3D::set_aisle_lights(bool _aisle_lights)
+{ if ( aisle_lights != _aisle_lights )
+    { aisle_lights = _aisle_lights;
+        recorded_scene = 0; // the lights are recorded with the commands
+    }
+}
@@ -11,6 +11,36 @@
 
 #endif   // defined(__APPLE__) && defined(__MACH__)
 
+#include <chrono>
+
+#include "cgvCommandList.h"
+#include "cgvGLStats.h"
+#include "cgvRenderer.h"
+#include "cgvJobSystem.h"
+
+#define CGV_RECORD_MIN_BOXES 4096 ///< Shoe boxes from which scene C is recorded on several threads
+#define CGV_SHOE_BOX_PARTS 2 ///< Cubes a shoe box is made of
+#define CGV_STACK_SEPARATION_X 1.5f ///< Distance between the stacks of scene C along X
+#define CGV_STACK_SEPARATION_Z 2.5f ///< Distance between the stacks of scene C along Z
+#define CGV_AISLE_LIGHT_RADIUS 3.0f ///< Reach of the lights over the aisles of scene C
+
+/**
+* State of the scene at a point in time, with the commands recorded from it, so
+* it can be drawn by a thread other than the one that changes the scene
+*/
+struct cgvSceneSnapshot {
+    cgvCommandList commands; ///< Draws of the scene
+    int scene = 0; ///< Scene recorded; 0 if none
+    bool axes = false; ///< Whether the axes are drawn
+    bool animated = false; ///< Whether the shoe boxes move when drawn
+    bool shadows = false; ///< Whether the point light casts shadows
+    bool outlines = false; ///< Whether the shoe boxes are outlined
+    int nStacksX = 0, nStacksY = 0, nStacksZ = 0; ///< Number of stacks along each axis
+    unsigned long instances = 0; ///< Shoe boxes recorded
+    unsigned long recordings = 0; ///< Times the scene had been recorded, this one included
+    unsigned long events = 0; ///< Input events applied before recording it
+};
+
 /**
 * Objects of this class represent 3D scenes for display
 */
@@ -26,10 +56,28 @@ public:
 private:
     // Attributes
     bool axes = true; ///< Indicates whether or not to draw the coordinate axes
+    bool animated = false; ///< Whether the shoe boxes of scene C move
+    bool aisle_lights = false; ///< Whether scene C has a light over each aisle
+    bool shadows = false; ///< Whether the point light casts shadows
+    bool outlines = false; ///< Whether the shoe boxes are outlined
+    std::chrono::steady_clock::time_point animation_start = std::chrono::steady_clock::now(); ///< Time 0 of the animation
     int nStacksX=1;
     int nStacksY=1;
     int nStacksZ=1;
 
+    unsigned long draw_calls = 0; ///< Draw calls issued by the last call to display
+    unsigned long instances = 0; ///< Shoe boxes drawn by the last call to display
+
+    cgvCommandList commands; ///< Draws of the scene, replayed by display while it does not change
+    int recorded_scene = 0; ///< Scene the commands were recorded for; 0 if they have to be recorded again
+    unsigned long geometry_version = 0; ///< Version of the meshes of the scene, changed when they are recorded again
+    unsigned long displayed_version = 0; ///< Version of the commands displayed last, drawn into the shadow map
+    unsigned long recordings = 0; ///< Times the scene has been traversed to record the commands
+
+    std::vector<cgvCommandList> range_commands; ///< Commands of each range of shoe boxes recorded in parallel
+
+    cgvRenderer* renderer = nullptr; ///< Renderer the scene is submitted to
+
 public:
     // Default constructors and destructor
     /// Default constructor
@@ -39,14 +87,33 @@ public:
     ~cgvScene3D() = default;
 
     // Methods
-    // Method with OpenGL calls to display the scene
+    // Method to display the scene with the renderer
     void display(int scene);
+    void display(const cgvCommandList& list, bool animate = false, bool shadowed = false,
+                 bool outlined = false); // replays recorded commands
+
+    void record(int scene, cgvCommandList& list); // traverses the scene
+    void record(int scene, cgvSceneSnapshot& snapshot);
 
     bool get_axes();
 
     void set_axes(bool _axes);
 
-    void shoeBox();
+    bool get_animated();
+
+    void set_animated(bool _animated);
+
+    bool get_aisle_lights();
+
+    void set_aisle_lights(bool _aisle_lights);
+
+    bool get_shadows();
+
+    void set_shadows(bool _shadows);
+
+    bool get_outlines();
+
+    void set_outlines(bool _outlines);
 
     void incrStacksX();
 
@@ -60,14 +127,48 @@ public:
 
     void decrStacksZ();
 
+    int get_stacksX();
+
+    int get_stacksY();
+
+    int get_stacksZ();
+
+    void set_renderer(cgvRenderer* _renderer);
+
+    unsigned long get_draw_calls();
+
+    unsigned long get_instances();
+
+    const cgvCommandList& get_commands();
+
+    unsigned long get_recordings();
+
 private:
-    void renderSceneA();
+    void renderSceneA(cgvCommandList& list);
+
+    void renderSceneB(cgvCommandList& list);
+
+    void renderSceneC(cgvCommandList& list);
+
+    void paint_axes(cgvCommandList& list);
+
+    void record_boxes(cgvCommandList& list, int first, int last);
+
+    void record_grids(cgvCommandList& list);
+
+    void record_aisle_lights(cgvCommandList& list);
+
+    static void record_shoe_box(cgvCommandList& list, GLfloat x, GLfloat y, GLfloat z);
+
+    static void get_shoe_box_part(int part, GLfloat x, GLfloat y, GLfloat z, cgvMaterial& material, cgvMat4& transform);
+
+    void replay_animated(const cgvCommandList& list, float time);
 
-    void renderSceneB();
+    void submit_animated(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& model, unsigned long box, float time);
 
-    void renderSceneC();
+    static cgvMat4 get_animated_transform(const cgvMat4& model, unsigned long box, float time);
 
-    void paint_axes();
+    void replay_wireframes(const cgvCommandList& list, bool animate, float time); // outlines of the other renderers
 };
 
 #endif   // __IGVESCENA3D
@@ -0,0 +1,113 @@
+#include "cgvSimulation.h"
+
+/**
+* Constructor that starts the simulation thread, which publishes a first
+* snapshot before waiting for events
+* @param _apply Function that applies an event to the scene, on the simulation thread
+* @param _record Function that records the scene in a snapshot, on the simulation thread
+*/
+cgvSimulation::cgvSimulation(const std::function<void(const cgvInputEvent&)>& _apply,
+                             const std::function<void(cgvSceneSnapshot&)>& _record)
+    : apply(_apply), record(_record)
+{ thread = std::thread(&cgvSimulation::run, this);
+}
+
+/**
+* Destructor that waits for the simulation thread to exit
+*/
+cgvSimulation::~cgvSimulation()
+{ { std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+/**
+* Queues an event for the simulation thread. Does not lock unless the thread is
+* waiting for events
+* @param event Event received by a GLUT callback
+* @retval true If it has been queued
+* @retval false If the queue was full and the event has been dropped
+*/
+bool cgvSimulation::push(const cgvInputEvent& event)
+{ if (!events.push(event))
+    { return false;
+    }
+    queued++;
+    if (sleeping)
+    { std::lock_guard<std::mutex> lock(mutex);
+        wake.notify_one();
+    }
+    return true;
+}
+
+/**
+* Method to query the events dropped because the simulation thread fell behind
+* @return The number of events dropped
+*/
+unsigned long cgvSimulation::get_dropped()
+{ return events.get_dropped();
+}
+
+/**
+* Method to query the events queued so far, which the snapshots count in their events
+* @return The number of events queued
+*/
+unsigned long cgvSimulation::get_queued()
+{ return queued;
+}
+
+/**
+* Method to check whether a snapshot has been published since the last call to latest
+* @retval true If there is a newer snapshot to draw
+* @retval false Otherwise
+*/
+bool cgvSimulation::has_new_snapshot()
+{ return (ready & CGV_SNAPSHOT_NEW) != 0;
+}
+
+/**
+* Takes the newest snapshot published, which stays valid until the next call
+* @return The snapshot to draw; it is empty until the first one is published
+*/
+const cgvSceneSnapshot& cgvSimulation::latest()
+{ if (has_new_snapshot())
+    { front = ready.exchange(front) & ~CGV_SNAPSHOT_NEW;
+    }
+    return snapshots[front];
+}
+
+/**
+* Loop of the simulation thread: applies the queued events and publishes a
+* snapshot of the scene after each batch of them
+*/
+void cgvSimulation::run()
+{ for (;;)
+    { cgvInputEvent event;
+        while (events.pop(event))
+        { apply(event);
+            applied++;
+        }
+
+        record(snapshots[back]);
+        snapshots[back].events = applied;
+        publish();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        sleeping = true;
+        wake.wait(lock, [this] { return stopping || !events.empty(); });
+        sleeping = false;
+        if (stopping)
+        { return;
+        }
+    }
+}
+
+/**
+* Makes the snapshot just written the ready one, and takes the previous ready
+* one to write the next
+*/
+void cgvSimulation::publish()
+{ back = ready.exchange(back | CGV_SNAPSHOT_NEW) & ~CGV_SNAPSHOT_NEW;
+}
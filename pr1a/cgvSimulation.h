@@ -0,0 +1,64 @@
+#ifndef __CGVSIMULATION
+#define __CGVSIMULATION
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "cgvEventQueue.h"
+#include "cgvScene3D.h"
+
+#define CGV_SNAPSHOT_NEW 4 ///< Flag of the ready snapshot, set until the render thread takes it
+
+/**
+ * Thread that changes the scene, apart from the GLUT thread that draws it. The
+ * GLUT callbacks only push the input events into a cgvEventQueue; the simulation
+ * thread applies them in order, records the scene in a snapshot and publishes it
+ * through a triple buffer: it writes one snapshot while another one is ready and
+ * the render thread draws the third one. Neither thread waits for the other, and
+ * the render thread always draws a whole snapshot, never one being written
+ */
+class cgvSimulation {
+private:
+    cgvEventQueue events; ///< Events pushed by the GLUT thread
+    std::function<void(const cgvInputEvent&)> apply; ///< Applies an event to the scene
+    std::function<void(cgvSceneSnapshot&)> record; ///< Records the scene in a snapshot
+
+    cgvSceneSnapshot snapshots[3]; ///< Triple buffer of the states of the scene
+    int back = 0; ///< Snapshot written by the simulation thread
+    int front = 1; ///< Snapshot drawn by the render thread
+    std::atomic<int> ready{2}; ///< Last snapshot published, plus CGV_SNAPSHOT_NEW if it has not been taken
+    unsigned long applied = 0; ///< Events applied, for the simulation thread
+    unsigned long queued = 0; ///< Events queued, for the GLUT thread
+
+    std::thread thread; ///< Simulation thread
+    std::mutex mutex; ///< Protects the waits for events
+    std::condition_variable wake; ///< Wakes up the simulation thread when there are events
+    std::atomic<bool> sleeping{false}; ///< Whether the simulation thread waits for events
+    bool stopping = false; ///< Whether the simulation thread has to exit
+
+public:
+    cgvSimulation(const std::function<void(const cgvInputEvent&)>& _apply,
+                  const std::function<void(cgvSceneSnapshot&)>& _record);
+    ~cgvSimulation();
+
+    cgvSimulation(const cgvSimulation&) = delete;
+    cgvSimulation& operator=(const cgvSimulation&) = delete;
+
+    // Methods for the GLUT thread
+    bool push(const cgvInputEvent& event);
+    unsigned long get_dropped();
+    unsigned long get_queued(); // a snapshot has applied the event queued last once its events reach it
+
+    // Methods for the render thread
+    bool has_new_snapshot();
+    const cgvSceneSnapshot& latest(); // takes the newest snapshot published
+
+private:
+    void run();
+    void publish();
+};
+
+#endif   // __CGVSIMULATION
@@ -0,0 +1,232 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdio.h>
+
+#include "cgvStreamBuffer.h"
+
+#if !(defined(__APPLE__) && defined(__MACH__))
+// Flags of the storage and of the mapping: written by the CPU, mapped while the
+// GPU reads it, and visible to the GPU without flushing
+#define CGV_STREAM_FLAGS (GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT)
+#endif   // !(defined(__APPLE__) && defined(__MACH__))
+
+/**
+* Creates the buffer and decides how it is streamed: through a persistent
+* mapping if the context has GL_ARB_buffer_storage and CGV_STREAM is not
+* "orphan", by orphaning it on every upload otherwise. The ring is allocated by
+* the first map
+* @pre The core entry points have been loaded
+*/
+void cgvStreamBuffer::initialize()
+{ glGenBuffers(1, &buffer);
+
+#if !(defined(__APPLE__) && defined(__MACH__))
+    const char* mode = getenv("CGV_STREAM");
+    persistent = glBufferStorage && cgvGLCore::has_extension("GL_ARB_buffer_storage")
+                 && !(mode && strcmp(mode, "orphan") == 0);
+#endif   // !(defined(__APPLE__) && defined(__MACH__))
+
+    if (persistent)
+    { fprintf(stderr, "[stream] per-instance data streamed through a persistently mapped ring of %d regions\n",
+                CGV_STREAM_REGIONS);
+    }
+    else
+    { fprintf(stderr, "[stream] per-instance data streamed by orphaning the buffer\n");
+    }
+}
+
+/**
+* Gives the memory to write data in. With the persistent ring, it is the next
+* free piece of the region of the frame; when the region is full, the data goes
+* to the next region, which may wait for the GPU to finish the draws that read
+* it. The ring grows if the data does not fit in a region
+* @param _size Bytes to write
+* @return The memory, valid until unmap
+*/
+void* cgvStreamBuffer::map(GLsizeiptr _size)
+{ size = _size;
+    frame_bytes += (unsigned long) size;
+    if (!persistent)
+    { if ((GLsizeiptr) staging.size() < size)
+        { staging.resize(size);
+        }
+        return staging.data();
+    }
+
+    if (size > region_size)
+    { allocate((size * 2 + CGV_STREAM_ALIGNMENT - 1) & ~(GLsizeiptr) (CGV_STREAM_ALIGNMENT - 1));
+        if (!persistent)
+        { frame_bytes -= (unsigned long) size;
+            return map(_size);
+        }
+    }
+    else if (used + size > region_size)
+    { next_region();
+    }
+
+    if (!released)
+    { wait(region);
+        released = true;
+    }
+    offset = region * region_size + used;
+    used += (size + CGV_STREAM_ALIGNMENT - 1) & ~(GLsizeiptr) (CGV_STREAM_ALIGNMENT - 1);
+    return mapped + offset;
+}
+
+/**
+* Ends the writes and binds the buffer to GL_ARRAY_BUFFER, so the vertex
+* attributes can be pointed at the data. When the buffer is orphaned, the data
+* is uploaded here
+* @return The offset of the data in the buffer, in bytes
+*/
+GLintptr cgvStreamBuffer::unmap()
+{ glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    if (persistent)
+    { return offset; // the mapping is coherent: the GPU sees the writes without flushing
+    }
+
+    if (size > region_size)
+    { region_size = size * 2;
+    }
+    // orphan the previous contents, so the upload does not wait for the last frame
+    glBufferData(GL_ARRAY_BUFFER, region_size, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, staging.data());
+    return 0;
+}
+
+/**
+* Guards the region of the frame with a fence, so it is not written again until
+* the GPU has finished the draws issued so far. The fence replaces the one of
+* the previous draws of the region, as the GPU finishes the draws in order
+*/
+void cgvStreamBuffer::fence()
+{ if (persistent)
+    { if (fences[region])
+        { glDeleteSync(fences[region]);
+        }
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+/**
+* Ends the frame: the next one is written to the next region, and the data
+* written by this one is the data streamed by the last frame
+*/
+void cgvStreamBuffer::next_frame()
+{ streamed_bytes = frame_bytes;
+    frame_bytes = 0;
+    if (persistent && used > 0)
+    { next_region();
+    }
+}
+
+/**
+* Method to check how the buffer is streamed
+* @retval true If it is a persistently mapped ring
+* @retval false If it is orphaned on every frame
+*/
+bool cgvStreamBuffer::is_persistent()
+{ return persistent;
+}
+
+/**
+* Method to query the data streamed by the last frame presented
+* @return The bytes written between the last two calls to next_frame
+*/
+unsigned long cgvStreamBuffer::get_streamed_bytes()
+{ return streamed_bytes;
+}
+
+/**
+* Method to query the times the CPU has waited for the GPU to release a region
+* @return The number of waits
+*/
+unsigned long cgvStreamBuffer::get_waits()
+{ return waits;
+}
+
+/**
+* Method to query the time the CPU has waited for the GPU to release a region
+* @return The accumulated time, in milliseconds
+*/
+double cgvStreamBuffer::get_wait_ms()
+{ return wait_ms;
+}
+
+/**
+* Replaces the ring by a bigger one, mapped for good. The draws already issued
+* keep reading the previous buffer, which the GL frees when they are done
+* @param _region_size Size of each region, in bytes
+*/
+void cgvStreamBuffer::allocate(GLsizeiptr _region_size)
+{
+#if !(defined(__APPLE__) && defined(__MACH__))
+    for (GLsync& region_fence: fences)
+    { if (region_fence)
+        { glDeleteSync(region_fence);
+            region_fence = nullptr;
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    if (mapped)
+    { glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+    glDeleteBuffers(1, &buffer);
+
+    region_size = _region_size;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferStorage(GL_ARRAY_BUFFER, region_size * CGV_STREAM_REGIONS, nullptr, CGV_STREAM_FLAGS);
+    mapped = (char*) glMapBufferRange(GL_ARRAY_BUFFER, 0, region_size * CGV_STREAM_REGIONS, CGV_STREAM_FLAGS);
+    region = 0;
+    used = 0;
+    released = true;
+    if (!mapped)
+    { fprintf(stderr, "[stream] the ring could not be mapped; the buffer is orphaned from now on\n");
+        persistent = false;
+        region_size = 0;
+        glDeleteBuffers(1, &buffer); // its storage cannot be orphaned
+        glGenBuffers(1, &buffer);
+    }
+#endif   // !(defined(__APPLE__) && defined(__MACH__))
+}
+
+/**
+* Moves on to the next region of the ring. Its previous contents may still be
+* read by the GPU, so the first map that writes to it waits for its fence
+*/
+void cgvStreamBuffer::next_region()
+{ region = (region + 1) % CGV_STREAM_REGIONS;
+    used = 0;
+    released = false;
+}
+
+/**
+* Waits until the GPU has finished the draws that read a region. A wait that
+* blocks is counted and reported on stderr
+* @param _region Region about to be written
+*/
+void cgvStreamBuffer::wait(int _region)
+{ GLsync region_fence = fences[_region];
+    if (!region_fence)
+    { return;
+    }
+
+    if (glClientWaitSync(region_fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+    { auto start = std::chrono::steady_clock::now();
+        GLenum status;
+        do
+        { status = glClientWaitSync(region_fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000); // 1 s
+        } while (status == GL_TIMEOUT_EXPIRED);
+
+        std::chrono::duration<double, std::milli> waited = std::chrono::steady_clock::now() - start;
+        waits++;
+        wait_ms += waited.count();
+        fprintf(stderr, "[stream] waited %.3f ms for the GPU to release region %d\n", waited.count(), _region);
+    }
+
+    glDeleteSync(region_fence);
+    fences[_region] = nullptr;
+}
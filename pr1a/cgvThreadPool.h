@@ -0,0 +1,45 @@
+#ifndef __CGVTHREADPOOL
+#define __CGVTHREADPOOL
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of worker threads that run the iterations of a parallel loop. The
+ * calling thread takes part in every loop, so a pool of n threads starts n - 1
+ * workers
+ */
+class cgvThreadPool {
+private:
+    std::vector<std::thread> workers; ///< Threads other than the caller
+    std::mutex mutex; ///< Protects the state of the current loop
+    std::condition_variable work_ready; ///< Wakes up the workers when a loop starts
+    std::condition_variable work_done; ///< Wakes up the caller when the workers finish
+    std::function<void(int)> job; ///< Body of the current loop
+    int count = 0; ///< Iterations of the current loop
+    std::atomic<int> next{0}; ///< Next iteration to take
+    int busy = 0; ///< Workers still running the current loop
+    unsigned long generation = 0; ///< Number of loops started, so workers do not run one twice
+    bool stopping = false; ///< Whether the workers have to exit
+
+public:
+    explicit cgvThreadPool(unsigned int threads);
+    ~cgvThreadPool();
+
+    cgvThreadPool(const cgvThreadPool&) = delete;
+    cgvThreadPool& operator=(const cgvThreadPool&) = delete;
+
+    // Methods
+    unsigned int get_threads();
+    void run(int iterations, const std::function<void(int)>& body); // body(i) for i in [0, iterations)
+
+private:
+    void work();
+    void take_iterations();
+};
+
+#endif   // __CGVTHREADPOOL
@@ -0,0 +1,143 @@
+#if defined(__APPLE__) && defined(__MACH__)
+
+#include <GLUT/glut.h>
+
+#include <OpenGL/gl.h>
+
+#include <OpenGL/glu.h>
+
+#else
+
+#include <GL/glut.h>
+
+#endif
+
+#include <math.h>
+#include <stdio.h>
+
+#include "cgvCamera.h"
+
+cgvCameraPreset::cgvCameraPreset(cgvVec3 _P0, cgvVec3 _r, cgvVec3 _V) :
+    P0(_P0), r(_r), V(_V), view(cgvMat4::look_at(_P0, _r, _V)) {}
+
+// Constructor methods
+cgvCamera::cgvCamera() {}
+
+cgvCamera::~cgvCamera() {}
+
+cgvCamera::cgvCamera(cameraType _type, cgvVec3 _P0, cgvVec3 _r, cgvVec3 _V) {
+    P0 = _P0;
+    r = _r;
+    V = _V;
+
+    type = _type;
+}
+
+// Every method that changes the parameters marks the matrices they are part of, so
+// get_matrices only computes them again when they have changed
+
+void cgvCamera::set(cgvVec3 _P0, cgvVec3 _r, cgvVec3 _V) {
+    P0 = _P0;
+    r = _r;
+    V = _V;
+    view_changed = true;
+}
+
+void cgvCamera::set(cameraType _type, cgvVec3 _P0, cgvVec3 _r, cgvVec3 _V,
+                    double _xwmin, double _xwmax, double _ywmin, double _ywmax, double _znear, double _zfar) {
+    type = _type;
+
+    P0 = _P0;
+    r = _r;
+    V = _V;
+
+    xwmin = _xwmin;
+    xwmax = _xwmax;
+    ywmin = _ywmin;
+    ywmax = _ywmax;
+    znear = _znear;
+    zfar = _zfar;
+    projection_changed = true;
+    view_changed = true;
+}
+
+void cgvCamera::set(cameraType _tipo, cgvVec3 _P0, cgvVec3 _r, cgvVec3 _V,
+                    double _angulo, double _raspecto, double _znear, double _zfar) {
+    type = _tipo;
+
+    P0 = _P0;
+    r = _r;
+    V = _V;
+
+    angle = _angulo;
+    aspect = _raspecto;
+    znear = _znear;
+    zfar = _zfar;
+    projection_changed = true;
+    view_changed = true;
+}
+
+void cgvCamera::set(const cgvCameraPreset& preset) {
+    P0 = preset.P0;
+    r = preset.r;
+    V = preset.V;
+    view_matrix = preset.view;
+    view_changed = false;
+}
+
+void cgvCamera::set_perspective(double _angle, double _aspect) {
+    angle = _angle;
+    aspect = _aspect;
+    projection_changed = true;
+}
+
+void cgvCamera::set_znear(double _znear) {
+    znear = _znear;
+    projection_changed = true;
+}
+
+void cgvCamera::apply(cgvRenderer* renderer) {
+    cgvMat4 projection, view;
+    get_matrices(projection, view);
+    renderer->set_camera(projection, view);
+}
+
+void cgvCamera::get_matrices(cgvMat4& projection, cgvMat4& view) {
+    if (projection_changed) {
+        if (type == CGV_PARALLEL) {
+            projection_matrix = cgvMat4::ortho(xwmin, xwmax, ywmin, ywmax, znear, zfar);
+        }
+        if (type == CGV_FRUSTRUM) {
+            projection_matrix = cgvMat4::frustum(xwmin, xwmax, ywmin, ywmax, znear, zfar);
+        }
+        if (type == CGV_PERSPECTIVE) {
+            projection_matrix = cgvMat4::perspective(angle, aspect, znear, zfar);
+        }
+        projection_changed = false;
+    }
+    if (view_changed) {
+        view_matrix = cgvMat4::look_at(P0, r, V);
+        view_changed = false;
+    }
+
+    projection = projection_matrix;
+    view = view_matrix;
+}
+
+void cgvCamera::zoom(double factor) {
+    if (type == CGV_PARALLEL || type == CGV_FRUSTRUM)
+    {
+        xwmin *= factor;
+        xwmax *= factor;
+        ywmin *= factor;
+        ywmax *= factor;
+    }
+    else
+    {
+        if (angle * factor < 180.0)
+        {
+            angle *= factor;
+        }
+    }
+    projection_changed = true;
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "cgvGLStats.h"
+#include "cgvMath.h"
+#include "cgvRenderer.h"
+
+/**
+ * Labels to define the types of cameras
+ */
+typedef enum {
+	CGV_PARALLEL,
+	CGV_PERSPECTIVE,
+    CGV_FRUSTRUM
+} cameraType;
+
+
+
+/**
+ * Camera position with its view matrix computed beforehand, so a camera can be
+ * switched to it without computing the matrix again
+ */
+struct cgvCameraPreset {
+    cgvVec3 P0; // viewpoint
+    cgvVec3 r; // view reference point
+    cgvVec3 V; // vector up
+    cgvMat4 view; // view matrix, computed by the constructor
+
+    cgvCameraPreset() = default;
+    cgvCameraPreset(cgvVec3 _P0, cgvVec3 _r, cgvVec3 _V);
+};
+
+/**
+ * cgvCamera contains the basic functionality to create and manipulate cameras and projections
+ */
+class cgvCamera {
+
+public:
+    // attributes, read only: they are changed through the methods, which keep the matrices up to date
+
+    cameraType type; // parallel or perspective
+
+    // viewport: parallel and frustum projection parameters
+    GLdouble xwmin, xwmax, ywmin, ywmax;
+
+    // viewport: perspective projection parameters
+    GLdouble angle, aspect;
+
+    // distances of near and far planes
+    GLdouble znear, zfar;
+
+    // viewpoint
+    cgvVec3 P0;
+
+    // view reference point
+    cgvVec3 r;
+
+    // vector up
+    cgvVec3 V;
+
+protected:
+    // projection and view matrices of the last call to get_matrices, computed again only
+    // after the parameters change through the methods below
+    cgvMat4 projection_matrix, view_matrix;
+    bool projection_changed = true, view_changed = true;
+
+    // Methods
+
+public:
+    // Default constructors and destructor
+    cgvCamera();
+    ~cgvCamera();
+
+    // Other constructors
+    cgvCamera(cameraType _type, cgvVec3 _P0, cgvVec3 _r, cgvVec3 _V);
+
+    // Methods
+    // Defines the camera position
+    void set(cgvVec3 _P0, cgvVec3 _r, cgvVec3 _V);
+
+    // defines a parallel or frustum type camera
+    void set(cameraType _type, cgvVec3 _P0, cgvVec3 _r, cgvVec3 _V,
+             double _xwmin, double _xwmax, double _ywmin, double _ywmax, double _znear, double _zfar);
+
+    // defines a perspective camera
+    void set(cameraType _type, cgvVec3 _P0, cgvVec3 _r, cgvVec3 _V,
+             double _angle, double _aspect, double _znear, double _zfar);
+
+    // moves the camera to a preset position, taking its view matrix as is
+    void set(const cgvCameraPreset& preset);
+
+    // parameters of the perspective projection
+    void set_perspective(double _angle, double _aspect);
+
+    // distance of the near plane
+    void set_znear(double _znear);
+
+    void apply(cgvRenderer* renderer); // applies the vision transform and the projection transform to the objects in the scene
+    // associated with the camera parameters, through the renderer
+    void get_matrices(cgvMat4& projection, cgvMat4& view); // projection and view matrices of the camera, from the cache
+    void zoom(double factor); // zooms in on the camera
+};
+
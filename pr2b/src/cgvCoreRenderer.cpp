@@ -0,0 +1,1535 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <stdio.h>
+
+#include "cgvCoreRenderer.h"
+#include "cgvFrameArena.h"
+
+// Vertex attribute locations shared by the shaders and the vertex array
+#define CGV_ATTRIB_POSITION 0
+#define CGV_ATTRIB_NORMAL 1
+#define CGV_ATTRIB_COLOR 2
+#define CGV_ATTRIB_TRANSFORM 3 ///< Takes locations 3 to 6, one per column
+#define CGV_ATTRIB_MATERIAL 7
+#define CGV_ATTRIB_VIEW 8
+
+#define CGV_CAMERA_BINDING 0 ///< Uniform buffer binding point of the camera
+#define CGV_CULL_BINDING 1 ///< Uniform buffer binding point of the arguments of the compute shader
+#define CGV_GRID_INSTANCES_BINDING 0 ///< Storage buffer binding points of the outputs of the compute shader
+#define CGV_GRID_VIEWS_BINDING 1
+#define CGV_GRID_COMMANDS_BINDING 2
+#define CGV_CULL_GROUP_SIZE 64 ///< Cells culled by each work group of the compute shader
+#define CGV_CULL_GROUPS_X 65535 ///< Work groups along X of a dispatch; large grids take rows of them
+
+#define CGV_SHADOW_BINDING 3 ///< Uniform buffer binding point of the shadow map
+#define CGV_SHADOW_TEXTURE_UNIT 3 ///< Texture unit of the shadow map, after the ones of the light clusters
+#define CGV_SHADOW_SIZE 1024 ///< Width and height of each face of the shadow map
+#define CGV_SHADOW_NEAR 0.05f ///< Near distance of the faces of the shadow map
+#define CGV_SHADOW_OFFSET_FACTOR 2.0f ///< Slope-scaled depth offset of the casters, against shadow acne
+#define CGV_SHADOW_OFFSET_UNITS 4.0f ///< Constant depth offset of the casters
+
+#define CGV_OUTLINE_TEXTURE_UNIT 4 ///< First of the four texture units of the outline pass, after the shadow map
+
+// Lighting of the fixed-function pipeline with the default material and GL_LIGHT0,
+// computed per vertex as glEnable(GL_LIGHTING) does: global ambient 0.2 times
+// material ambient 0.2, plus material diffuse 0.8 times a white point light
+// without attenuation. The material has no specular term. Each instance is
+// drawn with the camera of its view; the camera arrays hold CGV_MAX_VIEWS views.
+// The local lights and the shadows are added per fragment, so the shader also
+// passes on what they need: the position and normal in world coordinates, the
+// unlit color, the depth in the view and the color without GL_LIGHT0, and the
+// object of the outlines
+static const char* vertex_shader = R"(
+#version 330 core
+layout(std140) uniform Camera
+{ mat4 projection[4];
+    mat4 view[4];
+    vec4 light_position;
+};
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec4 vertex_color;
+layout(location = 3) in mat4 transform;
+layout(location = 7) in vec4 material_color;
+layout(location = 8) in uint instance_view;
+
+out Vertex
+{ vec3 lit_color;
+    flat int view_index;
+    vec3 world_position;
+    vec3 world_normal;
+    vec3 base_color;
+    float view_depth;
+    flat int lit;
+    vec3 shadow_color;
+    flat uint object;
+} vertex;
+
+void main()
+{ vec4 world_position = transform * vec4(position, 1.0);
+    vec3 color = mix(material_color.rgb, vertex_color.rgb, vertex_color.a);
+    vec3 n = normalize(transpose(inverse(mat3(transform))) * normal); // as with GL_NORMALIZE
+
+    vertex.base_color = color;
+    vertex.lit = (material_color.a > 0.5) ? 1 : 0;
+    vertex.shadow_color = color;
+    if (material_color.a > 0.5)
+    { vertex.shadow_color = min(color + vec3(0.04), vec3(1.0));
+        vec3 l = normalize(light_position.xyz - world_position.xyz);
+        color = min(color + vec3(0.04) + 0.8 * max(dot(n, l), 0.0), vec3(1.0)); // clamped before interpolation
+    }
+
+    int v = int(instance_view);
+    vertex.lit_color = color;
+    vertex.view_index = v;
+    vertex.world_position = world_position.xyz;
+    vertex.world_normal = n;
+    vertex.view_depth = -(view[v] * world_position).z;
+
+    // the object of the outlines: a hash of the position of the instance, never 0
+    uvec3 origin = floatBitsToUint(transform[3].xyz);
+    vertex.object = max((origin.x * 73856093u) ^ (origin.y * 19349663u) ^ (origin.z * 83492791u), 1u);
+    gl_Position = projection[v] * view[v] * world_position;
+}
+)";
+
+// Geometry shaders that send each primitive to the viewport of its view, for the
+// triangles and for the lines
+static const char* triangles_geometry_shader = R"(
+#version 330 core
+#extension GL_ARB_viewport_array : require
+layout(triangles) in;
+layout(triangle_strip, max_vertices = 3) out;
+
+in Vertex
+{ vec3 lit_color;
+    flat int view_index;
+    vec3 world_position;
+    vec3 world_normal;
+    vec3 base_color;
+    float view_depth;
+    flat int lit;
+    vec3 shadow_color;
+    flat uint object;
+} vertex_in[];
+
+out Vertex
+{ vec3 lit_color;
+    flat int view_index;
+    vec3 world_position;
+    vec3 world_normal;
+    vec3 base_color;
+    float view_depth;
+    flat int lit;
+    vec3 shadow_color;
+    flat uint object;
+} vertex_out;
+
+void main()
+{ for (int i = 0; i < 3; i++)
+    { vertex_out.lit_color = vertex_in[i].lit_color;
+        vertex_out.view_index = vertex_in[i].view_index;
+        vertex_out.world_position = vertex_in[i].world_position;
+        vertex_out.world_normal = vertex_in[i].world_normal;
+        vertex_out.base_color = vertex_in[i].base_color;
+        vertex_out.view_depth = vertex_in[i].view_depth;
+        vertex_out.lit = vertex_in[i].lit;
+        vertex_out.shadow_color = vertex_in[i].shadow_color;
+        vertex_out.object = vertex_in[i].object;
+        gl_ViewportIndex = vertex_in[i].view_index;
+        gl_Position = gl_in[i].gl_Position;
+        EmitVertex();
+    }
+}
+)";
+
+static const char* lines_geometry_shader = R"(
+#version 330 core
+#extension GL_ARB_viewport_array : require
+layout(lines) in;
+layout(line_strip, max_vertices = 2) out;
+
+in Vertex
+{ vec3 lit_color;
+    flat int view_index;
+    vec3 world_position;
+    vec3 world_normal;
+    vec3 base_color;
+    float view_depth;
+    flat int lit;
+    vec3 shadow_color;
+    flat uint object;
+} vertex_in[];
+
+out Vertex
+{ vec3 lit_color;
+    flat int view_index;
+    vec3 world_position;
+    vec3 world_normal;
+    vec3 base_color;
+    float view_depth;
+    flat int lit;
+    vec3 shadow_color;
+    flat uint object;
+} vertex_out;
+
+void main()
+{ for (int i = 0; i < 2; i++)
+    { vertex_out.lit_color = vertex_in[i].lit_color;
+        vertex_out.view_index = vertex_in[i].view_index;
+        vertex_out.world_position = vertex_in[i].world_position;
+        vertex_out.world_normal = vertex_in[i].world_normal;
+        vertex_out.base_color = vertex_in[i].base_color;
+        vertex_out.view_depth = vertex_in[i].view_depth;
+        vertex_out.lit = vertex_in[i].lit;
+        vertex_out.shadow_color = vertex_in[i].shadow_color;
+        vertex_out.object = vertex_in[i].object;
+        gl_ViewportIndex = vertex_in[i].view_index;
+        gl_Position = gl_in[i].gl_Position;
+        EmitVertex();
+    }
+}
+)";
+
+// Compute shader that culls the cells of a grid as cgvRenderer::cull does, one
+// cell per invocation, numbered along X and then Y of the dispatch. The
+// instances visible in a view are appended to the range of its command, whose
+// instance count is the number of instances appended; their order in the range
+// depends on the scheduling of the invocations
+static const char* cull_shader = R"(
+#version 430 core
+layout(local_size_x = 64) in;
+
+layout(std140, binding = 1) uniform Grid
+{ mat4 transform;
+    vec4 color;
+    vec4 bounds;
+    vec4 spacing;
+    ivec4 cells;
+    vec4 frusta[24];
+    ivec4 views;
+};
+
+struct Instance
+{ mat4 transform;
+    vec4 color;
+};
+
+struct Command
+{ uint count;
+    uint instance_count;
+    uint first;
+    uint base_instance;
+};
+
+layout(std430, binding = 0) writeonly buffer Instances
+{ Instance instances[];
+};
+
+layout(std430, binding = 1) writeonly buffer Views
+{ uint instance_views[];
+};
+
+layout(std430, binding = 2) buffer Commands
+{ Command commands[];
+};
+
+void main()
+{ int cell = int(gl_GlobalInvocationID.y * gl_NumWorkGroups.x * gl_WorkGroupSize.x + gl_GlobalInvocationID.x);
+    if (cell >= cells.w)
+    { return;
+    }
+
+    vec3 offset = vec3(cell / cells.z % cells.x, cell / (cells.x * cells.z), cell % cells.z) * spacing.xyz;
+    vec4 center = vec4(bounds.xyz + offset, 1.0);
+    mat4 cell_transform = transform;
+    cell_transform[3].xyz += offset;
+
+    for (int v = 0; v < views.x; v++)
+    { bool inside = true;
+        for (int plane = 0; plane < 6 && inside && views.y != 0; plane++)
+        { inside = dot(frusta[v * 6 + plane], center) >= -bounds.w;
+        }
+        if (inside)
+        { uint command = uint(views.w + v);
+            uint instance = commands[command].base_instance + atomicAdd(commands[command].instance_count, 1u);
+            instances[instance] = Instance(cell_transform, color);
+            instance_views[instance] = uint(v);
+        }
+    }
+}
+)";
+
+// Shaders that draw the casters into the shadow map: the geometry shader sends
+// each triangle to the six faces of the cube map, as the layers of the
+// framebuffer. The instances of the batches come with their transform; the
+// cells of a grid culled on the GPU are all drawn, placed from their instance
+// number with the arguments of the compute shader, as it places them
+static const char* shadow_vertex_shader = R"(
+#version 330 core
+layout(std140) uniform Grid
+{ mat4 transform;
+    vec4 color;
+    vec4 bounds;
+    vec4 spacing;
+    ivec4 cells;
+} grid;
+
+uniform int grid_draw;
+
+layout(location = 0) in vec3 position;
+layout(location = 3) in mat4 transform;
+
+void main()
+{ mat4 model = transform;
+    if (grid_draw != 0)
+    { int cell = gl_InstanceID;
+        model = grid.transform;
+        model[3].xyz += vec3(cell / grid.cells.z % grid.cells.x, cell / (grid.cells.x * grid.cells.z),
+                             cell % grid.cells.z) * grid.spacing.xyz;
+    }
+    gl_Position = model * vec4(position, 1.0);
+}
+)";
+
+static const char* shadow_geometry_shader = R"(
+#version 330 core
+layout(triangles) in;
+layout(triangle_strip, max_vertices = 18) out;
+
+layout(std140) uniform Shadow
+{ mat4 faces[6];
+    vec4 shadow_light;
+    vec4 shadow_range;
+};
+
+void main()
+{ for (int face = 0; face < 6; face++)
+    { for (int i = 0; i < 3; i++)
+        { gl_Layer = face;
+            gl_Position = faces[face] * gl_in[i].gl_Position;
+            EmitVertex();
+        }
+        EndPrimitive();
+    }
+}
+)";
+
+static const char* shadow_fragment_shader = R"(
+#version 330 core
+void main()
+{
+}
+)";
+
+// Fragment shader that shadows the lighting of the vertices and adds the local
+// lights of the cluster of the fragment. The fragment is lit by GL_LIGHT0 as far
+// as the shadow map sees it from the light: the depth it would have in the face
+// of the cube map it falls in is compared with the map, filtered over 2x2 texels.
+// The cluster is its tile in the viewport of its view, and its depth slice,
+// exponential with perspective projections, as cgvLightClusters bins them. Each
+// local light adds material diffuse 0.8 times its color, fading out smoothly to
+// its radius. Without shadows or local lights the color is the vertex one. The
+// normal and the object of the fragment are written for the outlines; they are
+// dropped unless the frame is drawn to their offscreen framebuffer
+static const char* fragment_shader = R"(
+#version 330 core
+layout(std140) uniform Clusters
+{ vec4 depth_ranges[4];
+    vec4 viewports[4];
+    ivec4 size;
+};
+
+layout(std140) uniform Shadow
+{ mat4 faces[6];
+    vec4 shadow_light;
+    vec4 shadow_range;
+};
+
+uniform samplerBuffer light_data;
+uniform usamplerBuffer cluster_ranges;
+uniform usamplerBuffer light_indices;
+uniform samplerCubeShadow shadow_map;
+
+in Vertex
+{ vec3 lit_color;
+    flat int view_index;
+    vec3 world_position;
+    vec3 world_normal;
+    vec3 base_color;
+    float view_depth;
+    flat int lit;
+    vec3 shadow_color;
+    flat uint object;
+} vertex;
+
+layout(location = 0) out vec4 color;
+layout(location = 1) out vec4 surface_normal; // only kept while outlining
+layout(location = 2) out uint surface_object;
+
+void main()
+{ surface_normal = vec4(normalize(vertex.world_normal) * 0.5 + 0.5, 1.0);
+    surface_object = vertex.object;
+
+    vec3 c = vertex.lit_color;
+    if (shadow_light.w > 0.0 && vertex.lit != 0)
+    { vec3 d = vertex.world_position - shadow_light.xyz;
+        vec3 a = abs(d);
+        float face_depth = max(a.x, max(a.y, a.z)); // along the axis of the face of the cube map
+        float n = shadow_range.x, f = shadow_range.y;
+        float depth = 0.5 * ((f + n) / (f - n) - 2.0 * f * n / ((f - n) * face_depth)) + 0.5;
+        c = mix(vertex.shadow_color, c, texture(shadow_map, vec4(d, depth)));
+    }
+    if (size.w > 0 && vertex.lit != 0)
+    { int v = vertex.view_index;
+        vec4 range = depth_ranges[v];
+        float slice = (range.z > 0.5) ? log(vertex.view_depth / range.x) / range.w
+                                      : (vertex.view_depth - range.x) / (range.y - range.x);
+        vec3 coords = vec3((gl_FragCoord.xy - viewports[v].xy) / viewports[v].zw, slice);
+        ivec3 cluster = clamp(ivec3(floor(coords * vec3(size.xyz))), ivec3(0), size.xyz - 1);
+        uvec2 lights = texelFetch(cluster_ranges,
+                                  ((v * size.z + cluster.z) * size.y + cluster.y) * size.x + cluster.x).xy;
+
+        vec3 n = normalize(vertex.world_normal);
+        for (uint i = 0u; i < lights.y; i++)
+        { int light = int(texelFetch(light_indices, int(lights.x + i)).x);
+            vec4 sphere = texelFetch(light_data, 2 * light);
+            vec3 l = sphere.xyz - vertex.world_position;
+            float fade = clamp(1.0 - dot(l, l) / (sphere.w * sphere.w), 0.0, 1.0);
+            c += 0.8 * vertex.base_color * texelFetch(light_data, 2 * light + 1).rgb
+                 * max(dot(n, normalize(l)), 0.0) * fade * fade;
+        }
+        c = min(c, vec3(1.0));
+    }
+    color = vec4(c, 1.0);
+}
+)";
+
+// Full-screen pass of the outlines, drawn once per view: a triangle covering the
+// viewport, without attributes. Each pixel of a filled mesh gets the outline
+// color if its four neighbours in the view face another way, or break the depth
+// of its surface: the window depth of a plane changes linearly across the screen
+// with either projection, so its second difference is only far from 0 at steps
+// and creases. Across objects any step is an edge; within an object only large
+// ones are, so curved meshes are not outlined inside. Coplanar faces of two
+// objects, which fight over their pixels, are not outlined. The depth of the
+// frame is copied along, for what is drawn after it
+static const char* outline_vertex_shader = R"(
+#version 330 core
+void main()
+{ gl_Position = vec4(float((gl_VertexID & 1) << 2) - 1.0, float((gl_VertexID & 2) << 1) - 1.0, 0.0, 1.0);
+}
+)";
+
+static const char* outline_fragment_shader = R"(
+#version 330 core
+uniform sampler2D frame_color;
+uniform sampler2D frame_normal;
+uniform usampler2D frame_object;
+uniform sampler2D frame_depth;
+uniform ivec4 view_bounds; // first and last pixel of the view
+uniform vec3 outline_color;
+
+out vec4 color;
+
+void main()
+{ ivec2 p = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(frame_depth, p, 0).r;
+    color = texelFetch(frame_color, p, 0);
+    gl_FragDepth = depth;
+
+    uint object = texelFetch(frame_object, p, 0).r;
+    if (object == 0u)
+    { return; // background, or only lines and wireframes
+    }
+    vec3 n = texelFetch(frame_normal, p, 0).xyz * 2.0 - 1.0;
+    bool edge = false;
+    for (int axis = 0; axis < 2; axis++)
+    { ivec2 offset = ivec2(1 - axis, axis);
+        ivec2 a = clamp(p - offset, view_bounds.xy, view_bounds.zw);
+        ivec2 b = clamp(p + offset, view_bounds.xy, view_bounds.zw);
+        bool other = texelFetch(frame_object, a, 0).r != object || texelFetch(frame_object, b, 0).r != object;
+        float step = abs(texelFetch(frame_depth, a, 0).r + texelFetch(frame_depth, b, 0).r - 2.0 * depth);
+        edge = edge || step > (other ? 0.00001 : 0.001);
+        edge = edge || dot(n, texelFetch(frame_normal, a, 0).xyz * 2.0 - 1.0) < 0.8
+                    || dot(n, texelFetch(frame_normal, b, 0).xyz * 2.0 - 1.0) < 0.8;
+    }
+    if (edge)
+    { color = vec4(outline_color, 1.0);
+    }
+}
+)";
+
+/**
+* Method to query the name of the backend
+* @return The name accepted by cgvRenderer::create
+*/
+const char* cgvCoreRenderer::get_name()
+{ return "core";
+}
+
+/**
+* Method to check whether the backend needs an OpenGL 3.3 core-profile context
+* @retval true Always
+*/
+bool cgvCoreRenderer::requires_core_profile()
+{ return true;
+}
+
+/**
+* Loads the core entry points and creates the shader program, the buffers and
+* the vertex array. Must be called once the core-profile context is current
+* @retval true If the renderer is ready to draw
+* @retval false If the entry points or the shaders are not available
+*/
+bool cgvCoreRenderer::initialize()
+{ if (!cgvGLCore::load())
+    { return false;
+    }
+
+    program = cgvGLCore::compile_program(vertex_shader, fragment_shader);
+    if (!program)
+    { return false;
+    }
+
+    // the views are drawn together if the geometry shaders can pick their viewports
+    if (glViewportIndexedf && cgvGLCore::has_extension("GL_ARB_viewport_array"))
+    { triangles_program = cgvGLCore::compile_program(vertex_shader, fragment_shader, triangles_geometry_shader);
+        lines_program = cgvGLCore::compile_program(vertex_shader, fragment_shader, lines_geometry_shader);
+    }
+    if (triangles_program && lines_program)
+    { fprintf(stderr, "[gl-core] several views are drawn with a single draw call per batch\n");
+    }
+    else
+    { fprintf(stderr, "[gl-core] GL_ARB_viewport_array not available; several views are drawn one after the other\n");
+    }
+
+    // the grids are culled on the GPU if the context runs compute shaders and draws indirectly
+#if !(defined(__APPLE__) && defined(__MACH__))
+    const char* gpu_culling = getenv("CGV_GPU_CULLING");
+    if (glDispatchCompute && glMemoryBarrier && glMultiDrawArraysIndirect
+        && !(gpu_culling && strcmp(gpu_culling, "off") == 0) && cgvGLCore::has_extension("GL_ARB_compute_shader")
+        && cgvGLCore::has_extension("GL_ARB_shader_storage_buffer_object")
+        && cgvGLCore::has_extension("GL_ARB_multi_draw_indirect") && cgvGLCore::has_extension("GL_ARB_base_instance"))
+    { cull_program = cgvGLCore::compile_compute_program(cull_shader);
+    }
+#endif   // !(defined(__APPLE__) && defined(__MACH__))
+    if (cull_program)
+    { fprintf(stderr, "[gl-core] grids are culled on the GPU and drawn with one indirect draw call each\n");
+        glGenBuffers(1, &cull_buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, cull_buffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(cgvCoreGridCull), nullptr, GL_DYNAMIC_DRAW);
+        glGenBuffers(1, &grid_instances);
+        glGenBuffers(1, &grid_views);
+        glGenBuffers(1, &grid_commands);
+    }
+    else
+    { fprintf(stderr, "[gl-core] compute shaders or indirect draws not available; grids are submitted by cells\n");
+    }
+
+    glEnable(GL_DEPTH_TEST); // enable z-buffer surface hiding
+
+    glGenBuffers(1, &camera_buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, camera_buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(cgvCoreCamera), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, CGV_CAMERA_BINDING, camera_buffer);
+    clusters.initialize();
+
+    // the shadow map itself is only created if the shadows are turned on
+    glGenBuffers(1, &shadow_buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, shadow_buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(cgvCoreShadow), &shadow, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, CGV_SHADOW_BINDING, shadow_buffer);
+
+    for (GLuint p: { program, triangles_program, lines_program })
+    { if (p)
+        { glUniformBlockBinding(p, glGetUniformBlockIndex(p, "Camera"), CGV_CAMERA_BINDING);
+            glUniformBlockBinding(p, glGetUniformBlockIndex(p, "Shadow"), CGV_SHADOW_BINDING);
+            cgvLightClusters::set_bindings(p);
+            glUseProgram(p);
+            glUniform1i(glGetUniformLocation(p, "shadow_map"), CGV_SHADOW_TEXTURE_UNIT);
+            glUseProgram(0);
+        }
+    }
+
+    // all the meshes, one after the other
+    std::vector<cgvVertex> mesh_vertices;
+    for (int mesh = 0; mesh < CGV_MESHES; mesh++)
+    { meshes[mesh].first = (GLint) mesh_vertices.size();
+        meshes[mesh].primitive = tessellate((cgvMesh) mesh, mesh_vertices);
+        meshes[mesh].count = (GLsizei) mesh_vertices.size() - meshes[mesh].first;
+    }
+
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    glGenBuffers(1, &vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, vertices);
+    glBufferData(GL_ARRAY_BUFFER, mesh_vertices.size() * sizeof(cgvVertex), mesh_vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(CGV_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(cgvVertex),
+                          (void*) offsetof(cgvVertex, position));
+    glVertexAttribPointer(CGV_ATTRIB_NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(cgvVertex),
+                          (void*) offsetof(cgvVertex, normal));
+    glVertexAttribPointer(CGV_ATTRIB_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(cgvVertex),
+                          (void*) offsetof(cgvVertex, color));
+    glEnableVertexAttribArray(CGV_ATTRIB_POSITION);
+    glEnableVertexAttribArray(CGV_ATTRIB_NORMAL);
+    glEnableVertexAttribArray(CGV_ATTRIB_COLOR);
+
+    // per-instance attributes; they are pointed at each batch in end_frame. The
+    // view of the instances only comes from the buffer when the views are drawn together
+    instances.initialize();
+    for (int i = 0; i < 5; i++)
+    { glVertexAttribDivisor(CGV_ATTRIB_TRANSFORM + i, 1);
+        glEnableVertexAttribArray(CGV_ATTRIB_TRANSFORM + i);
+    }
+    glVertexAttribDivisor(CGV_ATTRIB_VIEW, 1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return true;
+}
+
+/**
+* Sets the camera used to draw the next frames, and culls against it. The
+* uniform buffer is only uploaded again if the matrices have changed
+* @param projection Projection matrix, column-major
+* @param view View matrix, column-major
+*/
+void cgvCoreRenderer::set_camera(const cgvMat4& projection, const cgvMat4& view)
+{ cgvRenderer::set_camera(projection, view);
+    if (memcmp(camera.projection[0], projection.data(), sizeof(camera.projection[0])) != 0
+        || memcmp(camera.view[0], view.data(), sizeof(camera.view[0])) != 0)
+    { memcpy(camera.projection[0], projection.data(), sizeof(camera.projection[0]));
+        memcpy(camera.view[0], view.data(), sizeof(camera.view[0]));
+        camera_changed = true;
+    }
+}
+
+/**
+* Sets the views the next frames are drawn in, and copies their cameras to the
+* uniform buffer
+* @param _views Viewport and camera of each view
+* @param count Number of views, from 1 to CGV_MAX_VIEWS
+*/
+void cgvCoreRenderer::set_views(const cgvView* _views, int count)
+{ cgvRenderer::set_views(_views, count);
+    if (count > 1)
+    { for (int i = 0; i < count; i++)
+        { memcpy(camera.projection[i], views[i].projection.data(), sizeof(camera.projection[i]));
+            memcpy(camera.view[i], views[i].view.data(), sizeof(camera.view[i]));
+        }
+        camera_changed = true;
+    }
+}
+
+/**
+* Sets the position of the point light, as the GL_POSITION of GL_LIGHT0. The
+* shadow map is drawn again if it moves
+* @param position Position of the light, in world coordinates
+*/
+void cgvCoreRenderer::set_light(const cgvVec4& position)
+{ if (memcmp(camera.light_position, position.data(), sizeof(camera.light_position)) != 0)
+    { memcpy(camera.light_position, position.data(), sizeof(camera.light_position));
+        camera_changed = true;
+        shadows_valid = false; // the shadow map was drawn from the old position
+    }
+}
+
+/**
+* Sets the local point lights of the next frames. A cgvLightClusters bins them
+* into clusters of the frusta of the views, and each fragment adds the lights of
+* its cluster. They are binned again only when they or the views change
+* @param lights Lights, copied
+* @param count Number of lights; 0 removes them
+*/
+void cgvCoreRenderer::set_local_lights(const cgvPointLight* lights, int count)
+{ clusters.set_lights(lights, count);
+}
+
+/**
+* Turns the shadows of the point light on or off. They come from a depth cube
+* map around the light, drawn in one pass by a geometry shader that sends each
+* triangle to the six faces; on the frames that draw it, the meshes outside the
+* views are kept as casters. The first time they are turned on, the shadow map
+* is created; if it cannot be, they stay off
+* @param enabled Whether the lit meshes are shadowed
+*/
+void cgvCoreRenderer::set_shadows(bool enabled)
+{ if (enabled == shadows)
+    { return;
+    }
+    if (enabled && !shadow_program && (!shadows_available || !create_shadow_map()))
+    { return;
+    }
+
+    shadows = enabled;
+    shadows_valid = false; // the meshes may have changed while the map was not drawn
+    shadow.light[3] = 0; // until the map is drawn
+    glBindBuffer(GL_UNIFORM_BUFFER, shadow_buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(cgvCoreShadow), &shadow);
+}
+
+/**
+* Makes the next frame draw the shadow map again, with the meshes it submits
+*/
+void cgvCoreRenderer::invalidate_shadows()
+{ shadows_valid = false;
+}
+
+/**
+* Turns the outlines of the filled meshes on or off, from the next clear. The
+* frame is drawn to an offscreen framebuffer that also keeps the normal and an
+* identifier of the object of each pixel, and draw_outlines draws the outline
+* color on the pixels whose neighbours belong to another object, face another
+* way or break the depth of the surface. The first time they are turned on,
+* their program is compiled; if it cannot be, they stay off
+* @param enabled Whether the filled meshes are outlined
+* @param color Color of the outlines
+* @retval true If the outlines are drawn as asked
+* @retval false If they are asked for and cannot be drawn
+*/
+bool cgvCoreRenderer::set_outlines(bool enabled, const GLfloat color[3])
+{ if (enabled && !outline_program && (!outlines_available || !create_outlines()))
+    { return false;
+    }
+    outlines = enabled;
+    memcpy(outline_color, color, sizeof(outline_color));
+    return true;
+}
+
+/**
+* Clears the frame. With outlines, the frame is drawn to their offscreen
+* framebuffer, and its normals and objects are cleared to 0 along with the
+* color and the depth
+*/
+void cgvCoreRenderer::clear()
+{ outline_frame = outlines && bind_outlines();
+    if (!outline_frame)
+    { cgvRenderer::clear();
+        return;
+    }
+
+    static const GLfloat no_normal[4] = { 0, 0, 0, 0 };
+    static const GLuint no_object[4] = { 0, 0, 0, 0 };
+    set_outline_surfaces(true);
+    glClearBufferfv(GL_COLOR, 0, clear_value);
+    glClearBufferfv(GL_COLOR, 1, no_normal);
+    glClearBufferuiv(GL_COLOR, 2, no_object);
+    glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+/**
+* Shows the frame in the window, and moves the stream buffer on to the region
+* of the next frame
+*/
+void cgvCoreRenderer::present()
+{ instances.next_frame();
+    cgvRenderer::present();
+}
+
+/**
+* Starts collecting the instances of a new frame, and decides whether it draws
+* the shadow map
+*/
+void cgvCoreRenderer::begin_frame()
+{ for (cgvCoreBatch& batch: batches)
+    { batch.instances.clear(); // keeps the capacity, so steady frames do not allocate
+        batch.visible.clear();
+        for (GLsizei& count: batch.view_counts)
+        { count = 0;
+        }
+    }
+    grids.clear();
+    culled_instances = 0;
+    shadow_frame = shadows && !shadows_valid;
+    shadow_far = 0;
+}
+
+/**
+* Adds a mesh to the batch with its mesh, polygon mode and line width, unless
+* it is outside the views. On the frames that draw the shadow map, the meshes
+* that cast shadows are kept even outside the views
+* @param mesh Mesh to draw
+* @param material Appearance of the mesh
+* @param transform Modeling matrix of the mesh
+*/
+void cgvCoreRenderer::submit(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& transform)
+{ cgvBounds bounds = get_bounds(mesh, transform);
+    cgvViewMask visible = cull(bounds);
+    bool caster = shadow_frame && is_surface(mesh, material.polygon_mode);
+    if (!visible && !caster)
+    { return;
+    }
+    if (caster)
+    { add_caster(bounds);
+    }
+
+    cgvCoreBatch* batch = nullptr;
+    for (cgvCoreBatch& b: batches)
+    { if (b.mesh == mesh && b.polygon_mode == material.polygon_mode && b.line_width == material.line_width)
+        { batch = &b;
+            break;
+        }
+    }
+    if (!batch)
+    { batches.push_back({ mesh, material.polygon_mode, material.line_width, {}, {}, {}, {}, 0 });
+        batch = &batches.back();
+    }
+
+    cgvCoreInstance instance;
+    memcpy(instance.transform, transform.data(), sizeof(instance.transform));
+    instance.color[0] = material.color[0];
+    instance.color[1] = material.color[1];
+    instance.color[2] = material.color[2];
+    instance.color[3] = material.lit ? 1.0f : 0.0f;
+    batch->instances.push_back(instance);
+    batch->visible.push_back(visible);
+    for (int i = 0; i < view_count; i++)
+    { batch->view_counts[i] += (visible >> i) & 1;
+    }
+}
+
+/**
+* Submits a copy of a mesh in each cell of a grid. When the context runs compute
+* shaders and draws indirectly (OpenGL 4.3), the grids are culled on the GPU: the
+* grid is only kept for end_frame, whatever its size, and a compute shader tests
+* its cells against the frusta of the views, so it takes one indirect draw call
+* and the CPU does not visit its cells. Those cells are not counted by
+* get_culled_instances, and all of them are drawn into the shadow map.
+* CGV_GPU_CULLING=off submits the cells one by one
+* @param mesh Mesh to draw
+* @param material Appearance of all the copies
+* @param transform Modeling matrix of the copy in the cell (0, 0, 0)
+* @param grid Cells of the grid and distance between them
+*/
+void cgvCoreRenderer::submit_grid(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& transform,
+                                  const cgvGrid& grid)
+{ if (!cull_program)
+    { cgvRenderer::submit_grid(mesh, material, transform, grid);
+        return;
+    }
+
+    cgvCoreGrid g = { mesh, material.polygon_mode, material.line_width, {} };
+    cgvCoreGridCull& cull = g.cull;
+    memcpy(cull.transform, transform.data(), sizeof(cull.transform));
+    cull.color[0] = material.color[0];
+    cull.color[1] = material.color[1];
+    cull.color[2] = material.color[2];
+    cull.color[3] = material.lit ? 1.0f : 0.0f;
+    cgvBounds bounds = get_bounds(mesh, transform);
+    for (int i = 0; i < 3; i++)
+    { cull.bounds[i] = bounds.center[i];
+        cull.spacing[i] = grid.spacing[i];
+        cull.cells[i] = grid.cells[i];
+    }
+    cull.bounds[3] = bounds.radius;
+    cull.cells[3] = grid.cells[0] * grid.cells[1] * grid.cells[2];
+    if (cull.cells[3] <= 0)
+    { return;
+    }
+    grids.push_back(g);
+
+    // the farthest cell from the light is at a corner of the grid
+    if (shadow_frame && is_surface(mesh, material.polygon_mode))
+    { for (int corner = 0; corner < 8; corner++)
+        { cgvBounds cell = bounds;
+            for (int i = 0; i < 3; i++)
+            { cell.center[i] += ((corner >> i) & 1) * (grid.cells[i] - 1) * grid.spacing[i];
+            }
+            add_caster(cell);
+        }
+    }
+}
+
+/**
+* Method to check whether the grids are culled on the GPU
+* @retval true If the context runs compute shaders and draws indirectly
+* @retval false Otherwise, or with CGV_GPU_CULLING=off; the cells are submitted one by one
+*/
+bool cgvCoreRenderer::culls_grids()
+{ return cull_program != 0;
+}
+
+/**
+* Writes the instances of the frame in one go into the stream buffer and draws
+* every batch with an instanced draw call. With several views, the instances
+* of each batch are written view after view, only in the views they are visible
+* in, following the lists of the instances culled for each view, which live in
+* the frame arena. With GL_ARB_viewport_array, all the views of a batch are drawn by the same
+* draw call: the view of each instance comes with it, and the geometry shaders
+* send its primitives to the viewport of the view. Without it, each view draws
+* its own instances of every batch. The grids are culled by the compute shader
+* and drawn after the batches. The local lights are binned for the views first,
+* and the shadow map is drawn before the views when the frame draws it; the
+* outlines are drawn last, copying the frame to the framebuffer it was cleared in
+* @return The number of draw calls issued
+*/
+unsigned long cgvCoreRenderer::end_frame()
+{ bool together = view_count > 1 && triangles_program && lines_program;
+
+    read_shadow_query();
+
+    size_t count = 0;
+    for (cgvCoreBatch& batch: batches)
+    { for (int i = 0; i < view_count; i++)
+        { batch.view_first[i] = count;
+            count += batch.view_counts[i];
+        }
+    }
+    size_t view_instances = count;
+    if (shadow_frame)
+    { for (cgvCoreBatch& batch: batches)
+        { if (is_surface(batch.mesh, batch.polygon_mode))
+            { batch.shadow_first = count;
+                count += batch.instances.size();
+            }
+        }
+    }
+    if (count == 0 && grids.empty())
+    { return outline_frame ? draw_outlines() : 0;
+    }
+    frame_instances = count;
+
+    if (camera_changed)
+    { glBindBuffer(GL_UNIFORM_BUFFER, camera_buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(cgvCoreCamera), &camera);
+        camera_changed = false;
+    }
+    clusters.update(views, view_count);
+    if (clusters.get_lights() > 0)
+    { clusters.bind();
+    }
+    if (shadows)
+    { glActiveTexture(GL_TEXTURE0 + CGV_SHADOW_TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, shadow_map);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // the batches are copied one after the other, in the order they are drawn,
+    // followed by the casters of the shadow map if it is drawn, and by the views
+    // of the instances if the views are drawn together
+    GLintptr offset = 0;
+    if (count > 0)
+    { size_t view_bytes = together ? view_instances * sizeof(GLuint) : 0;
+        char* mapped = (char*) instances.map(count * sizeof(cgvCoreInstance) + view_bytes);
+        cgvCoreInstance* instance_data = (cgvCoreInstance*) mapped;
+        GLuint* view_data = (GLuint*) (mapped + count * sizeof(cgvCoreInstance));
+        cgvFrameArena& arena = cgvFrameArena::getInstance();
+        for (const cgvCoreBatch& batch: batches)
+        { if (view_count == 1 && batch.view_counts[0] == (GLsizei) batch.instances.size())
+            { memcpy(instance_data, batch.instances.data(), batch.instances.size() * sizeof(cgvCoreInstance));
+                instance_data += batch.instances.size();
+                continue;
+            }
+            // the instances visible in each view are listed in one pass over the
+            // masks, then copied view after view
+            uint32_t* culled[CGV_MAX_VIEWS];
+            uint32_t* culled_end[CGV_MAX_VIEWS];
+            for (int i = 0; i < view_count; i++)
+            { culled[i] = culled_end[i] = (uint32_t*) arena.allocate(batch.view_counts[i] * sizeof(uint32_t),
+                                                                   alignof(uint32_t));
+            }
+            for (size_t j = 0; j < batch.instances.size(); j++)
+            { for (int i = 0; i < view_count; i++)
+                { if (batch.visible[j] & (1u << i))
+                    { *culled_end[i]++ = (uint32_t) j;
+                    }
+                }
+            }
+            for (int i = 0; i < view_count; i++)
+            { for (const uint32_t* j = culled[i]; j != culled_end[i]; j++)
+                { *instance_data++ = batch.instances[*j];
+                    if (together)
+                    { *view_data++ = i;
+                    }
+                }
+            }
+        }
+        if (shadow_frame)
+        { for (const cgvCoreBatch& batch: batches)
+            { if (is_surface(batch.mesh, batch.polygon_mode))
+                { memcpy(instance_data, batch.instances.data(), batch.instances.size() * sizeof(cgvCoreInstance));
+                    instance_data += batch.instances.size();
+                }
+            }
+        }
+        offset = instances.unmap();
+    }
+
+    if (!grids.empty())
+    { cull_grids();
+    }
+
+    glBindVertexArray(vao);
+    current_program = 0; // the program is set again on every frame
+
+    unsigned long draw_calls = 0;
+    if (shadow_frame)
+    { draw_calls += draw_shadows(offset);
+    }
+    if (together)
+    { for (int i = 0; i < view_count; i++)
+        { glViewportIndexedf(i, (GLfloat) views[i].x, (GLfloat) views[i].y, (GLfloat) views[i].width,
+                               (GLfloat) views[i].height);
+        }
+        glEnableVertexAttribArray(CGV_ATTRIB_VIEW);
+        for (const cgvCoreBatch& batch: batches)
+        { GLsizei batch_count = 0;
+            for (int i = 0; i < view_count; i++)
+            { batch_count += batch.view_counts[i];
+            }
+            GLuint batch_program = (meshes[batch.mesh].primitive == GL_LINES) ? lines_program : triangles_program;
+            draw_calls += draw_batch(batch, offset, batch.view_first[0], batch_count, batch_program);
+        }
+        glDisableVertexAttribArray(CGV_ATTRIB_VIEW);
+    }
+    else
+    { for (int i = 0; i < view_count; i++)
+        { if (view_count > 1)
+            { glViewport(views[i].x, views[i].y, views[i].width, views[i].height);
+            }
+            glVertexAttribI4ui(CGV_ATTRIB_VIEW, i, 0, 0, 0); // the same view for all the instances
+            for (const cgvCoreBatch& batch: batches)
+            { draw_calls += draw_batch(batch, offset, batch.view_first[i], batch.view_counts[i], program);
+            }
+        }
+    }
+    if (!grids.empty())
+    { draw_calls += draw_grids(together);
+    }
+    if (outline_frame)
+    { draw_calls += draw_outlines();
+    }
+
+    glBindVertexArray(0);
+    if (count > 0)
+    { instances.fence();
+    }
+    return draw_calls;
+}
+
+/**
+* Runs the compute shader on every grid of the frame. Each grid gets a command
+* per view, with a range of the instance buffer as large as the grid; the
+* commands are uploaded with no instances, and the compute shader counts the
+* visible cells in them. The buffers grow to hold the largest frame
+*/
+void cgvCoreRenderer::cull_grids()
+{
+#if !(defined(__APPLE__) && defined(__MACH__))
+    commands.clear();
+    GLsizeiptr total = 0;
+    for (cgvCoreGrid& grid: grids)
+    { cgvCoreGridCull& cull = grid.cull;
+        const cgvCoreMesh& mesh = meshes[grid.mesh];
+        memcpy(cull.frusta, frusta, sizeof(cull.frusta));
+        cull.views[0] = view_count;
+        cull.views[1] = culling;
+        cull.views[2] = (GLint) total;
+        cull.views[3] = (GLint) commands.size();
+        for (int i = 0; i < view_count; i++)
+        { commands.push_back({ (GLuint) mesh.count, 0, (GLuint) mesh.first, (GLuint) total });
+            total += cull.cells[3];
+        }
+    }
+
+    if (total > grid_capacity)
+    { grid_capacity = total;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, grid_instances);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, grid_capacity * sizeof(cgvCoreInstance), nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, grid_views);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, grid_capacity * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, grid_commands);
+    if ((GLsizeiptr) commands.size() > command_capacity)
+    { command_capacity = commands.size();
+        glBufferData(GL_SHADER_STORAGE_BUFFER, command_capacity * sizeof(cgvCoreDrawCommand), nullptr,
+                     GL_DYNAMIC_DRAW);
+    }
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, commands.size() * sizeof(cgvCoreDrawCommand), commands.data());
+
+    glUseProgram(cull_program);
+    glBindBufferBase(GL_UNIFORM_BUFFER, CGV_CULL_BINDING, cull_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CGV_GRID_INSTANCES_BINDING, grid_instances);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CGV_GRID_VIEWS_BINDING, grid_views);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CGV_GRID_COMMANDS_BINDING, grid_commands);
+    glBindBuffer(GL_UNIFORM_BUFFER, cull_buffer);
+    for (const cgvCoreGrid& grid: grids)
+    { GLuint groups = (grid.cull.cells[3] + CGV_CULL_GROUP_SIZE - 1) / CGV_CULL_GROUP_SIZE;
+        GLuint rows = (groups + CGV_CULL_GROUPS_X - 1) / CGV_CULL_GROUPS_X;
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(cgvCoreGridCull), &grid.cull);
+        glDispatchCompute(rows > 1 ? CGV_CULL_GROUPS_X : groups, rows, 1);
+    }
+
+    // the draws read the instances as vertex attributes and the commands as indirect arguments
+    glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+#endif   // !(defined(__APPLE__) && defined(__MACH__))
+}
+
+/**
+* Method to query the per-instance data written to the stream buffer by the
+* last frame presented
+* @return The bytes written
+*/
+unsigned long cgvCoreRenderer::get_streamed_bytes()
+{ return instances.get_streamed_bytes();
+}
+
+/**
+* Method to query the times the CPU has waited for the GPU to release a region
+* of the stream buffer
+* @return The number of waits
+*/
+unsigned long cgvCoreRenderer::get_stream_waits()
+{ return instances.get_waits();
+}
+
+/**
+* Draws instances of a batch with an instanced draw call
+* @param batch Batch of the instances
+* @param offset Offset of the instances of the frame in the stream buffer; their
+* views follow them if the views are drawn together
+* @param first First instance drawn, among the instances of the frame
+* @param count Instances drawn
+* @param batch_program Program they are drawn with
+* @return The number of draw calls issued: 0 if there are no instances to draw
+*/
+unsigned long cgvCoreRenderer::draw_batch(const cgvCoreBatch& batch, GLintptr offset, size_t first, GLsizei count,
+                                          GLuint batch_program)
+{ if (count == 0)
+    { return 0;
+    }
+
+    set_state(batch.polygon_mode, batch.line_width, batch_program);
+    if (batch_program != shadow_program)
+    { set_outline_surfaces(is_surface(batch.mesh, batch.polygon_mode));
+    }
+
+    // without base instances, the attributes are pointed at the first instance drawn
+    const char* base = (const char*) (offset + first * sizeof(cgvCoreInstance));
+    for (int column = 0; column < 4; column++)
+    { glVertexAttribPointer(CGV_ATTRIB_TRANSFORM + column, 4, GL_FLOAT, GL_FALSE, sizeof(cgvCoreInstance),
+                              base + offsetof(cgvCoreInstance, transform) + column * 4 * sizeof(GLfloat));
+    }
+    glVertexAttribPointer(CGV_ATTRIB_MATERIAL, 4, GL_FLOAT, GL_FALSE, sizeof(cgvCoreInstance),
+                          base + offsetof(cgvCoreInstance, color));
+    if (batch_program == triangles_program || batch_program == lines_program)
+    { const char* views_base = (const char*) (offset + frame_instances * sizeof(cgvCoreInstance) + first * sizeof(GLuint));
+        glVertexAttribIPointer(CGV_ATTRIB_VIEW, 1, GL_UNSIGNED_INT, sizeof(GLuint), views_base);
+    }
+
+    const cgvCoreMesh& mesh = meshes[batch.mesh];
+    glDrawArraysInstanced(mesh.primitive, mesh.first, mesh.count, count);
+    return 1;
+}
+
+/**
+* Draws the grids culled by the compute shader. The instances of all the grids
+* are in the same buffer, and each command starts at the range of its grid and
+* view, so the attributes are pointed at the buffer once. With the views drawn
+* together, a grid draws the commands of all its views with one call; otherwise
+* each view draws its command of every grid
+* @param together Whether the geometry shaders send the primitives to the
+* viewports of their views
+* @return The number of draw calls issued
+*/
+unsigned long cgvCoreRenderer::draw_grids(bool together)
+{ unsigned long draw_calls = 0;
+
+#if !(defined(__APPLE__) && defined(__MACH__))
+    glBindBuffer(GL_ARRAY_BUFFER, grid_instances);
+    for (int column = 0; column < 4; column++)
+    { glVertexAttribPointer(CGV_ATTRIB_TRANSFORM + column, 4, GL_FLOAT, GL_FALSE, sizeof(cgvCoreInstance),
+                              (void*) (offsetof(cgvCoreInstance, transform) + column * 4 * sizeof(GLfloat)));
+    }
+    glVertexAttribPointer(CGV_ATTRIB_MATERIAL, 4, GL_FLOAT, GL_FALSE, sizeof(cgvCoreInstance),
+                          (void*) offsetof(cgvCoreInstance, color));
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, grid_commands);
+
+    if (together)
+    { glBindBuffer(GL_ARRAY_BUFFER, grid_views);
+        glVertexAttribIPointer(CGV_ATTRIB_VIEW, 1, GL_UNSIGNED_INT, sizeof(GLuint), nullptr);
+        glEnableVertexAttribArray(CGV_ATTRIB_VIEW);
+        for (const cgvCoreGrid& grid: grids)
+        { const cgvCoreMesh& mesh = meshes[grid.mesh];
+            set_state(grid.polygon_mode, grid.line_width,
+                      (mesh.primitive == GL_LINES) ? lines_program : triangles_program);
+            set_outline_surfaces(is_surface(grid.mesh, grid.polygon_mode));
+            glMultiDrawArraysIndirect(mesh.primitive, (void*) (grid.cull.views[3] * sizeof(cgvCoreDrawCommand)),
+                                      view_count, 0);
+            draw_calls++;
+        }
+        glDisableVertexAttribArray(CGV_ATTRIB_VIEW);
+    }
+    else
+    { for (int i = 0; i < view_count; i++)
+        { if (view_count > 1)
+            { glViewport(views[i].x, views[i].y, views[i].width, views[i].height);
+            }
+            glVertexAttribI4ui(CGV_ATTRIB_VIEW, i, 0, 0, 0);
+            for (const cgvCoreGrid& grid: grids)
+            { const cgvCoreMesh& mesh = meshes[grid.mesh];
+                set_state(grid.polygon_mode, grid.line_width, program);
+                set_outline_surfaces(is_surface(grid.mesh, grid.polygon_mode));
+                glMultiDrawArraysIndirect(mesh.primitive,
+                                          (void*) ((grid.cull.views[3] + i) * sizeof(cgvCoreDrawCommand)), 1, 0);
+                draw_calls++;
+            }
+        }
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+#endif   // !(defined(__APPLE__) && defined(__MACH__))
+
+    return draw_calls;
+}
+
+/**
+* Sets the polygon mode, the line width and the program of the next draws,
+* only where they change
+* @param _polygon_mode Polygon mode
+* @param _line_width Line width
+* @param _program Program
+*/
+void cgvCoreRenderer::set_state(GLenum _polygon_mode, GLfloat _line_width, GLuint _program)
+{ if (polygon_mode != _polygon_mode)
+    { glPolygonMode(GL_FRONT_AND_BACK, _polygon_mode);
+        polygon_mode = _polygon_mode;
+    }
+    if (line_width != _line_width)
+    { glLineWidth(_line_width);
+        line_width = _line_width;
+    }
+    if (current_program != _program)
+    { glUseProgram(_program);
+        current_program = _program;
+    }
+}
+
+/**
+* Compiles the program of the shadow map and creates the cube map, with depth
+* comparison for the lookups of the fragment shader, its framebuffer and the
+* timer query of the shadow pass
+* @retval true If the shadows can be drawn
+* @retval false If the program or the framebuffer are not complete; it is not
+* tried again
+*/
+bool cgvCoreRenderer::create_shadow_map()
+{ shadows_available = false;
+    shadow_program = cgvGLCore::compile_program(shadow_vertex_shader, shadow_fragment_shader, shadow_geometry_shader);
+    if (!shadow_program)
+    { fprintf(stderr, "[gl-core] the shadow map cannot be drawn; there are no shadows\n");
+        return false;
+    }
+    glUniformBlockBinding(shadow_program, glGetUniformBlockIndex(shadow_program, "Shadow"), CGV_SHADOW_BINDING);
+    GLuint grid_block = glGetUniformBlockIndex(shadow_program, "Grid");
+    if (grid_block != GL_INVALID_INDEX)
+    { glUniformBlockBinding(shadow_program, grid_block, CGV_CULL_BINDING);
+    }
+    shadow_grid_location = glGetUniformLocation(shadow_program, "grid_draw");
+
+    glGenTextures(1, &shadow_map);
+    glActiveTexture(GL_TEXTURE0 + CGV_SHADOW_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, shadow_map);
+    for (int face = 0; face < 6; face++)
+    { glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_DEPTH_COMPONENT24, CGV_SHADOW_SIZE, CGV_SHADOW_SIZE, 0,
+                     GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glActiveTexture(GL_TEXTURE0);
+
+    GLuint framebuffer = get_frame_framebuffer();
+    glGenFramebuffers(1, &shadow_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadow_framebuffer);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadow_map, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    if (!complete)
+    { fprintf(stderr, "[gl-core] the shadow map of %dx%d pixels per face is not complete; there are no shadows\n",
+                CGV_SHADOW_SIZE, CGV_SHADOW_SIZE);
+        glDeleteFramebuffers(1, &shadow_framebuffer);
+        glDeleteTextures(1, &shadow_map);
+        glDeleteProgram(shadow_program);
+        shadow_framebuffer = shadow_map = shadow_program = 0;
+        return false;
+    }
+
+    glGenQueries(1, &shadow_query);
+    shadows_available = true;
+    fprintf(stderr, "[gl-core] shadows from a cube map of %dx%d pixels per face, drawn again only on changes\n",
+            CGV_SHADOW_SIZE, CGV_SHADOW_SIZE);
+    return true;
+}
+
+/**
+* Method to check whether the meshes of a batch or grid are surfaces: only the
+* filled triangles cast shadows and are outlined
+* @param mesh Mesh of the batch
+* @param _polygon_mode Polygon mode of the batch
+* @retval true If they are surfaces
+* @retval false If they are lines or wireframes
+*/
+bool cgvCoreRenderer::is_surface(cgvMesh mesh, GLenum _polygon_mode)
+{ return meshes[mesh].primitive == GL_TRIANGLES && _polygon_mode == GL_FILL;
+}
+
+/**
+* Extends the range of the faces of the shadow map to a caster of the frame
+* @param bounds Bounds of the caster
+*/
+void cgvCoreRenderer::add_caster(const cgvBounds& bounds)
+{ cgvVec3 light(camera.light_position[0], camera.light_position[1], camera.light_position[2]);
+    shadow_far = std::max(shadow_far, length(bounds.center - light) + bounds.radius);
+}
+
+/**
+* Method to query the framebuffer the meshes of the frame are drawn to, so the
+* passes that bind others can go back to it without querying OpenGL
+* @return The offscreen framebuffer of the outlines on an outlined frame;
+* otherwise the one of the frames, as get_target_framebuffer
+*/
+GLuint cgvCoreRenderer::get_frame_framebuffer()
+{ return outline_frame ? outline_framebuffer : get_target_framebuffer();
+}
+
+/**
+* Draws the casters of the frame into the six faces of the shadow map, with a
+* single draw call per batch and per grid, and keeps it until the next change.
+* The time the GPU spends on it is measured with a timer query, unless the one
+* of the last shadow map has not been read yet
+* @param offset Offset of the instances of the frame in the stream buffer
+* @return The number of draw calls issued
+*/
+unsigned long cgvCoreRenderer::draw_shadows(GLintptr offset)
+{ static const cgvVec3 directions[6] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+    static const cgvVec3 ups[6] = { { 0, -1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }, { 0, -1, 0 }, { 0, -1, 0 } };
+
+    // the faces of the cube map reach the farthest caster
+    cgvVec3 light(camera.light_position[0], camera.light_position[1], camera.light_position[2]);
+    GLfloat far_distance = std::max(shadow_far * 1.01f, 2 * CGV_SHADOW_NEAR);
+    cgvMat4 projection = cgvMat4::perspective(90, 1, CGV_SHADOW_NEAR, far_distance);
+    for (int face = 0; face < 6; face++)
+    { cgvMat4 face_matrix = projection * cgvMat4::look_at(light, light + directions[face], ups[face]);
+        memcpy(shadow.faces[face], face_matrix.data(), sizeof(shadow.faces[face]));
+    }
+    memcpy(shadow.light, camera.light_position, 3 * sizeof(GLfloat));
+    shadow.light[3] = 1;
+    shadow.depth_range[0] = CGV_SHADOW_NEAR;
+    shadow.depth_range[1] = far_distance;
+    glBindBuffer(GL_UNIFORM_BUFFER, shadow_buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(cgvCoreShadow), &shadow);
+
+    bool timed = !shadow_query_pending;
+    if (timed)
+    { glBeginQuery(GL_TIME_ELAPSED, shadow_query);
+    }
+    GLuint framebuffer = get_frame_framebuffer();
+    glBindFramebuffer(GL_FRAMEBUFFER, shadow_framebuffer);
+    glViewport(0, 0, CGV_SHADOW_SIZE, CGV_SHADOW_SIZE);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(CGV_SHADOW_OFFSET_FACTOR, CGV_SHADOW_OFFSET_UNITS);
+
+    unsigned long draw_calls = 0;
+    set_state(GL_FILL, line_width, shadow_program);
+    glUniform1i(shadow_grid_location, 0);
+    for (const cgvCoreBatch& batch: batches)
+    { if (is_surface(batch.mesh, batch.polygon_mode))
+        { draw_calls += draw_batch(batch, offset, batch.shadow_first, (GLsizei) batch.instances.size(), shadow_program);
+        }
+    }
+
+    // every cell of the grids, placed by the vertex shader without per-instance attributes
+    if (!grids.empty())
+    { glUniform1i(shadow_grid_location, 1);
+        for (int i = 0; i < 5; i++)
+        { glDisableVertexAttribArray(CGV_ATTRIB_TRANSFORM + i);
+        }
+        glBindBuffer(GL_UNIFORM_BUFFER, cull_buffer);
+        glBindBufferBase(GL_UNIFORM_BUFFER, CGV_CULL_BINDING, cull_buffer);
+        for (const cgvCoreGrid& grid: grids)
+        { if (is_surface(grid.mesh, grid.polygon_mode))
+            { const cgvCoreMesh& mesh = meshes[grid.mesh];
+                glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(cgvCoreGridCull), &grid.cull);
+                glDrawArraysInstanced(mesh.primitive, mesh.first, mesh.count, grid.cull.cells[3]);
+                draw_calls++;
+            }
+        }
+        for (int i = 0; i < 5; i++)
+        { glEnableVertexAttribArray(CGV_ATTRIB_TRANSFORM + i);
+        }
+    }
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(views[0].x, views[0].y, views[0].width, views[0].height);
+    if (timed)
+    { glEndQuery(GL_TIME_ELAPSED);
+        shadow_query_pending = true;
+    }
+
+    shadows_valid = true;
+    shadow_rebuilds++;
+    return draw_calls;
+}
+
+/**
+* Reads the GPU time of the last shadow map drawn, if the timer query has its
+* result; otherwise it is read by a later frame, so the CPU never waits for it
+*/
+void cgvCoreRenderer::read_shadow_query()
+{ if (!shadow_query_pending)
+    { return;
+    }
+
+    GLint available = 0;
+    glGetQueryObjectiv(shadow_query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available)
+    { GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(shadow_query, GL_QUERY_RESULT, &elapsed);
+        shadow_ms = elapsed / 1e6;
+        shadow_query_pending = false;
+    }
+}
+
+/**
+* Compiles the program of the outlines and creates the offscreen framebuffer
+* and its textures; their storage is allocated by bind_outlines
+* @retval true If the outlines can be drawn
+* @retval false If the program cannot be compiled; it is not tried again
+*/
+bool cgvCoreRenderer::create_outlines()
+{ outlines_available = false;
+    outline_program = cgvGLCore::compile_program(outline_vertex_shader, outline_fragment_shader);
+    if (!outline_program)
+    { fprintf(stderr, "[gl-core] the outlines cannot be drawn; there are no outlines\n");
+        return false;
+    }
+    static const char* samplers[4] = { "frame_color", "frame_normal", "frame_object", "frame_depth" };
+    glUseProgram(outline_program);
+    for (int i = 0; i < 4; i++)
+    { glUniform1i(glGetUniformLocation(outline_program, samplers[i]), CGV_OUTLINE_TEXTURE_UNIT + i);
+    }
+    glUseProgram(0);
+    current_program = 0;
+    outline_bounds_location = glGetUniformLocation(outline_program, "view_bounds");
+    outline_color_location = glGetUniformLocation(outline_program, "outline_color");
+
+    glGenVertexArrays(1, &outline_vao);
+    glGenFramebuffers(1, &outline_framebuffer);
+    glGenTextures(4, outline_textures);
+    for (GLuint texture: outline_textures)
+    { glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    outlines_available = true;
+    fprintf(stderr, "[gl-core] outlines from the depth, normals and objects of the frame, in one full-screen pass\n");
+    return true;
+}
+
+/**
+* Makes the offscreen framebuffer of the outlines the one drawn to, and keeps
+* the one the frames went to until then, which the outline pass draws to. The textures are
+* reallocated when they are smaller than the pixels drawn to, so the pixels of
+* the views are the same in both framebuffers
+* @retval true If the offscreen framebuffer is bound
+* @retval false If it is not complete; the frame is drawn without outlines, and
+* they are turned off
+*/
+bool cgvCoreRenderer::bind_outlines()
+{ outline_target = get_target_framebuffer();
+    glBindFramebuffer(GL_FRAMEBUFFER, outline_framebuffer);
+    if (target_width <= outline_width && target_height <= outline_height)
+    { return true;
+    }
+
+    static const GLenum formats[4][3] = { { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE },
+                                          { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE },
+                                          { GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT },
+                                          { GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT } };
+    static const GLenum attachments[4] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2,
+                                           GL_DEPTH_ATTACHMENT };
+    outline_width = std::max(outline_width, target_width);
+    outline_height = std::max(outline_height, target_height);
+    for (int i = 0; i < 4; i++)
+    { glBindTexture(GL_TEXTURE_2D, outline_textures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, formats[i][0], outline_width, outline_height, 0, formats[i][1], formats[i][2],
+                     nullptr);
+        glFramebufferTexture(GL_FRAMEBUFFER, attachments[i], outline_textures[i], 0);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    outline_surfaces = false;
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    { fprintf(stderr, "[gl-core] the outline framebuffer of %dx%d pixels is not complete; there are no outlines\n",
+                outline_width, outline_height);
+        glBindFramebuffer(GL_FRAMEBUFFER, outline_target);
+        outline_width = outline_height = 0;
+        outlines = false;
+        return false;
+    }
+    return true;
+}
+
+/**
+* Sets whether the next draws write the normal and the object of their pixels
+* to the offscreen framebuffer of the outlines, only where it changes. The
+* lines and wireframes only write their color, so they are not outlined
+* @param surfaces Whether the draws are of surfaces
+*/
+void cgvCoreRenderer::set_outline_surfaces(bool surfaces)
+{ static const GLenum buffers[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+    if (!outline_frame || outline_surfaces == surfaces)
+    { return;
+    }
+    glDrawBuffers(surfaces ? 3 : 1, buffers);
+    outline_surfaces = surfaces;
+}
+
+/**
+* Draws the frame of the offscreen framebuffer, with its outlines, to the
+* framebuffer it was cleared in: a full-screen triangle per view, so the
+* outlines do not cross the edges of the views
+* @return The number of draw calls issued
+*/
+unsigned long cgvCoreRenderer::draw_outlines()
+{ glBindFramebuffer(GL_FRAMEBUFFER, outline_target);
+    for (int i = 0; i < 4; i++)
+    { glActiveTexture(GL_TEXTURE0 + CGV_OUTLINE_TEXTURE_UNIT + i);
+        glBindTexture(GL_TEXTURE_2D, outline_textures[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+
+    set_state(GL_FILL, line_width, outline_program);
+    glUniform3f(outline_color_location, outline_color[0], outline_color[1], outline_color[2]);
+    glDepthFunc(GL_ALWAYS); // the depth of the frame replaces the one of the framebuffer
+    glBindVertexArray(outline_vao);
+    for (int i = 0; i < view_count; i++)
+    { const cgvView& v = views[i];
+        glViewport(v.x, v.y, v.width, v.height);
+        glUniform4i(outline_bounds_location, v.x, v.y, v.x + v.width - 1, v.y + v.height - 1);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+    glBindVertexArray(0);
+    glDepthFunc(GL_LESS);
+    glViewport(views[0].x, views[0].y, views[0].width, views[0].height);
+
+    outline_frame = false;
+    return view_count;
+}
@@ -0,0 +1,29 @@
+#ifndef __CGVDISPLAYLISTRENDERER
+#define __CGVDISPLAYLISTRENDERER
+
+#include "cgvImmediateRenderer.h"
+
+/**
+ * Renderer that compiles every mesh into a display list once, so drawing a mesh
+ * is a single glCallList instead of the whole glBegin/glEnd sequence
+ */
+class cgvDisplayListRenderer: public cgvImmediateRenderer {
+private:
+    GLuint lists = 0; ///< First of the CGV_MESHES display lists, one per mesh
+
+public:
+    /// Default constructor
+    cgvDisplayListRenderer() = default;
+
+    /// Destructor
+    ~cgvDisplayListRenderer() override;
+
+    // Methods
+    const char* get_name() override;
+    bool initialize() override;
+
+protected:
+    void draw_mesh(cgvMesh mesh) override;
+};
+
+#endif   // __CGVDISPLAYLISTRENDERER
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdio.h>
+
+#include "cgvDynamicResolution.h"
+
+// Singleton Pattern Application
+cgvDynamicResolution* cgvDynamicResolution::_instance = nullptr;
+
+/**
+* Default constructor. Reads the target frame time from CGV_DYNAMIC_RESOLUTION_MS
+* and the smallest scale from CGV_RESOLUTION_MIN
+*/
+cgvDynamicResolution::cgvDynamicResolution()
+{ const char* target = getenv("CGV_DYNAMIC_RESOLUTION_MS");
+    if (target)
+    { target_ms = std::max(atof(target), 0.0);
+    }
+
+    const char* min = getenv("CGV_RESOLUTION_MIN");
+    if (min)
+    { min_scale = std::min(std::max((float) atof(min), 0.1f), 1.0f);
+    }
+
+    if (target_ms > 0)
+    { fprintf(stderr, "[resolution] scaling the resolution down to %.2f to hold %.2f ms per frame\n",
+                min_scale, target_ms);
+    }
+}
+
+/**
+* Method to access the class's singleton object, applying the Singleton
+* design pattern
+* @return A reference to the class's singleton object
+*/
+cgvDynamicResolution& cgvDynamicResolution::getInstance()
+{ if ( !_instance )
+    { _instance = new cgvDynamicResolution;
+    }
+
+    return *_instance;
+}
+
+/**
+* Method to check whether the resolution is controlled
+* @retval true If CGV_DYNAMIC_RESOLUTION_MS sets a target
+* @retval false Otherwise; the scale stays at 1
+*/
+bool cgvDynamicResolution::is_enabled()
+{ return target_ms > 0;
+}
+
+/**
+* Measures a frame and decides the scale of the next ones. Nothing is decided
+* until CGV_RESOLUTION_SETTLE_FRAMES frames have been drawn at the current
+* scale, so the average only holds frames drawn at it
+* @param frame_ms Time spent drawing the frame, in ms
+* @return The decision, also kept for get_step
+*/
+cgvResolutionStep cgvDynamicResolution::update(double frame_ms)
+{ step = CGV_RESOLUTION_HOLD;
+    if (target_ms <= 0)
+    { return step;
+    }
+
+    frames++;
+    average_ms = (frames == 1) ? frame_ms : 0.75 * average_ms + 0.25 * frame_ms;
+    if (frames < CGV_RESOLUTION_SETTLE_FRAMES)
+    { return step;
+    }
+
+    float next = scale;
+    if (average_ms > target_ms * CGV_RESOLUTION_HIGH && scale > min_scale)
+    { // the cost of a frame goes with its pixels, the square of the scale
+        next = std::max(floorf(scale * (float) sqrt(target_ms / average_ms) * 100) / 100, min_scale);
+        step = CGV_RESOLUTION_DOWN;
+    }
+    else if (average_ms < target_ms * CGV_RESOLUTION_LOW && scale < 1)
+    { next = std::min(scale + CGV_RESOLUTION_STEP_UP, 1.0f);
+        step = CGV_RESOLUTION_UP;
+    }
+
+    if (step != CGV_RESOLUTION_HOLD)
+    { fprintf(stderr, "[resolution] %.3f ms per frame for a target of %.3f ms: scale %.2f -> %.2f\n",
+                average_ms, target_ms, scale, next);
+        scale = next;
+        frames = 0;
+    }
+    return step;
+}
+
+/**
+* Method to query the fraction of the window resolution to draw the next frames at
+* @return The scale of the width and height, 1 at full resolution
+*/
+float cgvDynamicResolution::get_scale()
+{ return scale;
+}
+
+/**
+* Method to query the target frame time
+* @return The target, in ms; 0 if the resolution is not controlled
+*/
+double cgvDynamicResolution::get_target_ms()
+{ return target_ms;
+}
+
+/**
+* Method to query the decision taken after the last frame
+* @return Whether the scale was lowered, kept or raised
+*/
+cgvResolutionStep cgvDynamicResolution::get_step()
+{ return step;
+}
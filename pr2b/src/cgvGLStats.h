@@ -0,0 +1,332 @@
+#ifndef __CGVGLSTATS
+#define __CGVGLSTATS
+
+#if defined(__APPLE__) && defined(__MACH__)
+#include <GLUT/glut.h>
+#include <OpenGL/gl.h>
+#include <OpenGL/glu.h>
+#else
+#include <GL/glut.h>
+#endif   // defined(__APPLE__) && defined(__MACH__)
+
+#ifdef CGV_GL_STATS
+
+/**
+ * GL, GLU and GLUT entry points that are routed through the counting wrappers
+ */
+#define CGV_GL_STATS_CALLS(X) \
+    X(glBegin) X(glEnd) X(glVertex3f) X(glColor3f) X(glMaterialfv) X(glLightfv) \
+    X(glEnable) X(glDisable) X(glClear) X(glClearColor) X(glViewport) \
+    X(glMatrixMode) X(glLoadIdentity) X(glPushMatrix) X(glPopMatrix) \
+    X(glTranslatef) X(glRotatef) X(glScalef) X(glLoadMatrixf) X(glMultMatrixf) \
+    X(glOrtho) X(glFrustum) X(glCallList) X(glDrawArrays) \
+    X(glPolygonMode) X(glLineWidth) \
+    X(glGetFloatv) X(glGetIntegerv) X(glGetDoublev) X(glGetBooleanv) \
+    X(glReadPixels) X(glFinish) \
+    X(gluLookAt) X(gluPerspective) X(gluNewQuadric) X(gluDeleteQuadric) \
+    X(gluQuadricDrawStyle) X(gluCylinder) \
+    X(glutSolidCube) X(glutSolidCone) X(glutSolidSphere) \
+    X(glutSwapBuffers) X(glutPostRedisplay)
+
+/**
+ * Labels for the intercepted entry points
+ */
+typedef enum {
+#define CGV_GL_STATS_ENUM(name) CGV_CALL_##name,
+    CGV_GL_STATS_CALLS(CGV_GL_STATS_ENUM)
+#undef CGV_GL_STATS_ENUM
+    CGV_CALL_COUNT
+} cgvGLCall;
+
+/**
+ * Counters gathered between two consecutive calls to glutSwapBuffers
+ */
+struct cgvGLFrameStats {
+    unsigned long calls[CGV_CALL_COUNT]; ///< Number of calls to each entry point
+    unsigned long vertices; ///< Vertices submitted, including the ones tessellated by GLU/GLUT
+    unsigned long draw_calls; ///< glBegin blocks, GLU/GLUT solids and vertex array draws
+    int max_depth[3]; ///< High-water mark of the modelview, projection and texture stacks
+};
+
+/**
+ * Synchronizing call (glGet*, glReadPixels, glFinish) found inside a callback.
+ * Calls from the same call site and callback share a record
+ */
+struct cgvGLStall {
+    const char* call; ///< Name of the synchronizing entry point
+    const char* file; ///< Source file of the call site
+    int line; ///< Line of the call site
+    const char* scope; ///< Callback (or hot scope) the call was made from
+    bool hot; ///< Whether the scope is a hot path
+    unsigned long count; ///< Number of calls
+    double total_ms; ///< Accumulated time blocked in the call
+    double max_ms; ///< Longest time blocked in a single call
+};
+
+#define CGV_GL_MAX_STALLS 32 ///< Number of different stall records that are kept
+
+/**
+ * Types of input events whose input-to-photon latency is measured
+ */
+typedef enum {
+    CGV_INPUT_KEYBOARD, ///< glutKeyboardFunc events
+    CGV_INPUT_SPECIAL, ///< glutSpecialFunc events
+    CGV_INPUT_MENU, ///< Menu selections
+    CGV_INPUT_TYPES
+} cgvGLInputType;
+
+#define CGV_GL_MAX_INPUT_EVENTS 64 ///< Input events that can wait for their frame at the same time
+#define CGV_GL_MAX_FENCES 8 ///< Frames whose fence can be pending at the same time
+#define CGV_GL_LATENCY_BUCKETS 10 ///< Buckets of the latency histograms: <1, <2, <4 ... <256, >=256 ms
+
+/**
+ * Input event waiting for the frame that reflects it to be completed by the GPU
+ */
+struct cgvGLInputEvent {
+    int type; ///< cgvGLInputType of the event, -1 if the slot is free
+    double time; ///< Time the event entered its callback, in ms
+    int fence; ///< Fence of the frame that reflects it, -1 if that frame has not been drawn yet
+    unsigned long after; ///< Events the drawn snapshot must have applied to reflect it (0 = any frame)
+};
+
+/**
+ * Input-to-photon latency histogram of one type of event
+ */
+struct cgvGLLatency {
+    unsigned long count; ///< Number of events measured
+    double total_ms; ///< Accumulated latency
+    double max_ms; ///< Longest latency
+    unsigned long buckets[CGV_GL_LATENCY_BUCKETS]; ///< Number of events per latency bucket
+};
+
+#define CGV_GL_MAX_TRACE 65536 ///< Calls kept in the trace of a frame
+
+/**
+ * Call recorded in the trace of a frame
+ */
+struct cgvGLTraceEntry {
+    int call; ///< cgvGLCall of the entry point
+    float time; ///< Time of the call, relative to the first call of the frame, in ms
+};
+
+/**
+ * Objects of this class keep the per-frame counters of the GL interception layer
+ */
+class cgvGLStats {
+private:
+    cgvGLFrameStats current; ///< Counters of the frame being drawn
+    cgvGLFrameStats last; ///< Counters of the last completed frame
+    unsigned long frame = 0; ///< Number of completed frames
+    unsigned long report_every = 1; ///< Print a report every report_every frames (0 = never)
+    int mode = 0; ///< Matrix stack selected with glMatrixMode
+    int depth[3] = { 1, 1, 1 }; ///< Current depth of each matrix stack
+
+    const char* scope = nullptr; ///< Callback being executed, nullptr outside callbacks
+    bool hot = false; ///< Whether the callback being executed is a hot path
+    cgvGLStall stalls[CGV_GL_MAX_STALLS]; ///< Synchronizing calls found inside callbacks
+    int n_stalls = 0; ///< Number of records used in stalls
+    bool hot_stall = false; ///< Whether a synchronizing call has been made from a hot path
+    unsigned long bench_frames = 0; ///< Frames to draw in a benchmark run (0 = no benchmark)
+
+    cgvGLInputEvent events[CGV_GL_MAX_INPUT_EVENTS]; ///< Events whose latency is being measured
+    void* fences[CGV_GL_MAX_FENCES]; ///< GLsync objects inserted after glutSwapBuffers
+    cgvGLLatency latency[CGV_INPUT_TYPES]; ///< Latency histograms per type of event
+    unsigned long dropped_events = 0; ///< Events not measured because all the slots were in use or they were dropped
+    int sync_support = -1; ///< Whether fence sync objects are available (-1 = not checked yet)
+    bool polling = false; ///< Whether a timer is polling the pending fences
+    int last_event = -1; ///< Slot of the last event timestamped, -1 if it is not measured
+    unsigned long drawn_events = 0; ///< Events applied in the snapshot of the frame being drawn
+
+    bool tracing = false; ///< Whether every call is recorded in the trace of the frame
+    cgvGLTraceEntry trace[2][CGV_GL_MAX_TRACE]; ///< Traces of the current and the last frame
+    int trace_current = 0; ///< Trace of the frame being drawn
+    unsigned long trace_length[2] = { 0, 0 }; ///< Calls made in each frame (some may not be kept)
+    double trace_start = 0; ///< Time of the first call of the frame, in ms
+
+    // Implementing the Singleton pattern
+    static cgvGLStats* _instance; ///< Pointer to the singleton object of the class
+    cgvGLStats();
+
+public:
+    static cgvGLStats& getInstance();
+
+    /// Destructor
+    ~cgvGLStats() = default;
+
+    // Methods
+    void count(cgvGLCall call);
+    void add_vertices(unsigned long n);
+    void draw_call();
+    void matrix_mode(GLenum _mode);
+    void push_matrix();
+    void pop_matrix();
+    void end_frame();
+    void print(const cgvGLFrameStats& stats, unsigned long number);
+
+    const char* enter_scope(const char* _scope, bool _hot, bool& previous_hot);
+    void leave_scope(const char* previous, bool previous_hot);
+    void stall(const char* call, const char* file, int line, double ms);
+    void print_stalls();
+
+    void input_event(cgvGLInputType type);
+    void defer_input(unsigned long applied);
+    void drop_input();
+    void draw_input(unsigned long applied);
+    void fence_frame();
+    bool poll_fences();
+    void print_latency();
+
+    void enable_trace();
+    const cgvGLTraceEntry* get_last_trace(unsigned long& length, unsigned long& kept);
+    static const char* call_name(int call);
+
+    const cgvGLFrameStats& get_last_frame();
+    unsigned long get_frame();
+};
+
+/**
+ * Objects of this class mark, while they are alive, the code being executed as a
+ * callback or hot path. Synchronizing calls made inside are reported as stalls
+ */
+class cgvGLScope {
+private:
+    const char* previous; ///< Scope active when this one was entered
+    bool previous_hot; ///< Whether the previous scope was a hot path
+
+public:
+    cgvGLScope(const char* name, bool hot);
+    ~cgvGLScope();
+};
+
+// Counting wrappers, with the same signature as the entry point they replace
+void cgvGL_glBegin(GLenum mode);
+void cgvGL_glEnd();
+void cgvGL_glVertex3f(GLfloat x, GLfloat y, GLfloat z);
+void cgvGL_glColor3f(GLfloat r, GLfloat g, GLfloat b);
+void cgvGL_glMaterialfv(GLenum face, GLenum pname, const GLfloat* params);
+void cgvGL_glLightfv(GLenum light, GLenum pname, const GLfloat* params);
+void cgvGL_glEnable(GLenum cap);
+void cgvGL_glDisable(GLenum cap);
+void cgvGL_glClear(GLbitfield mask);
+void cgvGL_glClearColor(GLclampf r, GLclampf g, GLclampf b, GLclampf a);
+void cgvGL_glViewport(GLint x, GLint y, GLsizei w, GLsizei h);
+void cgvGL_glMatrixMode(GLenum mode);
+void cgvGL_glLoadIdentity();
+void cgvGL_glPushMatrix();
+void cgvGL_glPopMatrix();
+void cgvGL_glTranslatef(GLfloat x, GLfloat y, GLfloat z);
+void cgvGL_glRotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z);
+void cgvGL_glScalef(GLfloat x, GLfloat y, GLfloat z);
+void cgvGL_glLoadMatrixf(const GLfloat* m);
+void cgvGL_glMultMatrixf(const GLfloat* m);
+void cgvGL_glOrtho(GLdouble l, GLdouble r, GLdouble b, GLdouble t, GLdouble n, GLdouble f);
+void cgvGL_glFrustum(GLdouble l, GLdouble r, GLdouble b, GLdouble t, GLdouble n, GLdouble f);
+void cgvGL_glCallList(GLuint list);
+void cgvGL_glDrawArrays(GLenum mode, GLint first, GLsizei count);
+void cgvGL_glPolygonMode(GLenum face, GLenum mode);
+void cgvGL_glLineWidth(GLfloat width);
+void cgvGL_glGetFloatv(GLenum pname, GLfloat* params, const char* file, int line);
+void cgvGL_glGetIntegerv(GLenum pname, GLint* params, const char* file, int line);
+void cgvGL_glGetDoublev(GLenum pname, GLdouble* params, const char* file, int line);
+void cgvGL_glGetBooleanv(GLenum pname, GLboolean* params, const char* file, int line);
+void cgvGL_glReadPixels(GLint x, GLint y, GLsizei w, GLsizei h, GLenum format, GLenum type,
+                        GLvoid* pixels, const char* file, int line);
+void cgvGL_glFinish(const char* file, int line);
+void cgvGL_gluLookAt(GLdouble eyeX, GLdouble eyeY, GLdouble eyeZ,
+                     GLdouble centerX, GLdouble centerY, GLdouble centerZ,
+                     GLdouble upX, GLdouble upY, GLdouble upZ);
+void cgvGL_gluPerspective(GLdouble fovy, GLdouble aspect, GLdouble zNear, GLdouble zFar);
+GLUquadric* cgvGL_gluNewQuadric();
+void cgvGL_gluDeleteQuadric(GLUquadric* quad);
+void cgvGL_gluQuadricDrawStyle(GLUquadric* quad, GLenum draw);
+void cgvGL_gluCylinder(GLUquadric* quad, GLdouble base, GLdouble top, GLdouble height,
+                       GLint slices, GLint stacks);
+void cgvGL_glutSolidCube(GLdouble size);
+void cgvGL_glutSolidCone(GLdouble base, GLdouble height, GLint slices, GLint stacks);
+void cgvGL_glutSolidSphere(GLdouble radius, GLint slices, GLint stacks);
+void cgvGL_glutSwapBuffers();
+void cgvGL_glutPostRedisplay();
+
+// Callback registration wrappers: the callbacks are run inside a cgvGLScope
+void cgvGL_glutDisplayFunc(void (*callback)());
+void cgvGL_glutReshapeFunc(void (*callback)(int, int));
+void cgvGL_glutKeyboardFunc(void (*callback)(unsigned char, int, int));
+void cgvGL_glutSpecialFunc(void (*callback)(int, int, int));
+int cgvGL_glutCreateMenu(void (*callback)(int));
+
+// From here on, every translation unit that includes this header calls the wrappers
+#ifndef CGV_GL_STATS_IMPLEMENTATION
+#define glBegin cgvGL_glBegin
+#define glEnd cgvGL_glEnd
+#define glVertex3f cgvGL_glVertex3f
+#define glColor3f cgvGL_glColor3f
+#define glMaterialfv cgvGL_glMaterialfv
+#define glLightfv cgvGL_glLightfv
+#define glEnable cgvGL_glEnable
+#define glDisable cgvGL_glDisable
+#define glClear cgvGL_glClear
+#define glClearColor cgvGL_glClearColor
+#define glViewport cgvGL_glViewport
+#define glMatrixMode cgvGL_glMatrixMode
+#define glLoadIdentity cgvGL_glLoadIdentity
+#define glPushMatrix cgvGL_glPushMatrix
+#define glPopMatrix cgvGL_glPopMatrix
+#define glTranslatef cgvGL_glTranslatef
+#define glRotatef cgvGL_glRotatef
+#define glScalef cgvGL_glScalef
+#define glLoadMatrixf cgvGL_glLoadMatrixf
+#define glMultMatrixf cgvGL_glMultMatrixf
+#define glOrtho cgvGL_glOrtho
+#define glFrustum cgvGL_glFrustum
+#define glCallList cgvGL_glCallList
+#define glDrawArrays cgvGL_glDrawArrays
+#define glPolygonMode cgvGL_glPolygonMode
+#define glLineWidth cgvGL_glLineWidth
+#define glGetFloatv(pname, params) cgvGL_glGetFloatv(pname, params, __FILE__, __LINE__)
+#define glGetIntegerv(pname, params) cgvGL_glGetIntegerv(pname, params, __FILE__, __LINE__)
+#define glGetDoublev(pname, params) cgvGL_glGetDoublev(pname, params, __FILE__, __LINE__)
+#define glGetBooleanv(pname, params) cgvGL_glGetBooleanv(pname, params, __FILE__, __LINE__)
+#define glReadPixels(x, y, w, h, format, type, pixels) \
+    cgvGL_glReadPixels(x, y, w, h, format, type, pixels, __FILE__, __LINE__)
+#define glFinish() cgvGL_glFinish(__FILE__, __LINE__)
+#define gluLookAt cgvGL_gluLookAt
+#define gluPerspective cgvGL_gluPerspective
+#define gluNewQuadric cgvGL_gluNewQuadric
+#define gluDeleteQuadric cgvGL_gluDeleteQuadric
+#define gluQuadricDrawStyle cgvGL_gluQuadricDrawStyle
+#define gluCylinder cgvGL_gluCylinder
+#define glutSolidCube cgvGL_glutSolidCube
+#define glutSolidCone cgvGL_glutSolidCone
+#define glutSolidSphere cgvGL_glutSolidSphere
+#define glutSwapBuffers cgvGL_glutSwapBuffers
+#define glutPostRedisplay cgvGL_glutPostRedisplay
+#define glutDisplayFunc cgvGL_glutDisplayFunc
+#define glutReshapeFunc cgvGL_glutReshapeFunc
+#define glutKeyboardFunc cgvGL_glutKeyboardFunc
+#define glutSpecialFunc cgvGL_glutSpecialFunc
+#define glutCreateMenu cgvGL_glutCreateMenu
+#endif   // CGV_GL_STATS_IMPLEMENTATION
+
+#endif   // CGV_GL_STATS
+
+// Marks the rest of the enclosing block as a hot path: a synchronizing GL call
+// made inside makes a benchmark run fail
+#ifdef CGV_GL_STATS
+#define CGV_GL_HOT_SCOPE(name) cgvGLScope cgv_gl_hot_scope(name, true)
+#else
+#define CGV_GL_HOT_SCOPE(name)
+#endif   // CGV_GL_STATS
+
+// With --threaded-input the event of a callback is reflected by the first frame drawn
+// from a snapshot that has applied it, not by the next frame swapped
+#ifdef CGV_GL_STATS
+#define CGV_GL_INPUT_AFTER(applied) cgvGLStats::getInstance().defer_input(applied)
+#define CGV_GL_INPUT_DROPPED() cgvGLStats::getInstance().drop_input()
+#define CGV_GL_INPUT_DRAWN(applied) cgvGLStats::getInstance().draw_input(applied)
+#else
+#define CGV_GL_INPUT_AFTER(applied)
+#define CGV_GL_INPUT_DROPPED()
+#define CGV_GL_INPUT_DRAWN(applied)
+#endif   // CGV_GL_STATS
+
+#endif   // __CGVGLSTATS
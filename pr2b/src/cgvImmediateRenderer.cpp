@@ -0,0 +1,250 @@
+#include "cgvImmediateRenderer.h"
+
+/**
+* Method to query the name of the backend
+* @return The name accepted by cgvRenderer::create
+*/
+const char* cgvImmediateRenderer::get_name()
+{ return "immediate";
+}
+
+/**
+* Enables the depth test and the normalization of the normals
+* @retval true Always
+*/
+bool cgvImmediateRenderer::initialize()
+{ glEnable(GL_DEPTH_TEST); // enable z-buffer surface hiding
+    glEnable(GL_NORMALIZE); // normalize normal vectors for lighting calculations
+    return true;
+}
+
+/**
+* Loads the projection and view matrices of the camera, and culls against it
+* @param projection Projection matrix
+* @param _view View matrix
+*/
+void cgvImmediateRenderer::set_camera(const cgvMat4& projection, const cgvMat4& _view)
+{ cgvRenderer::set_camera(projection, _view);
+    load_camera(projection, _view);
+}
+
+/**
+* Loads the projection and view matrices of a camera
+* @param projection Projection matrix
+* @param _view View matrix
+*/
+void cgvImmediateRenderer::load_camera(const cgvMat4& projection, const cgvMat4& _view)
+{ view = _view;
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadMatrixf(projection.data());
+    glMatrixMode(GL_MODELVIEW);
+    glLoadMatrixf(view.data());
+}
+
+/**
+* Sets the position of the point light (GL_LIGHT0)
+* @param position Position of the light, in world coordinates
+*/
+void cgvImmediateRenderer::set_light(const cgvVec4& position)
+{ light = position;
+    has_light = true;
+}
+
+/**
+* Starts a new frame: loads the view matrix and places the light with it
+*/
+void cgvImmediateRenderer::begin_frame()
+{ draw_calls = 0;
+    culled_instances = 0;
+    submissions.clear();
+
+    glMatrixMode(GL_MODELVIEW);
+    glLoadMatrixf(view.data());
+    place_light();
+}
+
+/**
+* Draws a mesh right away, or keeps it for end_frame if the frame is drawn in
+* several views. Meshes outside the views are skipped
+* @param mesh Mesh to draw
+* @param material Appearance of the mesh
+* @param transform Modeling matrix of the mesh
+*/
+void cgvImmediateRenderer::submit(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& transform)
+{ cgvViewMask visible = cull(get_bounds(mesh, transform));
+    if (!visible)
+    { return;
+    }
+    if (view_count > 1)
+    { submissions.push_back({ mesh, material, transform, visible });
+        return;
+    }
+    draw_submission(mesh, material, transform);
+}
+
+/**
+* Finishes the frame. If it is drawn in several views, draws the meshes kept by
+* submit in each of them, with its viewport, camera and light; each view only
+* draws the meshes visible in it
+* @return The number of draw calls issued since begin_frame
+*/
+unsigned long cgvImmediateRenderer::end_frame()
+{ if (view_count > 1)
+    { for (int i = 0; i < view_count; i++)
+        { const cgvView& current = views[i];
+            glViewport(current.x, current.y, current.width, current.height);
+            load_camera(current.projection, current.view);
+            place_light();
+            for (const cgvSubmission& submission: submissions)
+            { if (submission.visible & (1u << i))
+                { draw_submission(submission.mesh, submission.material, submission.transform);
+                }
+            }
+        }
+    }
+    return draw_calls;
+}
+
+/**
+* Places the point light, if the scene has set one, with the modelview matrix
+* holding the view matrix
+*/
+void cgvImmediateRenderer::place_light()
+{ if (has_light)
+    { glLightfv(GL_LIGHT0, GL_POSITION, light.data());
+        glEnable(GL_LIGHT0);
+    }
+}
+
+/**
+* Sets the fixed-function state of a material, skipping the values that
+* have not changed since the last mesh
+* @param material Material to apply
+*/
+void cgvImmediateRenderer::apply_material(const cgvMaterial& material)
+{ if (lighting != (int) material.lit)
+    { if (material.lit)
+        { glEnable(GL_LIGHTING);
+        }
+        else
+        { glDisable(GL_LIGHTING);
+        }
+        lighting = material.lit;
+    }
+
+    if (material.lit)
+    { GLfloat emission[] = { material.color[0], material.color[1], material.color[2], 1 };
+        glMaterialfv(GL_FRONT, GL_EMISSION, emission);
+    }
+    else
+    { glColor3f(material.color[0], material.color[1], material.color[2]);
+    }
+
+    if (polygon_mode != material.polygon_mode)
+    { glPolygonMode(GL_FRONT_AND_BACK, material.polygon_mode);
+        polygon_mode = material.polygon_mode;
+    }
+    if (line_width != material.line_width)
+    { glLineWidth(material.line_width);
+        line_width = material.line_width;
+    }
+}
+
+/**
+* Draws a mesh with its material and transform
+* @param mesh Mesh to draw
+* @param material Appearance of the mesh
+* @param transform Modeling matrix of the mesh
+*/
+void cgvImmediateRenderer::draw_submission(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& transform)
+{ apply_material(material);
+
+    glPushMatrix();
+    glMultMatrixf(transform.data());
+    draw_mesh(mesh);
+    glPopMatrix();
+
+    draw_calls++;
+}
+
+/**
+* Draws a unit mesh with the fixed-function pipeline
+* @param mesh Mesh to draw
+*/
+void cgvImmediateRenderer::draw_mesh(cgvMesh mesh)
+{ static const GLfloat red[] = { 1, 0, 0, 1 };
+    static const GLfloat green[] = { 0, 1, 0, 1 };
+    static const GLfloat blue[] = { 0, 0, 1, 1 };
+
+    switch (mesh)
+    { case CGV_MESH_CUBE:
+            glutSolidCube(1);
+            break;
+        case CGV_MESH_SPHERE:
+            glutSolidSphere(1, 32, 32);
+            break;
+        case CGV_MESH_CONE:
+            glutSolidCone(1, 1, 32, 32);
+            break;
+        case CGV_MESH_CYLINDER:
+            draw_vertices(get_cylinder(CGV_CYLINDER_SLICES, CGV_CYLINDER_STACKS).vertices);
+            break;
+        case CGV_MESH_AXES:
+            // the color is set both ways, so the axes look the same lit or not; the
+            // normal is the one of the tessellated axes, not whatever the last mesh left
+            glNormal3f(0, 0, 1);
+            glBegin(GL_LINES);
+            glMaterialfv(GL_FRONT, GL_EMISSION, red);
+            glColor3f(1, 0, 0);
+            glVertex3f(1, 0, 0);
+            glVertex3f(-1, 0, 0);
+
+            glMaterialfv(GL_FRONT, GL_EMISSION, green);
+            glColor3f(0, 1, 0);
+            glVertex3f(0, 1, 0);
+            glVertex3f(0, -1, 0);
+
+            glMaterialfv(GL_FRONT, GL_EMISSION, blue);
+            glColor3f(0, 0, 1);
+            glVertex3f(0, 0, 1);
+            glVertex3f(0, 0, -1);
+            glEnd();
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+* Method to access the tessellation of a cylinder, which is generated the first
+* time it is asked for
+* @param slices Subdivisions around the axis
+* @param stacks Subdivisions along the axis
+* @return The open tube of radius 1 from z = 0 to z = 1
+*/
+const cgvQuadricMesh& cgvImmediateRenderer::get_cylinder(int slices, int stacks)
+{ for (const cgvQuadricMesh& cylinder: cylinders)
+    { if (cylinder.slices == slices && cylinder.stacks == stacks)
+        { return cylinder;
+        }
+    }
+
+    cylinders.push_back({ slices, stacks, {} });
+    tessellate_cylinder(slices, stacks, cylinders.back().vertices);
+    return cylinders.back();
+}
+
+/**
+* Draws triangles from a vertex array, with their positions and normals
+* @param vertices Vertices of the triangles, three per triangle
+*/
+void cgvImmediateRenderer::draw_vertices(const std::vector<cgvVertex>& vertices)
+{ glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(cgvVertex), vertices[0].position);
+    glNormalPointer(GL_FLOAT, sizeof(cgvVertex), vertices[0].normal);
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei) vertices.size());
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
@@ -0,0 +1,81 @@
+#ifndef __CGVIMMEDIATERENDERER
+#define __CGVIMMEDIATERENDERER
+
+#include <vector>
+
+#include "cgvRenderer.h"
+
+/**
+ * Tessellation of a GLU quadric, generated the first time it is drawn and kept
+ * for the next draws
+ */
+struct cgvQuadricMesh {
+    int slices; ///< Subdivisions around the axis
+    int stacks; ///< Subdivisions along the axis
+    std::vector<cgvVertex> vertices; ///< Triangles of the quadric, of radius 1
+};
+
+/**
+ * Mesh submitted while the frame is drawn in several views, kept until
+ * end_frame draws it in each of them
+ */
+struct cgvSubmission {
+    cgvMesh mesh; ///< Mesh to draw
+    cgvMaterial material; ///< Appearance of the mesh
+    cgvMat4 transform; ///< Modeling matrix of the mesh
+    cgvViewMask visible; ///< Views the mesh is drawn in
+};
+
+/**
+ * Renderer that submits every mesh with the legacy fixed-function pipeline:
+ * glBegin/glEnd and GLUT solids, with the transforms loaded in the modelview
+ * matrix and the materials set with glMaterialfv or glColor. The GLU quadrics
+ * are tessellated once per number of slices and stacks, as gluCylinder would,
+ * and drawn from those vertex arrays; the radius comes with the transform. With
+ * several views, the meshes are kept when submitted and drawn in every view by
+ * end_frame, so the scene is still traversed once
+ */
+class cgvImmediateRenderer: public cgvRenderer {
+protected:
+    cgvMat4 view; ///< View matrix of the camera
+    cgvVec4 light; ///< Position of the point light, in world coordinates
+    bool has_light = false; ///< Whether the scene has set a point light
+    std::vector<cgvQuadricMesh> cylinders; ///< Cylinders tessellated so far
+    std::vector<cgvSubmission> submissions; ///< Meshes of the frame, if drawn in several views; keeps its capacity
+    unsigned long draw_calls = 0; ///< Draw calls issued since begin_frame
+
+    // Fixed-function state, to skip redundant changes
+    int lighting = -1; ///< Whether GL_LIGHTING is enabled (-1 = unknown)
+    GLenum polygon_mode = 0; ///< Current polygon mode (0 = unknown)
+    GLfloat line_width = 0; ///< Current line width (0 = unknown)
+
+public:
+    /// Default constructor
+    cgvImmediateRenderer() = default;
+
+    /// Destructor
+    ~cgvImmediateRenderer() override = default;
+
+    // Methods
+    const char* get_name() override;
+    bool initialize() override;
+
+    void set_camera(const cgvMat4& projection, const cgvMat4& _view) override;
+    void set_light(const cgvVec4& position) override;
+
+    void begin_frame() override;
+    void submit(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& transform) override;
+    unsigned long end_frame() override;
+
+protected:
+    void load_camera(const cgvMat4& projection, const cgvMat4& _view);
+    void place_light();
+    void apply_material(const cgvMaterial& material);
+    void draw_submission(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& transform);
+    virtual void draw_mesh(cgvMesh mesh);
+
+    const cgvQuadricMesh& get_cylinder(int slices, int stacks);
+    static void draw_vertices(const std::vector<cgvVertex>& vertices);
+};
+
+#endif   // __CGVIMMEDIATERENDERER
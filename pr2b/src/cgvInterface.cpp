@@ -0,0 +1,337 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdio.h>
+#include "iostream"
+#include "cgvInterface.h"
+#include "cgvGLCore.h"
+#include "cgvDynamicResolution.h"
+#include "cgvFlightRecorder.h"
+#include "cgvFrameArena.h"
+#include "cgvMetrics.h"
+
+ cgvInterface interface; // Callbacks must be static and this object is required to access from
+
+// Constructor methods -----------------------------------
+
+cgvInterface::cgvInterface() :pos(1), windowChange(false) {}
+
+cgvInterface::~cgvInterface() {}
+
+// Public methods ----------------------------------------
+
+void cgvInterface::create_world(void) {
+    // crear c·maras
+    p0 = cgvVec3(3.0, 2.0, 4);
+    r = cgvVec3(0, 0, 0);
+    V = cgvVec3(0, 1.0, 0);
+
+    interface.camera.set(CGV_PARALLEL, p0, r, V,
+                         -1 * 3, 1 * 3, -1 * 3, 1 * 3, 1, 200);
+
+    //perspective parameters
+    interface.camera.set_perspective(60.0, 1.0);
+
+    // preset views, with their view matrices
+    presets[0] = cgvCameraPreset(p0, r, V); //Basic
+    presets[1] = cgvCameraPreset(cgvVec3(0, 5, 0), cgvVec3(0, 0, 0), cgvVec3(1, 0, 0)); //Floor
+    presets[2] = cgvCameraPreset(cgvVec3(5, 0, 0), cgvVec3(0, 0, 0), cgvVec3(0, 1, 0)); //Front view
+    presets[3] = cgvCameraPreset(cgvVec3(0, 0, 5), cgvVec3(0, 0, 0), cgvVec3(0, 1, 0)); //Profile
+}
+
+void cgvInterface::configure_environment(int argc, char** argv,
+                                         int _window_width, int _window_height,
+                                         int _pos_X, int _pos_Y,
+                                         std::string _title) {
+    // initialize interface variables
+    window_width = _window_width;
+    window_height = _window_height;
+
+    // the renderer backend is chosen with --renderer=<name>; the core backend needs a core-profile context.
+    // With --headless there is no window, and the scene is drawn to a file --frames=<n> times
+    const char* renderer_name = "immediate";
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--renderer=", 11) == 0) {
+            renderer_name = argv[i] + 11;
+        }
+        else if (strcmp(argv[i], "--headless") == 0) {
+            interface.headless = true;
+        }
+        else if (strncmp(argv[i], "--frames=", 9) == 0 && atoi(argv[i] + 9) > 0) {
+            interface.headless_frames = atoi(argv[i] + 9);
+        }
+        else {
+            fprintf(stderr, "Unknown option %s (use --renderer=<name>, --headless or --frames=<n>)\n", argv[i]);
+        }
+    }
+
+    interface.renderer = cgvRenderer::create(renderer_name);
+    if (!interface.renderer) {
+        fprintf(stderr, "Unknown renderer %s (available: %s)\n", renderer_name, cgvRenderer::get_names());
+        exit(1);
+    }
+    if (interface.headless && interface.renderer->requires_window()) {
+        fprintf(stderr, "The %s renderer needs a window; use --renderer=software with --headless\n",
+                interface.renderer->get_name());
+        exit(1);
+    }
+
+    // initialization of the display window
+    if (!interface.headless) {
+        glutInit(&argc, argv);
+        if (interface.renderer->requires_core_profile()) {
+            cgvGLCore::request_context(GLUT_RGB | GLUT_DOUBLE | GLUT_DEPTH);
+        }
+        else {
+            glutInitDisplayMode(GLUT_RGB | GLUT_DOUBLE | GLUT_DEPTH);
+        }
+        glutInitWindowSize(_window_width, _window_height);
+        glutInitWindowPosition(_pos_X, _pos_Y);
+        glutCreateWindow(_title.c_str());
+    }
+
+    // the renderer enables z-buffering, and the lighting for the materials that are lit
+    if (!interface.renderer->initialize()) {
+        fprintf(stderr, "The %s renderer is not available\n", interface.renderer->get_name());
+        exit(1);
+    }
+    interface.renderer->set_clear_color(1.0, 1.0, 1.0); // Sets the window background color
+    interface.scene.set_renderer(interface.renderer);
+    fprintf(stderr, "[renderer] drawing with the %s renderer\n", interface.renderer->get_name());
+
+    cgvMetrics::getInstance().open("pr2b"); // live metrics, if CGV_METRICS_SHM is set
+
+    create_world(); // Creates the world to be displayed in the window
+}
+
+void cgvInterface::start_display_loop() {
+    if (interface.headless) {
+        render_headless();
+        return;
+    }
+    glutMainLoop(); // start the OpenGL display loop
+}
+
+// Draws the scene without a window as many frames as --frames asks, and saves the last one to pr2b_scene.ppm in the
+// working directory. If a frame after the warm-up of CGV_ARENA_CHECK allocates from the heap, the program exits with 1
+void cgvInterface::render_headless() {
+    set_glutReshapeFunc(interface.window_width, interface.window_height);
+    for (int frame = 0; frame < interface.headless_frames; frame++) {
+        set_glutDisplayFunc();
+    }
+
+    if (interface.renderer->save_frame("pr2b_scene.ppm")) {
+        printf("pr2b_scene.ppm\n");
+    }
+    else {
+        fprintf(stderr, "Could not write pr2b_scene.ppm\n");
+    }
+
+    unsigned long allocations = cgvFrameArena::getInstance().get_checked_allocations();
+    if (allocations > 0) {
+        fprintf(stderr, "[arena] %lu heap allocations after the warm-up frames\n", allocations);
+        exit(1);
+    }
+}
+
+void cgvInterface::set_glutKeyboardFunc(unsigned char key, int x, int y) {
+    cgvFlightRecorder::getInstance().input("set_glutKeyboardFunc", key, x, y);
+
+    /* IMPORTANT: When implementing this method, you must appropriately change the state of the application objects, but do not make direct calls to OpenGL functions */
+
+    switch (key) {
+        case 'p': // change the projection type from parallel to perspective and vice versa
+            if (interface.camera.type == CGV_PARALLEL) { // Perspective mode
+                    interface.camera.set(CGV_PERSPECTIVE,
+                    interface.camera.P0,
+                    interface.camera.r,
+                    interface.camera.V,
+                    interface.camera.angle,
+                    interface.camera.aspect,
+                    interface.camera.znear,
+                    interface.camera.zfar
+                );
+            }
+            else {
+                interface.camera.set(CGV_PARALLEL,
+                                    interface.camera.P0,
+                                    interface.camera.r,
+                                    interface.camera.V,
+                                    interface.camera.xwmin,
+                                    interface.camera.xwmax,
+                                    interface.camera.ywmin,
+                                    interface.camera.ywmax,
+                                    interface.camera.znear,
+                                    interface.camera.zfar
+                );
+            }
+            interface.camera.apply(interface.renderer);
+            break;
+        case 'P': // Change the projection type from parallel to perspective and vice versa
+            if (interface.camera.type == CGV_PARALLEL) {
+                //Perspective mode
+                interface.camera.set(CGV_PERSPECTIVE,
+                                    interface.camera.P0,
+                                    interface.camera.r,
+                                    interface.camera.V,
+                                    interface.camera.angle,
+                                    interface.camera.aspect,
+                                    interface.camera.znear,
+                                    interface.camera.zfar
+                );
+            }
+            else {
+                interface.camera.set(CGV_PARALLEL,
+                                    interface.camera.P0,
+                                    interface.camera.r,
+                                    interface.camera.V,
+                                    interface.camera.xwmin,
+                                    interface.camera.xwmax,
+                                    interface.camera.ywmin,
+                                    interface.camera.ywmax,
+                                    interface.camera.znear,
+                                    interface.camera.zfar
+                );
+            }
+            interface.camera.apply(interface.renderer);
+            break;
+        case 'v': // Change the camera position to display plan, profile, elevation, or perspective views
+            interface.update_camera_view(++interface.pos % 4);
+            break;
+        case 'V': // Change the camera position to display plan, profile, elevation, or perspective views
+            interface.update_camera_view(++interface.pos % 4);
+            break;
+        case '+': // zoom in
+            interface.camera.zoom(0.95);
+            interface.camera.apply(interface.renderer);
+            break;
+        case '-': // zoom out
+            interface.camera.zoom(1.05);
+            interface.camera.apply(interface.renderer);
+            break;
+        case 'n': // increase the distance of the near plane
+            interface.camera.set_znear(interface.camera.znear + 0.2);
+            interface.camera.apply(interface.renderer);
+            break;
+        case 'N': // decrease the distance of the near plane
+            interface.camera.set_znear(interface.camera.znear - 0.2);
+            interface.camera.apply(interface.renderer);
+            break;
+        case '4': // split the window into four views
+            interface.windowChange = !interface.windowChange;
+            interface.update_camera_view(0);
+            break;
+        case 'e': // activate/deactivate the display of the axes
+            interface.scene.set_ejes(interface.scene.get_ejes() ? false : true);
+            break;
+        case 27: // escape key to EXIT
+            exit(1);
+    }
+    glutPostRedisplay(); // refreshes the contents of the viewport and redraws the scene
+}
+
+void cgvInterface::set_glutReshapeFunc(int w, int h) {
+    // Size the viewport to the new window width and height
+    // Save the new viewport values
+    interface.set_window_width(w);
+    interface.set_window_height(h);
+
+    // Set the camera and projection parameters
+    interface.camera.apply(interface.renderer);
+}
+
+void cgvInterface::set_glutDisplayFunc(){ // clear the window and the z-buffer
+    auto start = std::chrono::steady_clock::now();
+    interface.scene.reset_counts();
+
+    cgvFlightRecorder& recorder = cgvFlightRecorder::getInstance();
+    recorder.begin_frame();
+    recorder.value("camera.type", interface.camera.type);
+    recorder.value("camera.P0.x", interface.camera.P0[X]);
+    recorder.value("camera.P0.y", interface.camera.P0[Y]);
+    recorder.value("camera.P0.z", interface.camera.P0[Z]);
+    recorder.value("camera.znear", interface.camera.znear);
+    recorder.value("camera.zfar", interface.camera.zfar);
+    recorder.value("pos", interface.pos);
+    recorder.value("windowChange", interface.windowChange);
+
+    interface.renderer->clear();
+
+    // set the views: the whole window, or the four camera views of the split window
+    int width = interface.get_window_width(), height = interface.get_window_height();
+    cgvView views[CGV_MAX_VIEWS];
+    int view_count = 1;
+    if (!interface.windowChange) {
+        views[0].x = 0;
+        views[0].y = 0;
+        views[0].width = width;
+        views[0].height = height;
+        interface.camera.get_matrices(views[0].projection, views[0].view);
+    }
+    else {
+        // top left, top right, bottom left and bottom right
+        GLint corners[4][2] = { { 0, height / 2 }, { width / 2, height / 2 }, { 0, 0 }, { width / 2, 0 } };
+        for (int i = 0; i < 4; i++) {
+            views[i].x = corners[i][0];
+            views[i].y = corners[i][1];
+            views[i].width = width / 2;
+            views[i].height = height / 2;
+            interface.set_camera_view(i);
+            interface.camera.get_matrices(views[i].projection, views[i].view);
+        }
+        view_count = 4;
+    }
+    interface.renderer->set_views(views, view_count);
+
+    // display the scene once, for all the views
+    interface.scene.display();
+
+    // refresh the window
+    if (!interface.headless) {
+        interface.renderer->present();
+    }
+    recorder.value("streamed_bytes", interface.renderer->get_streamed_bytes());
+    recorder.value("stream_waits", interface.renderer->get_stream_waits());
+    recorder.value("culled_instances", interface.renderer->get_culled_instances());
+
+    std::chrono::duration<double, std::milli> frame_time = std::chrono::steady_clock::now() - start;
+
+    // the control loop of the dynamic resolution sets the scale of the next frames
+    cgvDynamicResolution& resolution = cgvDynamicResolution::getInstance();
+    GLfloat scale = interface.renderer->get_resolution_scale();
+    cgvResolutionStep step = resolution.update(frame_time.count());
+    if (step != CGV_RESOLUTION_HOLD) {
+        interface.renderer->set_resolution_scale(resolution.get_scale());
+    }
+    recorder.value("resolution_scale", scale);
+
+    cgvMetrics::getInstance().set_counts(interface.scene.get_draw_calls(), interface.scene.get_instances(),
+                                         interface.renderer->get_culled_instances());
+    cgvMetrics::getInstance().set_resolution(scale, resolution.get_target_ms(), step);
+    cgvMetrics::getInstance().end_frame(frame_time.count());
+
+    // the buffers have been swapped: the data of the frame is no longer needed
+    cgvFrameArena& arena = cgvFrameArena::getInstance();
+    recorder.value("arena_bytes", arena.get_used());
+    recorder.value("heap_allocations", arena.get_frame_allocations());
+    arena.reset();
+    recorder.end_frame();
+}
+
+void cgvInterface::initialize_callbacks()  {
+    if (interface.headless) {
+        return; // there is no window to receive events
+    }
+    glutKeyboardFunc(set_glutKeyboardFunc);
+    glutReshapeFunc(set_glutReshapeFunc);
+    glutDisplayFunc(set_glutDisplayFunc);
+}
+
+void cgvInterface::update_camera_view(int pos) {
+    set_camera_view(pos);
+    interface.camera.apply(interface.renderer);
+}
+
+void cgvInterface::set_camera_view(int pos) {
+    interface.camera.set(interface.presets[pos]);
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#ifndef __CGVLIGHTCLUSTERS
+#define __CGVLIGHTCLUSTERS
+
+#include <vector>
+
+#include "cgvGLCore.h"
+#include "cgvRenderer.h"
+
+#define CGV_CLUSTERS_X 16 ///< Clusters across the viewport of each view
+#define CGV_CLUSTERS_Y 16 ///< Clusters up the viewport of each view
+#define CGV_CLUSTERS_Z 24 ///< Depth slices of the frustum of each view
+#define CGV_CLUSTERS_BINDING 2 ///< Uniform buffer binding point of the cluster grid
+#define CGV_CLUSTER_TEXTURE_UNIT 0 ///< First of the three texture units of the light data
+
+/**
+ * Contents of the uniform buffer that describes the cluster grid to the
+ * shaders (std140 layout)
+ */
+struct cgvClusterGrid {
+    GLfloat depth_ranges[CGV_MAX_VIEWS][4]; ///< Near and far depth of each view, 1 if perspective, log(far / near)
+    GLfloat viewports[CGV_MAX_VIEWS][4]; ///< Viewport of each view, in the pixels drawn to
+    GLint size[4]; ///< Clusters along X, Y and Z, and lights
+};
+
+/**
+ * Local point lights binned into clusters, for shading with many lights: the
+ * frustum of each view is split into CGV_CLUSTERS_X by CGV_CLUSTERS_Y tiles of
+ * its viewport and CGV_CLUSTERS_Z depth slices (exponential with perspective
+ * projections, even with parallel ones), and each cluster holds the lights
+ * whose sphere of influence overlaps its bounds. A fragment only loops over the
+ * lights of its cluster, so its cost follows the lights around it instead of
+ * all the lights of the scene. The lights are binned on the CPU, only when they
+ * or the views change, and reach the shaders through three texture buffers:
+ * the lights, the range of light indices of each cluster, and the indices
+ */
+class cgvLightClusters {
+private:
+    GLuint grid_buffer = 0; ///< Uniform buffer with the cluster grid
+    GLuint buffers[3] = {}; ///< Buffers of the lights, the cluster ranges and the light indices
+    GLuint textures[3] = {}; ///< Texture buffers of them
+    GLint max_texels = 0; ///< Largest texture buffer of the context
+
+    cgvClusterGrid grid = {}; ///< Copy of the uniform buffer
+    std::vector<cgvPointLight> lights; ///< Lights to bin
+    bool lights_changed = false; ///< Whether the lights have changed since they were binned
+    cgvView binned_views[CGV_MAX_VIEWS] = {}; ///< Views the lights were binned for
+    int binned_count = 0; ///< Number of them
+
+    std::vector<GLfloat> light_data; ///< Position and radius, and color of each light
+    std::vector<GLuint> ranges; ///< First index and number of lights of each cluster
+    std::vector<GLuint> indices; ///< Lights of each cluster, cluster after cluster
+    std::vector<GLint> bounds; ///< Clusters overlapped by each light in a view: X, Y and Z ranges
+    bool truncated = false; ///< Whether the indices have been cut to max_texels
+
+public:
+    /// Default constructor. The buffers are created by initialize
+    cgvLightClusters() = default;
+
+    /// Destructor
+    ~cgvLightClusters() = default;
+
+    cgvLightClusters(const cgvLightClusters&) = delete;
+    cgvLightClusters& operator=(const cgvLightClusters&) = delete;
+
+    // Methods
+    void initialize(); // once the core entry points are loaded
+    void set_lights(const cgvPointLight* _lights, int count);
+    int get_lights();
+    void update(const cgvView* views, int count); // bins the lights if they or the views have changed
+    void bind(); // the buffers, for the next draws
+
+    static void set_bindings(GLuint program); // of its uniform block and samplers
+
+private:
+    void bin(int view, const cgvView& v);
+};
+
+#endif   // __CGVLIGHTCLUSTERS
@@ -0,0 +1,500 @@
+#ifndef __CGVMATH
+#define __CGVMATH
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CGV_MATH_SSE2
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define CGV_EPSILON 0.000001 // for comparisons with 0
+
+#ifndef __ENUM_XYZ
+#define __ENUM_XYZ
+
+/**
+ * Labels for the coordinates of the points/vectors
+ */
+enum {
+    X, ///< X coordinate
+    Y, ///< Y coordinate
+    Z, ///< Z coordinate
+    W  ///< W coordinate
+};
+#endif
+
+/**
+ * Point or vector in 3D. Trivially copyable, and its constructors and operators
+ * can be evaluated at compile time
+ */
+struct cgvVec3 {
+    float c[3]; ///< Components x, y, z
+
+    /// Default constructor: the origin
+    constexpr cgvVec3(): c{ 0, 0, 0 } {}
+    /// Constructor from the components
+    constexpr cgvVec3(float x, float y, float z): c{ x, y, z } {}
+
+    /// Write/read access to a component; use X, Y or Z as index
+    float& operator[](int idx) { return c[idx]; }
+    /// Read access to a component
+    constexpr float operator[](int idx) const { return c[idx]; }
+
+    /// C-like array of the components
+    float* data() { return c; }
+    const float* data() const { return c; }
+};
+
+constexpr cgvVec3 operator+(const cgvVec3& a, const cgvVec3& b)
+{ return cgvVec3(a.c[0] + b.c[0], a.c[1] + b.c[1], a.c[2] + b.c[2]);
+}
+
+constexpr cgvVec3 operator-(const cgvVec3& a, const cgvVec3& b)
+{ return cgvVec3(a.c[0] - b.c[0], a.c[1] - b.c[1], a.c[2] - b.c[2]);
+}
+
+constexpr cgvVec3 operator-(const cgvVec3& a)
+{ return cgvVec3(-a.c[0], -a.c[1], -a.c[2]);
+}
+
+constexpr cgvVec3 operator*(const cgvVec3& a, float s)
+{ return cgvVec3(a.c[0] * s, a.c[1] * s, a.c[2] * s);
+}
+
+constexpr cgvVec3 operator*(float s, const cgvVec3& a)
+{ return a * s;
+}
+
+inline cgvVec3& operator+=(cgvVec3& a, const cgvVec3& b)
+{ a = a + b;
+    return a;
+}
+
+/// Dot product
+constexpr float dot(const cgvVec3& a, const cgvVec3& b)
+{ return a.c[0] * b.c[0] + a.c[1] * b.c[1] + a.c[2] * b.c[2];
+}
+
+/// Cross product a x b
+constexpr cgvVec3 cross(const cgvVec3& a, const cgvVec3& b)
+{ return cgvVec3(a.c[1] * b.c[2] - a.c[2] * b.c[1],
+                   a.c[2] * b.c[0] - a.c[0] * b.c[2],
+                   a.c[0] * b.c[1] - a.c[1] * b.c[0]);
+}
+
+/// Euclidean length
+inline float length(const cgvVec3& a)
+{ return sqrtf(dot(a, a));
+}
+
+/// Vector with the same direction and length 1; the zero vector stays as it is
+inline cgvVec3 normalize(const cgvVec3& a)
+{ float l = length(a);
+    return l > 0 ? a * (1 / l) : a;
+}
+
+/// Whether two points/vectors are equal, component by component, up to a tolerance
+inline bool near_equal(const cgvVec3& a, const cgvVec3& b, float epsilon = CGV_EPSILON)
+{ return fabsf(a.c[0] - b.c[0]) < epsilon && fabsf(a.c[1] - b.c[1]) < epsilon
+           && fabsf(a.c[2] - b.c[2]) < epsilon;
+}
+
+/**
+ * Point or vector in homogeneous coordinates, aligned so it loads into one SSE
+ * register
+ */
+struct alignas(16) cgvVec4 {
+    float c[4]; ///< Components x, y, z, w
+
+    /// Default constructor: the origin, with w = 1
+    constexpr cgvVec4(): c{ 0, 0, 0, 1 } {}
+    /// Constructor from the components
+    constexpr cgvVec4(float x, float y, float z, float w = 1): c{ x, y, z, w } {}
+    /// Constructor from a 3D point/vector
+    constexpr cgvVec4(const cgvVec3& p, float w = 1): c{ p.c[0], p.c[1], p.c[2], w } {}
+
+    /// Write/read access to a component; use X, Y, Z or W as index
+    float& operator[](int idx) { return c[idx]; }
+    /// Read access to a component
+    constexpr float operator[](int idx) const { return c[idx]; }
+
+    /// x, y and z, without w
+    constexpr cgvVec3 xyz() const { return cgvVec3(c[0], c[1], c[2]); }
+
+    /// C-like array of the components
+    float* data() { return c; }
+    const float* data() const { return c; }
+};
+
+inline cgvVec4 operator+(const cgvVec4& a, const cgvVec4& b)
+{ cgvVec4 r;
+#ifdef CGV_MATH_SSE2
+    _mm_store_ps(r.c, _mm_add_ps(_mm_load_ps(a.c), _mm_load_ps(b.c)));
+#else
+    for (int i = 0; i < 4; i++)
+    { r.c[i] = a.c[i] + b.c[i];
+    }
+#endif
+    return r;
+}
+
+inline cgvVec4 operator-(const cgvVec4& a, const cgvVec4& b)
+{ cgvVec4 r;
+#ifdef CGV_MATH_SSE2
+    _mm_store_ps(r.c, _mm_sub_ps(_mm_load_ps(a.c), _mm_load_ps(b.c)));
+#else
+    for (int i = 0; i < 4; i++)
+    { r.c[i] = a.c[i] - b.c[i];
+    }
+#endif
+    return r;
+}
+
+inline cgvVec4 operator*(const cgvVec4& a, float s)
+{ cgvVec4 r;
+#ifdef CGV_MATH_SSE2
+    _mm_store_ps(r.c, _mm_mul_ps(_mm_load_ps(a.c), _mm_set1_ps(s)));
+#else
+    for (int i = 0; i < 4; i++)
+    { r.c[i] = a.c[i] * s;
+    }
+#endif
+    return r;
+}
+
+/// Dot product of the four components
+inline float dot(const cgvVec4& a, const cgvVec4& b)
+{ return a.c[0] * b.c[0] + a.c[1] * b.c[1] + a.c[2] * b.c[2] + a.c[3] * b.c[3];
+}
+
+/**
+ * Rotation stored as a unit quaternion x i + y j + z k + w
+ */
+struct cgvQuat {
+    float c[4]; ///< Components x, y, z (vector part) and w (scalar part)
+
+    /// Default constructor: no rotation
+    constexpr cgvQuat(): c{ 0, 0, 0, 1 } {}
+    /// Constructor from the components
+    constexpr cgvQuat(float x, float y, float z, float w): c{ x, y, z, w } {}
+
+    /**
+     * Rotation around an axis, as glRotatef
+     * @param angle Angle of the rotation, in degrees
+     * @param axis Axis of the rotation; it does not need to be normalized
+     */
+    static cgvQuat axis_angle(float angle, const cgvVec3& axis)
+    { cgvVec3 n = normalize(axis);
+        float half = angle * (float) M_PI / 360;
+        float s = sinf(half);
+        return cgvQuat(n.c[0] * s, n.c[1] * s, n.c[2] * s, cosf(half));
+    }
+
+    /// Vector part
+    constexpr cgvVec3 xyz() const { return cgvVec3(c[0], c[1], c[2]); }
+
+    /// Rotates a vector: q v q*
+    cgvVec3 rotate(const cgvVec3& v) const
+    { cgvVec3 u = xyz();
+        cgvVec3 t = cross(u, v) * 2;
+        return v + t * c[3] + cross(u, t);
+    }
+};
+
+/// Composition of rotations: a * b rotates by b first and then by a
+constexpr cgvQuat operator*(const cgvQuat& a, const cgvQuat& b)
+{ return cgvQuat(a.c[3] * b.c[0] + a.c[0] * b.c[3] + a.c[1] * b.c[2] - a.c[2] * b.c[1],
+                   a.c[3] * b.c[1] - a.c[0] * b.c[2] + a.c[1] * b.c[3] + a.c[2] * b.c[0],
+                   a.c[3] * b.c[2] + a.c[0] * b.c[1] - a.c[1] * b.c[0] + a.c[2] * b.c[3],
+                   a.c[3] * b.c[3] - a.c[0] * b.c[0] - a.c[1] * b.c[1] - a.c[2] * b.c[2]);
+}
+
+/**
+ * 4x4 matrix, column-major as OpenGL expects it, aligned so each column loads
+ * into one SSE register. The builders make the same matrices as the OpenGL and
+ * GLU functions with the same name, and translate, rotate and scale multiply on
+ * the right as glTranslatef, glRotatef and glScalef do on the matrix stack
+ */
+struct alignas(16) cgvMat4 {
+    float m[16]; ///< Elements, column after column
+
+    /// Default constructor: the identity
+    constexpr cgvMat4(): m{ 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 } {}
+    /// Constructor from the elements, column after column
+    constexpr cgvMat4(float m0, float m1, float m2, float m3, float m4, float m5, float m6, float m7,
+                      float m8, float m9, float m10, float m11, float m12, float m13, float m14, float m15)
+        : m{ m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15 } {}
+
+    /// Write/read access to an element
+    float& operator()(int row, int column) { return m[column * 4 + row]; }
+    /// Read access to an element
+    constexpr float operator()(int row, int column) const { return m[column * 4 + row]; }
+
+    /// C-like array of the elements, for glLoadMatrixf and buffers
+    float* data() { return m; }
+    const float* data() const { return m; }
+
+    /// Column of the matrix
+    cgvVec4 column(int idx) const
+    { return cgvVec4(m[idx * 4], m[idx * 4 + 1], m[idx * 4 + 2], m[idx * 4 + 3]);
+    }
+
+    // Builders
+    static constexpr cgvMat4 translation(float x, float y, float z)
+    { return cgvMat4(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, x, y, z, 1);
+    }
+
+    static constexpr cgvMat4 scaling(float x, float y, float z)
+    { return cgvMat4(x, 0, 0, 0, 0, y, 0, 0, 0, 0, z, 0, 0, 0, 0, 1);
+    }
+
+    static cgvMat4 rotation(float angle, float x, float y, float z); // angle in degrees, as glRotatef
+    static cgvMat4 rotation(const cgvQuat& q);
+    static cgvMat4 ortho(float left, float right, float bottom, float top, float near_plane, float far_plane);
+    static cgvMat4 frustum(float left, float right, float bottom, float top, float near_plane, float far_plane);
+    static cgvMat4 perspective(float fovy, float aspect, float near_plane, float far_plane); // fovy in degrees
+    static cgvMat4 look_at(const cgvVec3& eye, const cgvVec3& center, const cgvVec3& up);
+
+    // Multiplication on the right, as the matrix stack
+    cgvMat4& translate(float x, float y, float z);
+    cgvMat4& rotate(float angle, float x, float y, float z);
+    cgvMat4& scale(float x, float y, float z);
+};
+
+/// Product of two matrices: a * b applies b first and then a
+inline cgvMat4 operator*(const cgvMat4& a, const cgvMat4& b)
+{ cgvMat4 r;
+#ifdef CGV_MATH_SSE2
+    // each column of the result is a combination of the columns of a
+    __m128 a0 = _mm_load_ps(a.m), a1 = _mm_load_ps(a.m + 4), a2 = _mm_load_ps(a.m + 8), a3 = _mm_load_ps(a.m + 12);
+    for (int column = 0; column < 4; column++)
+    { const float* b_column = b.m + column * 4;
+        __m128 sum = _mm_mul_ps(a0, _mm_set1_ps(b_column[0]));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a1, _mm_set1_ps(b_column[1])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a2, _mm_set1_ps(b_column[2])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a3, _mm_set1_ps(b_column[3])));
+        _mm_store_ps(r.m + column * 4, sum);
+    }
+#else
+    for (int column = 0; column < 4; column++)
+    { for (int row = 0; row < 4; row++)
+        { r.m[column * 4 + row] = a.m[row] * b.m[column * 4] + a.m[4 + row] * b.m[column * 4 + 1]
+                                  + a.m[8 + row] * b.m[column * 4 + 2] + a.m[12 + row] * b.m[column * 4 + 3];
+        }
+    }
+#endif
+    return r;
+}
+
+/// Transforms a point/vector in homogeneous coordinates
+inline cgvVec4 operator*(const cgvMat4& a, const cgvVec4& v)
+{ cgvVec4 r;
+#ifdef CGV_MATH_SSE2
+    __m128 sum = _mm_mul_ps(_mm_load_ps(a.m), _mm_set1_ps(v.c[0]));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(a.m + 4), _mm_set1_ps(v.c[1])));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(a.m + 8), _mm_set1_ps(v.c[2])));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(a.m + 12), _mm_set1_ps(v.c[3])));
+    _mm_store_ps(r.c, sum);
+#else
+    for (int row = 0; row < 4; row++)
+    { r.c[row] = a.m[row] * v.c[0] + a.m[4 + row] * v.c[1] + a.m[8 + row] * v.c[2] + a.m[12 + row] * v.c[3];
+    }
+#endif
+    return r;
+}
+
+/**
+ * Builds the same matrix as glRotatef
+ * @param angle Angle of the rotation, in degrees
+ */
+inline cgvMat4 cgvMat4::rotation(float angle, float x, float y, float z)
+{ float length = sqrtf(x * x + y * y + z * z);
+    if (length == 0)
+    { return cgvMat4();
+    }
+    x /= length; y /= length; z /= length;
+
+    float radians = angle * (float) M_PI / 180;
+    float c = cosf(radians), s = sinf(radians), t = 1 - c;
+    return cgvMat4(t * x * x + c, t * x * y + s * z, t * x * z - s * y, 0,
+                   t * x * y - s * z, t * y * y + c, t * y * z + s * x, 0,
+                   t * x * z + s * y, t * y * z - s * x, t * z * z + c, 0,
+                   0, 0, 0, 1);
+}
+
+/**
+ * Builds the rotation matrix of a unit quaternion
+ */
+inline cgvMat4 cgvMat4::rotation(const cgvQuat& q)
+{ float x = q.c[0], y = q.c[1], z = q.c[2], w = q.c[3];
+    return cgvMat4(1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w), 0,
+                   2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w), 0,
+                   2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y), 0,
+                   0, 0, 0, 1);
+}
+
+/**
+ * Builds the same matrix as glOrtho
+ */
+inline cgvMat4 cgvMat4::ortho(float left, float right, float bottom, float top, float near_plane, float far_plane)
+{ return cgvMat4(2 / (right - left), 0, 0, 0,
+                   0, 2 / (top - bottom), 0, 0,
+                   0, 0, -2 / (far_plane - near_plane), 0,
+                   -(right + left) / (right - left), -(top + bottom) / (top - bottom),
+                   -(far_plane + near_plane) / (far_plane - near_plane), 1);
+}
+
+/**
+ * Builds the same matrix as glFrustum
+ */
+inline cgvMat4 cgvMat4::frustum(float left, float right, float bottom, float top, float near_plane, float far_plane)
+{ return cgvMat4(2 * near_plane / (right - left), 0, 0, 0,
+                   0, 2 * near_plane / (top - bottom), 0, 0,
+                   (right + left) / (right - left), (top + bottom) / (top - bottom),
+                   -(far_plane + near_plane) / (far_plane - near_plane), -1,
+                   0, 0, -2 * far_plane * near_plane / (far_plane - near_plane), 0);
+}
+
+/**
+ * Builds the same matrix as gluPerspective
+ * @param fovy Vertical field of view, in degrees
+ */
+inline cgvMat4 cgvMat4::perspective(float fovy, float aspect, float near_plane, float far_plane)
+{ float top = near_plane * tanf(fovy * (float) M_PI / 360);
+    return frustum(-top * aspect, top * aspect, -top, top, near_plane, far_plane);
+}
+
+/**
+ * Builds the same matrix as gluLookAt
+ */
+inline cgvMat4 cgvMat4::look_at(const cgvVec3& eye, const cgvVec3& center, const cgvVec3& up)
+{ cgvVec3 f = normalize(center - eye);
+    cgvVec3 s = normalize(cross(f, up));
+    cgvVec3 u = cross(s, f);
+    return cgvMat4(s[X], u[X], -f[X], 0,
+                   s[Y], u[Y], -f[Y], 0,
+                   s[Z], u[Z], -f[Z], 0,
+                   -dot(s, eye), -dot(u, eye), dot(f, eye), 1);
+}
+
+/**
+ * Multiplies the matrix by a translation on the right, as glTranslatef
+ * @return The matrix, so calls can be chained
+ */
+inline cgvMat4& cgvMat4::translate(float x, float y, float z)
+{ for (int row = 0; row < 4; row++)
+    { m[12 + row] += m[row] * x + m[4 + row] * y + m[8 + row] * z;
+    }
+    return *this;
+}
+
+/**
+ * Multiplies the matrix by a rotation on the right, as glRotatef
+ * @param angle Angle of the rotation, in degrees
+ * @return The matrix, so calls can be chained
+ */
+inline cgvMat4& cgvMat4::rotate(float angle, float x, float y, float z)
+{ *this = *this * rotation(angle, x, y, z);
+    return *this;
+}
+
+/**
+ * Multiplies the matrix by a scale on the right, as glScalef
+ * @return The matrix, so calls can be chained
+ */
+inline cgvMat4& cgvMat4::scale(float x, float y, float z)
+{ for (int row = 0; row < 4; row++)
+    { m[row] *= x;
+        m[4 + row] *= y;
+        m[8 + row] *= z;
+    }
+    return *this;
+}
+
+// Constants of cgv_sincos: pi / 2 split in three parts, so the reduction is exact
+// for the angles the scenes use, and the minimax polynomials of sin and cos in
+// [-pi / 4, pi / 4]
+#define CGV_SINCOS_PIO2_1 1.5703125f
+#define CGV_SINCOS_PIO2_2 4.837512969970703125e-4f
+#define CGV_SINCOS_PIO2_3 7.54978995489188216e-8f
+#define CGV_SINCOS_S1 -1.6666654611e-1f
+#define CGV_SINCOS_S2 8.3321608736e-3f
+#define CGV_SINCOS_S3 -1.9515295891e-4f
+#define CGV_SINCOS_C1 4.166664568298827e-2f
+#define CGV_SINCOS_C2 -1.388731625493765e-3f
+#define CGV_SINCOS_C3 2.443315711809948e-5f
+
+/**
+ * Sines and cosines of several angles at once, four at a time with SSE2 when
+ * available. The results are within a couple of ulps of sinf and cosf
+ * @param angles Angles, in radians
+ * @param sines Returns the sine of each angle
+ * @param cosines Returns the cosine of each angle
+ * @param count Number of angles
+ */
+inline void cgv_sincos(const float* angles, float* sines, float* cosines, int count)
+{ int i = 0;
+#ifdef CGV_MATH_SSE2
+    const __m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+    for (; i < count; i += 4)
+    { float in[4] = { 0, 0, 0, 0 };
+        int lanes = count - i < 4 ? count - i : 4;
+        for (int k = 0; k < lanes; k++)
+        { in[k] = angles[i + k];
+        }
+        __m128 x = _mm_loadu_ps(in);
+
+        // x = quadrant * pi / 2 + r, with r in [-pi / 4, pi / 4]
+        __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps((float) (2 / M_PI))));
+        __m128 q = _mm_cvtepi32_ps(quadrant);
+        __m128 r = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(CGV_SINCOS_PIO2_1)));
+        r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(CGV_SINCOS_PIO2_2)));
+        r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(CGV_SINCOS_PIO2_3)));
+        __m128 r2 = _mm_mul_ps(r, r);
+
+        __m128 s = _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(CGV_SINCOS_S3)), _mm_set1_ps(CGV_SINCOS_S2));
+        s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(CGV_SINCOS_S1));
+        s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, r2), r), r);
+        __m128 c = _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(CGV_SINCOS_C3)), _mm_set1_ps(CGV_SINCOS_C2));
+        c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(CGV_SINCOS_C1));
+        c = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(c, r2), r2), _mm_sub_ps(_mm_set1_ps(1), _mm_mul_ps(r2, _mm_set1_ps(0.5f))));
+
+        // odd quadrants swap sine and cosine, and the signs follow the quadrant
+        __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+        __m128 sin_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+        __m128 cos_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+        __m128 sine = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+        __m128 cosine = _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+
+        float out_sin[4], out_cos[4];
+        _mm_storeu_ps(out_sin, _mm_xor_ps(sine, sin_sign));
+        _mm_storeu_ps(out_cos, _mm_xor_ps(cosine, cos_sign));
+        for (int k = 0; k < lanes; k++)
+        { sines[i + k] = out_sin[k];
+            cosines[i + k] = out_cos[k];
+        }
+    }
+#else
+    for (; i < count; i++)
+    { float x = angles[i];
+        float q = nearbyintf(x * (float) (2 / M_PI));
+        int quadrant = (int) q;
+        float r = x - q * CGV_SINCOS_PIO2_1 - q * CGV_SINCOS_PIO2_2 - q * CGV_SINCOS_PIO2_3;
+        float r2 = r * r;
+        float s = ((CGV_SINCOS_S3 * r2 + CGV_SINCOS_S2) * r2 + CGV_SINCOS_S1) * r2 * r + r;
+        float c = ((CGV_SINCOS_C3 * r2 + CGV_SINCOS_C2) * r2 + CGV_SINCOS_C1) * r2 * r2 + (1 - 0.5f * r2);
+        float sine = quadrant & 1 ? c : s;
+        float cosine = quadrant & 1 ? s : c;
+        sines[i] = quadrant & 2 ? -sine : sine;
+        cosines[i] = (quadrant + 1) & 2 ? -cosine : cosine;
+    }
+#endif
+}
+
+#endif   // __CGVMATH
@@ -0,0 +1,334 @@
+#ifndef __CGVPOINTARRAY
+#define __CGVPOINTARRAY
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "cgvMath.h"
+
+/**
+ * Points or vectors in 3D stored as a structure of arrays: the x, y and z of all
+ * of them in three separate arrays aligned to 16 bytes, so the operations below
+ * work on four of them at a time with SSE2 when available, and on one at a time
+ * otherwise. The arrays grow with resize and never shrink, so an array reused on
+ * every frame does not allocate once it is big enough
+ */
+class cgvPointArray {
+private:
+    void* block = nullptr; ///< Memory of the three arrays, as returned by malloc
+    float* x = nullptr; ///< X coordinates
+    float* y = nullptr; ///< Y coordinates
+    float* z = nullptr; ///< Z coordinates
+    int count = 0; ///< Number of points
+    int capacity = 0; ///< Points the arrays can hold, a multiple of 4
+
+public:
+    /// Default constructor: no points
+    cgvPointArray() = default;
+
+    /// Constructor with room for count points, all at the origin
+    explicit cgvPointArray(int _count) { resize(_count); }
+
+    /// Constructor from points stored one after the other
+    cgvPointArray(const cgvVec3* points, int _count) { assign(points, _count); }
+
+    /// Copy constructor
+    cgvPointArray(const cgvPointArray& other) { *this = other; }
+
+    /// Move constructor
+    cgvPointArray(cgvPointArray&& other) noexcept { swap(other); }
+
+    /// Destructor
+    ~cgvPointArray() { free(block); }
+
+    /// Copy assignment
+    cgvPointArray& operator=(const cgvPointArray& other)
+    { if (this != &other)
+        { resize(other.count);
+            if (count == 0)
+            { return *this;
+            }
+            memcpy(x, other.x, count * sizeof(float));
+            memcpy(y, other.y, count * sizeof(float));
+            memcpy(z, other.z, count * sizeof(float));
+        }
+        return *this;
+    }
+
+    /// Move assignment
+    cgvPointArray& operator=(cgvPointArray&& other) noexcept
+    { swap(other);
+        return *this;
+    }
+
+    /// Exchanges the points of two arrays
+    void swap(cgvPointArray& other) noexcept
+    { std::swap(block, other.block);
+        std::swap(x, other.x);
+        std::swap(y, other.y);
+        std::swap(z, other.z);
+        std::swap(count, other.count);
+        std::swap(capacity, other.capacity);
+    }
+
+    /**
+     * Changes the number of points. The points kept keep their coordinates, and
+     * the new ones are at the origin
+     * @param _count New number of points
+     */
+    void resize(int _count)
+    { if (_count > capacity)
+        { int _capacity = (_count + 3) & ~3;
+            void* _block = malloc(3 * _capacity * sizeof(float) + 16);
+            if (!_block)
+            { throw std::bad_alloc();
+            }
+            float* _x = (float*) (((uintptr_t) _block + 15) & ~(uintptr_t) 15);
+            if (count > 0)
+            { memcpy(_x, x, count * sizeof(float));
+                memcpy(_x + _capacity, y, count * sizeof(float));
+                memcpy(_x + 2 * _capacity, z, count * sizeof(float));
+            }
+            free(block);
+            block = _block;
+            x = _x;
+            y = _x + _capacity;
+            z = _x + 2 * _capacity;
+            capacity = _capacity;
+        }
+        if (_count > count)
+        { memset(x + count, 0, (_count - count) * sizeof(float));
+            memset(y + count, 0, (_count - count) * sizeof(float));
+            memset(z + count, 0, (_count - count) * sizeof(float));
+        }
+        count = _count;
+    }
+
+    /**
+     * Replaces the points by points stored one after the other
+     * @param points Points to copy
+     * @param _count Number of points
+     */
+    void assign(const cgvVec3* points, int _count)
+    { resize(_count);
+        for (int i = 0; i < count; i++)
+        { x[i] = points[i].c[0];
+            y[i] = points[i].c[1];
+            z[i] = points[i].c[2];
+        }
+    }
+
+    /**
+     * Copies the points to an array that stores them one after the other
+     * @param points Returns the points; it must have room for size() of them
+     */
+    void copy_to(cgvVec3* points) const
+    { for (int i = 0; i < count; i++)
+        { points[i] = cgvVec3(x[i], y[i], z[i]);
+        }
+    }
+
+    /// Number of points
+    int size() const { return count; }
+
+    /// Point at a position
+    cgvVec3 get(int idx) const { return cgvVec3(x[idx], y[idx], z[idx]); }
+    /// Changes the point at a position
+    void set(int idx, const cgvVec3& p)
+    { x[idx] = p.c[0];
+        y[idx] = p.c[1];
+        z[idx] = p.c[2];
+    }
+
+    /// Array of a coordinate of all the points; use X, Y or Z as index
+    float* data(int coordinate) { return coordinate == X ? x : coordinate == Y ? y : z; }
+    const float* data(int coordinate) const { return coordinate == X ? x : coordinate == Y ? y : z; }
+
+    void transform(const cgvMat4& m, cgvPointArray& out, float* out_w = nullptr, float w = 1) const;
+    void bounds(cgvVec3& min, cgvVec3& max) const;
+};
+
+/**
+ * Transforms all the points at once, as m * (x, y, z, w) for each of them
+ * @param m Matrix to transform with
+ * @param out Returns x, y and z of the transformed points; it may be this array
+ * @param out_w If not null, returns the w of the transformed points; it must have
+ *        room for size() of them
+ * @param w Homogeneous coordinate of the points: 1 for points, 0 for vectors
+ */
+inline void cgvPointArray::transform(const cgvMat4& m, cgvPointArray& out, float* out_w, float w) const
+{ out.resize(count);
+    int i = 0;
+#ifdef CGV_MATH_SSE2
+    // the same sums as cgvMat4 * cgvVec4, so the results match it exactly
+    __m128 column[4][4];
+    for (int c = 0; c < 4; c++)
+    { for (int r = 0; r < 4; r++)
+        { column[c][r] = _mm_set1_ps(m.m[c * 4 + r]);
+        }
+    }
+    __m128 pw = _mm_set1_ps(w);
+    for (; i + 4 <= count; i += 4)
+    { __m128 px = _mm_load_ps(x + i), py = _mm_load_ps(y + i), pz = _mm_load_ps(z + i);
+        __m128 result[4];
+        for (int r = 0; r < 4; r++)
+        { __m128 sum = _mm_mul_ps(column[0][r], px);
+            sum = _mm_add_ps(sum, _mm_mul_ps(column[1][r], py));
+            sum = _mm_add_ps(sum, _mm_mul_ps(column[2][r], pz));
+            result[r] = _mm_add_ps(sum, _mm_mul_ps(column[3][r], pw));
+        }
+        _mm_store_ps(out.x + i, result[0]);
+        _mm_store_ps(out.y + i, result[1]);
+        _mm_store_ps(out.z + i, result[2]);
+        if (out_w)
+        { _mm_storeu_ps(out_w + i, result[3]);
+        }
+    }
+#endif
+    for (; i < count; i++)
+    { cgvVec4 p = m * cgvVec4(x[i], y[i], z[i], w);
+        out.x[i] = p.c[0];
+        out.y[i] = p.c[1];
+        out.z[i] = p.c[2];
+        if (out_w)
+        { out_w[i] = p.c[3];
+        }
+    }
+}
+
+/**
+ * Computes the axis-aligned box that holds all the points
+ * @param min Returns the smallest x, y and z; the origin if there are no points
+ * @param max Returns the largest x, y and z; the origin if there are no points
+ */
+inline void cgvPointArray::bounds(cgvVec3& min, cgvVec3& max) const
+{ min = max = count > 0 ? get(0) : cgvVec3();
+    int i = 0;
+#ifdef CGV_MATH_SSE2
+    if (count >= 4)
+    { __m128 min_x = _mm_load_ps(x), min_y = _mm_load_ps(y), min_z = _mm_load_ps(z);
+        __m128 max_x = min_x, max_y = min_y, max_z = min_z;
+        for (i = 4; i + 4 <= count; i += 4)
+        { __m128 px = _mm_load_ps(x + i), py = _mm_load_ps(y + i), pz = _mm_load_ps(z + i);
+            min_x = _mm_min_ps(min_x, px);
+            min_y = _mm_min_ps(min_y, py);
+            min_z = _mm_min_ps(min_z, pz);
+            max_x = _mm_max_ps(max_x, px);
+            max_y = _mm_max_ps(max_y, py);
+            max_z = _mm_max_ps(max_z, pz);
+        }
+        float lanes[6][4];
+        _mm_storeu_ps(lanes[0], min_x);
+        _mm_storeu_ps(lanes[1], min_y);
+        _mm_storeu_ps(lanes[2], min_z);
+        _mm_storeu_ps(lanes[3], max_x);
+        _mm_storeu_ps(lanes[4], max_y);
+        _mm_storeu_ps(lanes[5], max_z);
+        for (int k = 0; k < 4; k++)
+        { for (int c = 0; c < 3; c++)
+            { min.c[c] = lanes[c][k] < min.c[c] ? lanes[c][k] : min.c[c];
+                max.c[c] = lanes[3 + c][k] > max.c[c] ? lanes[3 + c][k] : max.c[c];
+            }
+        }
+    }
+#endif
+    for (; i < count; i++)
+    { cgvVec3 p = get(i);
+        for (int c = 0; c < 3; c++)
+        { min.c[c] = p.c[c] < min.c[c] ? p.c[c] : min.c[c];
+            max.c[c] = p.c[c] > max.c[c] ? p.c[c] : max.c[c];
+        }
+    }
+}
+
+/**
+ * Compares two arrays point by point, as near_equal compares two points
+ * @param a First array
+ * @param b Second array, with as many points as a
+ * @param mask Returns 1 for each pair of points that are equal up to the
+ *        tolerance and 0 for the rest; it must have room for a.size() of them
+ * @param epsilon Tolerance of each coordinate
+ * @return The number of pairs that are equal
+ */
+inline int near_equal(const cgvPointArray& a, const cgvPointArray& b, uint8_t* mask, float epsilon = CGV_EPSILON)
+{ const float *ax = a.data(X), *ay = a.data(Y), *az = a.data(Z);
+    const float *bx = b.data(X), *by = b.data(Y), *bz = b.data(Z);
+    int count = a.size(), equal = 0, i = 0;
+#ifdef CGV_MATH_SSE2
+    // |d| < epsilon, with the sign bit of d cleared by the mask
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 tolerance = _mm_set1_ps(epsilon);
+    for (; i + 4 <= count; i += 4)
+    { __m128 dx = _mm_and_ps(_mm_sub_ps(_mm_load_ps(ax + i), _mm_load_ps(bx + i)), abs_mask);
+        __m128 dy = _mm_and_ps(_mm_sub_ps(_mm_load_ps(ay + i), _mm_load_ps(by + i)), abs_mask);
+        __m128 dz = _mm_and_ps(_mm_sub_ps(_mm_load_ps(az + i), _mm_load_ps(bz + i)), abs_mask);
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(dx, tolerance), _mm_cmplt_ps(dy, tolerance)),
+                                   _mm_cmplt_ps(dz, tolerance));
+        int bits = _mm_movemask_ps(inside);
+        for (int k = 0; k < 4; k++)
+        { mask[i + k] = (uint8_t) ((bits >> k) & 1);
+            equal += mask[i + k];
+        }
+    }
+#endif
+    for (; i < count; i++)
+    { mask[i] = near_equal(a.get(i), b.get(i), epsilon) ? 1 : 0;
+        equal += mask[i];
+    }
+    return equal;
+}
+
+/**
+ * Dot products of two arrays, point by point
+ * @param a First array
+ * @param b Second array, with as many points as a
+ * @param out Returns the dot product of each pair; it must have room for
+ *        a.size() of them
+ */
+inline void dot(const cgvPointArray& a, const cgvPointArray& b, float* out)
+{ const float *ax = a.data(X), *ay = a.data(Y), *az = a.data(Z);
+    const float *bx = b.data(X), *by = b.data(Y), *bz = b.data(Z);
+    int count = a.size(), i = 0;
+#ifdef CGV_MATH_SSE2
+    for (; i + 4 <= count; i += 4)
+    { __m128 sum = _mm_mul_ps(_mm_load_ps(ax + i), _mm_load_ps(bx + i));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(ay + i), _mm_load_ps(by + i)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(az + i), _mm_load_ps(bz + i)));
+        _mm_storeu_ps(out + i, sum);
+    }
+#endif
+    for (; i < count; i++)
+    { out[i] = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i];
+    }
+}
+
+/**
+ * Cross products of two arrays, point by point
+ * @param a First array
+ * @param b Second array, with as many points as a
+ * @param out Returns a x b for each pair; it may be a or b
+ */
+inline void cross(const cgvPointArray& a, const cgvPointArray& b, cgvPointArray& out)
+{ out.resize(a.size());
+    const float *ax = a.data(X), *ay = a.data(Y), *az = a.data(Z);
+    const float *bx = b.data(X), *by = b.data(Y), *bz = b.data(Z);
+    float *ox = out.data(X), *oy = out.data(Y), *oz = out.data(Z);
+    int count = a.size(), i = 0;
+#ifdef CGV_MATH_SSE2
+    for (; i + 4 <= count; i += 4)
+    { __m128 px = _mm_load_ps(ax + i), py = _mm_load_ps(ay + i), pz = _mm_load_ps(az + i);
+        __m128 qx = _mm_load_ps(bx + i), qy = _mm_load_ps(by + i), qz = _mm_load_ps(bz + i);
+        _mm_store_ps(ox + i, _mm_sub_ps(_mm_mul_ps(py, qz), _mm_mul_ps(pz, qy)));
+        _mm_store_ps(oy + i, _mm_sub_ps(_mm_mul_ps(pz, qx), _mm_mul_ps(px, qz)));
+        _mm_store_ps(oz + i, _mm_sub_ps(_mm_mul_ps(px, qy), _mm_mul_ps(py, qx)));
+    }
+#endif
+    for (; i < count; i++)
+    { out.set(i, cross(a.get(i), b.get(i)));
+    }
+}
+
+#endif   // __CGVPOINTARRAY
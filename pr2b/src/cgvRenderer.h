@@ -0,0 +1,183 @@
+#ifndef __CGVRENDERER
+#define __CGVRENDERER
+
+#if defined(__APPLE__) && defined(__MACH__)
+#include <GLUT/glut.h>
+#include <OpenGL/gl.h>
+#include <OpenGL/glu.h>
+#else
+#include <GL/glut.h>
+#endif   // defined(__APPLE__) && defined(__MACH__)
+
+#include <cstdint>
+#include <vector>
+
+#include "cgvGLStats.h"
+#include "cgvMath.h"
+
+#define CGV_CYLINDER_SLICES 20 ///< Subdivisions of CGV_MESH_CYLINDER around its axis
+#define CGV_CYLINDER_STACKS 20 ///< Subdivisions of CGV_MESH_CYLINDER along its axis
+
+/**
+ * Meshes that can be submitted to a renderer. All of them are unit sized and are
+ * placed in the scene with the transform they are submitted with
+ */
+typedef enum {
+    CGV_MESH_CUBE, ///< glutSolidCube(1)
+    CGV_MESH_SPHERE, ///< glutSolidSphere(1, 32, 32)
+    CGV_MESH_CONE, ///< glutSolidCone(1, 1, 32, 32): base on z = 0, apex on z = 1
+    CGV_MESH_CYLINDER, ///< gluCylinder(1, 1, 1, CGV_CYLINDER_SLICES, CGV_CYLINDER_STACKS): open tube from z = 0 to z = 1
+    CGV_MESH_AXES, ///< Red, green and blue lines from -1 to 1 along X, Y and Z; the colors are its own
+    CGV_MESHES
+} cgvMesh;
+
+/**
+ * Appearance of a submitted mesh
+ */
+struct cgvMaterial {
+    GLfloat color[3]; ///< Emission of the default material if lit, plain color otherwise
+    bool lit; ///< Whether it is lit by the point light of the scene (GL_LIGHTING)
+    GLenum polygon_mode; ///< GL_FILL, or GL_LINE to draw its outline
+    GLfloat line_width; ///< Width of the lines of outlines and axes
+};
+
+/**
+ * Vertex of a tessellated mesh
+ */
+struct cgvVertex {
+    GLfloat position[3]; ///< Position, in model coordinates
+    GLfloat normal[3]; ///< Normal, in model coordinates
+    GLfloat color[4]; ///< Own color of the vertex; alpha is its weight against the material color
+};
+
+#define CGV_MAX_VIEWS 4 ///< Views a frame can be drawn in at once
+
+/**
+ * Viewport and camera of a view of the scene
+ */
+struct cgvView {
+    GLint x, y; ///< Bottom left corner of the viewport, in pixels
+    GLsizei width, height; ///< Size of the viewport, in pixels
+    cgvMat4 projection; ///< Projection matrix, column-major
+    cgvMat4 view; ///< View matrix, column-major
+};
+
+typedef uint32_t cgvViewMask; ///< Views a mesh is visible in: bit i for the view i
+
+/**
+ * Bounding sphere of a submitted mesh, in world coordinates
+ */
+struct cgvBounds {
+    cgvVec3 center; ///< Center of the sphere
+    GLfloat radius; ///< Radius of the sphere
+};
+
+/**
+ * Local point light, lighting the lit meshes within its radius on top of the
+ * point light of the scene
+ */
+struct cgvPointLight {
+    cgvVec3 position; ///< Position, in world coordinates
+    GLfloat radius; ///< Distance at which its light fades out
+    GLfloat color[3]; ///< Diffuse intensity
+};
+
+/**
+ * Regular grid of copies of a mesh. The copy in the cell (x, y, z) is placed with
+ * the transform of the grid moved by (x, y, z) times the spacing; cells are
+ * numbered by Y layer, then X row, then Z
+ */
+struct cgvGrid {
+    GLint cells[3]; ///< Cells along X, Y and Z
+    GLfloat spacing[3]; ///< Distance between the copies along X, Y and Z
+};
+
+#define CGV_MIN_RESOLUTION_SCALE 0.1f ///< Smallest fraction of the window resolution the frames can be drawn at
+
+class cgvRenderTarget;
+
+/**
+ * Interface of the objects that draw the scenes. Scenes submit meshes with their
+ * material and transform between begin_frame and end_frame, and each backend
+ * decides how they reach the GPU. Backends are created by name at startup, so
+ * they can be compared in the same binary
+ */
+class cgvRenderer {
+protected:
+    cgvView views[CGV_MAX_VIEWS]; ///< Views set by set_views
+    int view_count = 1; ///< Views the frames are drawn in; the ones of set_viewport and set_camera if 1
+    cgvVec4 frusta[CGV_MAX_VIEWS][6]; ///< Planes of the frustum of each view, in world coordinates, facing inside
+    bool culling = true; ///< Whether the meshes outside the views are skipped
+    unsigned long culled_instances = 0; ///< Meshes skipped since begin_frame, once per view they are skipped in
+    unsigned long shadow_rebuilds = 0; ///< Times the shadow map has been drawn
+    double shadow_ms = 0; ///< GPU time of the last shadow map drawn, in ms
+
+    GLint window_rects[CGV_MAX_VIEWS][4] = {}; ///< Viewports of the views, in window pixels: x, y, width, height
+    GLsizei frame_width = 0, frame_height = 0; ///< Window pixels covered by the current viewports, from the origin
+    GLfloat resolution_scale = 1; ///< Fraction of the window resolution the frames are drawn at
+    GLsizei target_width = 0, target_height = 0; ///< Pixels the frames are drawn to: the covered ones, scaled
+    cgvRenderTarget* target = nullptr; ///< Offscreen framebuffer of the backends that draw with OpenGL, once scaled
+    GLfloat clear_value[4] = {}; ///< Color set by set_clear_color, as GL_COLOR_CLEAR_VALUE
+
+    cgvRenderer();
+
+public:
+    /// Destructor
+    virtual ~cgvRenderer();
+
+    static cgvRenderer* create(const char* name);
+    static const char* get_names();
+
+    // Methods
+    virtual const char* get_name() = 0;
+    virtual bool requires_core_profile(); // whether it needs an OpenGL 3.3 core-profile context
+    virtual bool requires_window(); // whether it needs a GLUT window, or can run headless
+    virtual bool initialize() = 0; // called once the context is current
+
+    void set_viewport(GLint x, GLint y, GLsizei width, GLsizei height); // in window pixels
+    virtual void set_clear_color(GLfloat r, GLfloat g, GLfloat b);
+    virtual void clear();
+    virtual void present();
+    virtual bool save_frame(const char* path); // writes the last frame as a PPM file
+
+    virtual void set_camera(const cgvMat4& projection, const cgvMat4& view) = 0; // backends call it to cull
+    virtual void set_views(const cgvView* _views, int count); // the next frames are drawn in all of them
+    void set_resolution_scale(GLfloat scale); // the next frames are drawn at that fraction of the window resolution
+    GLfloat get_resolution_scale();
+    virtual void set_light(const cgvVec4& position) = 0;
+    virtual void set_local_lights(const cgvPointLight* lights, int count); // besides the point light
+    virtual void set_shadows(bool enabled); // of the point light
+    virtual void invalidate_shadows(); // the meshes have changed: the next frame draws the shadow map again
+    virtual bool set_outlines(bool enabled, const GLfloat color[3]); // before clear; false if not drawn
+
+    virtual void begin_frame() = 0;
+    virtual void submit(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& transform) = 0;
+    virtual void submit_grid(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& transform,
+                             const cgvGrid& grid); // a copy of the mesh in each cell
+    virtual bool culls_grids(); // whether submit_grid costs the same for any number of cells
+    virtual unsigned long end_frame() = 0; // returns the draw calls issued
+
+    virtual unsigned long get_streamed_bytes(); // per-instance data uploaded by the last frame
+    virtual unsigned long get_stream_waits(); // times the CPU has waited for the GPU to release that data
+    unsigned long get_culled_instances(); // meshes culled by the last frame, once per view
+    unsigned long get_shadow_rebuilds();
+    double get_shadow_ms();
+
+    static cgvBounds get_bounds(cgvMesh mesh, const cgvMat4& transform); // in world coordinates
+    static cgvMat4 get_cell_transform(const cgvGrid& grid, const cgvMat4& transform, int cell);
+    cgvViewMask cull(const cgvBounds& bounds); // views the bounds are visible in
+
+    static GLenum tessellate(cgvMesh mesh, std::vector<cgvVertex>& vertices);
+    static void tessellate_cylinder(int slices, int stacks, std::vector<cgvVertex>& vertices); // as gluCylinder
+
+protected:
+    virtual void apply_viewport(GLint x, GLint y, GLsizei width, GLsizei height); // in the pixels drawn to
+    virtual bool update_target(); // after the pixels drawn to change
+    GLuint get_target_framebuffer(); // the one update_target binds, without asking OpenGL
+    static void set_frustum(const cgvMat4& view_projection, cgvVec4 planes[6]);
+
+private:
+    void scale_views();
+};
+
+#endif   // __CGVRENDERER
@@ -0,0 +1,55 @@
+#if defined(__APPLE__) && defined(__MACH__)
+#include <GLUT/glut.h>
+#include <OpenGL/gl.h>
+#include <OpenGL/glu.h>
+
+#else
+
+#include <GL/glut.h>
+
+#endif
+
+#include <cstdlib>
+#include <stdio.h>
+
+#include "cgvScene3D.h"
+
+
+cgvScene3D::cgvScene3D() { axis = true; draw_calls = 0; instances = 0; }
+
+cgvScene3D::~cgvScene3D() {}
+
+void paint_axes(cgvRenderer* renderer) {
+    cgvMaterial axes = { { 0, 0, 0 }, true, GL_FILL, 1 }; // the axes bring their own colors
+    cgvMat4 transform = cgvMat4::scaling(1000, 1000, 1000);
+    renderer->submit(CGV_MESH_AXES, axes, transform);
+}
+
+void paint_tube(cgvRenderer* renderer, const cgvMat4& placement) {
+    cgvMaterial tube = { { 0, 0, 0.5 }, true, GL_FILL, 1 };
+    cgvMat4 transform = placement;
+
+    transform.translate(0, 0, -0.5).scale(0.25, 0.25, 1);
+    renderer->submit(CGV_MESH_CYLINDER, tube, transform);
+}
+
+void cgvScene3D::display(void) {
+    // create lights
+    renderer->set_light(cgvVec4(10, 8, 9, 1)); // point light
+    renderer->begin_frame();
+
+    // paint the axes
+    if (axis) {
+        paint_axes(renderer);
+    }
+
+    // paint the scene objects
+    cgvMaterial cube = { { 0, 0.25, 0 }, true, GL_FILL, 1 };
+    renderer->submit(CGV_MESH_CUBE, cube, cgvMat4::scaling(1, 2, 4));
+
+    paint_tube(renderer, cgvMat4::rotation(45, 1, 0, 0).scale(1, 1, 4.5));
+    paint_tube(renderer, cgvMat4::rotation(-45, 1, 0, 0).scale(1, 1, 4.5));
+
+    draw_calls += renderer->end_frame();
+    instances += 3;
+}
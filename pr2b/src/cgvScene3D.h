@@ -0,0 +1,44 @@
+#pragma once
+
+#ifndef __IGVESCENA3D
+#define __IGVESCENA3D
+
+#if defined(__APPLE__) && defined(__MACH__)
+#include <GLUT/glut.h>
+#include <OpenGL/gl.h>
+#include <OpenGL/glu.h>
+#else
+#include <GL/glut.h>
+#endif
+
+#include "cgvGLStats.h"
+#include "cgvRenderer.h"
+
+class cgvScene3D {
+    protected:
+    // Attributes
+        bool axis;
+        cgvRenderer* renderer = nullptr; // renderer the scene is submitted to
+        unsigned long draw_calls; // draw calls issued since the last call to reset_counts
+        unsigned long instances; // objects drawn since the last call to reset_counts
+
+    public:
+    // Default constructors and destructor
+    cgvScene3D();
+    ~cgvScene3D();
+
+    // Methods
+    // Method to display the scene by submitting it to the renderer
+    void display();
+
+    void set_renderer(cgvRenderer* _renderer) { renderer = _renderer; };
+
+    bool get_ejes() { return axis; };
+    void set_ejes(bool _axis) { axis = _axis; };
+
+    void reset_counts() { draw_calls = 0; instances = 0; };
+    unsigned long get_draw_calls() { return draw_calls; };
+    unsigned long get_instances() { return instances; };
+    };
+
+#endif
@@ -0,0 +1,678 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdio.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CGV_RASTER_SSE2
+#endif
+
+#include "cgvSoftwareRenderer.h"
+
+// Packs a color with components from 0 to 1 as RGBA8, in memory order on little-endian machines
+static uint32_t pack_color(GLfloat r, GLfloat g, GLfloat b)
+{ return (uint32_t) (std::min(r, 1.0f) * 255 + 0.5f)
+           | (uint32_t) (std::min(g, 1.0f) * 255 + 0.5f) << 8
+           | (uint32_t) (std::min(b, 1.0f) * 255 + 0.5f) << 16
+           | 0xff000000u;
+}
+
+/**
+* Destructor
+*/
+cgvSoftwareRenderer::~cgvSoftwareRenderer()
+{ delete pool;
+}
+
+/**
+* Method to query the name of the backend
+* @return The name accepted by cgvRenderer::create
+*/
+const char* cgvSoftwareRenderer::get_name()
+{ return "software";
+}
+
+/**
+* Method to check whether the backend draws through an OpenGL window
+* @retval false Always: frames are drawn to memory, and only shown if there is a window
+*/
+bool cgvSoftwareRenderer::requires_window()
+{ return false;
+}
+
+/**
+* Starts the threads and tessellates the meshes. Does not call OpenGL, so it
+* works without a context
+* @retval true Always
+*/
+bool cgvSoftwareRenderer::initialize()
+{ unsigned int threads = std::thread::hardware_concurrency();
+    const char* requested = getenv("CGV_RASTER_THREADS");
+    if (requested && atoi(requested) > 0)
+    { threads = (unsigned int) atoi(requested);
+    }
+    pool = new cgvThreadPool(threads > 0 ? threads : 1);
+    fprintf(stderr, "[renderer] software rasterizer with %u threads\n", pool->get_threads());
+
+    for (int mesh = 0; mesh < CGV_MESHES; mesh++)
+    { first[mesh] = (GLint) vertices.size();
+        primitive[mesh] = tessellate((cgvMesh) mesh, vertices);
+        count[mesh] = (GLsizei) vertices.size() - first[mesh];
+
+        positions[mesh].resize(count[mesh]);
+        normals[mesh].resize(count[mesh]);
+        for (int i = 0; i < count[mesh]; i++)
+        { const cgvVertex& vertex = vertices[first[mesh] + i];
+            positions[mesh].set(i, cgvVec3(vertex.position[0], vertex.position[1], vertex.position[2]));
+            normals[mesh].set(i, cgvVec3(vertex.normal[0], vertex.normal[1], vertex.normal[2]));
+        }
+    }
+    return true;
+}
+
+/**
+* Sets the region of the framebuffer the next frames are drawn to. The
+* framebuffer grows to hold it, and is cleared when it does
+*/
+void cgvSoftwareRenderer::apply_viewport(GLint x, GLint y, GLsizei _width, GLsizei _height)
+{ viewport[0] = std::max(x, 0);
+    viewport[1] = std::max(y, 0);
+    viewport[2] = std::max((int) _width, 0);
+    viewport[3] = std::max((int) _height, 0);
+
+    if (viewport[0] + viewport[2] > width || viewport[1] + viewport[3] > height)
+    { width = std::max(width, viewport[0] + viewport[2]);
+        height = std::max(height, viewport[1] + viewport[3]);
+        stride = (width + 3) & ~3;
+        color.assign((size_t) stride * height, clear_color);
+        depth.assign((size_t) stride * height, 1.0f);
+    }
+}
+
+/**
+* Nothing to do: the frames are drawn to the framebuffer in memory at any
+* resolution, as it grows with the viewports
+* @retval true Always
+*/
+bool cgvSoftwareRenderer::update_target()
+{ return true;
+}
+
+/**
+* Sets the color the framebuffer is cleared to
+*/
+void cgvSoftwareRenderer::set_clear_color(GLfloat r, GLfloat g, GLfloat b)
+{ clear_color = pack_color(r, g, b);
+}
+
+/**
+* Clears the color and the depth of the whole framebuffer
+*/
+void cgvSoftwareRenderer::clear()
+{ std::fill(color.begin(), color.end(), clear_color);
+    std::fill(depth.begin(), depth.end(), 1.0f);
+}
+
+/**
+* Copies the frame to the window, zoomed if it was drawn at a lower resolution
+* to the bottom left corner of the framebuffer, and swaps its buffers. Must only be called when there is a window
+*/
+void cgvSoftwareRenderer::present()
+{ int frame[2];
+    get_frame_size(frame);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glViewport(0, 0, width, height);
+
+    glRasterPos2f(-1, -1); // bottom left corner of the window
+    if (resolution_scale < 1)
+    { glPixelZoom((GLfloat) frame_width / frame[0], (GLfloat) frame_height / frame[1]);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, stride);
+    glDrawPixels(frame[0], frame[1], GL_RGBA, GL_UNSIGNED_BYTE, color.data());
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelZoom(1, 1);
+
+    glutSwapBuffers();
+}
+
+/**
+* Saves the last frame to a binary PPM file, at the resolution it was drawn at
+* @param path Path of the file
+* @retval true If the file could be written
+* @retval false Otherwise
+*/
+bool cgvSoftwareRenderer::save_frame(const char* path)
+{ FILE* file = fopen(path, "wb");
+    if (!file)
+    { return false;
+    }
+
+    int frame[2];
+    get_frame_size(frame);
+    fprintf(file, "P6\n%d %d\n255\n", frame[0], frame[1]);
+    std::vector<unsigned char> row(frame[0] * 3);
+    for (int y = frame[1] - 1; y >= 0; y--) // PPM rows go from top to bottom
+    { const uint32_t* pixel = &color[(size_t) y * stride];
+        for (int x = 0; x < frame[0]; x++)
+        { row[x * 3] = pixel[x] & 0xff;
+            row[x * 3 + 1] = (pixel[x] >> 8) & 0xff;
+            row[x * 3 + 2] = (pixel[x] >> 16) & 0xff;
+        }
+        fwrite(row.data(), 1, row.size(), file);
+    }
+    return fclose(file) == 0;
+}
+
+/**
+* Computes the pixels of the framebuffer the frames cover, from its bottom left
+* corner: all of them at full resolution, and the scaled ones otherwise
+* @param size Returns the width and height, in pixels
+*/
+void cgvSoftwareRenderer::get_frame_size(int size[2])
+{ size[0] = width;
+    size[1] = height;
+    if (resolution_scale < 1)
+    { size[0] = std::min((int) target_width, width);
+        size[1] = std::min((int) target_height, height);
+    }
+}
+
+/**
+* Sets the camera used to draw the next frames, and culls against it
+* @param projection Projection matrix, column-major
+* @param view View matrix, column-major
+*/
+void cgvSoftwareRenderer::set_camera(const cgvMat4& projection, const cgvMat4& view)
+{ cgvRenderer::set_camera(projection, view);
+    view_projection = projection * view;
+}
+
+/**
+* Sets the position of the point light, as the GL_POSITION of GL_LIGHT0
+* @param position Position of the light, in world coordinates
+*/
+void cgvSoftwareRenderer::set_light(const cgvVec4& position)
+{ light = position;
+}
+
+/**
+* Starts collecting the meshes of a new frame
+*/
+void cgvSoftwareRenderer::begin_frame()
+{ instances.clear(); // keeps the capacity, so steady frames do not allocate
+    culled_instances = 0;
+}
+
+/**
+* Adds a mesh to the frame, unless it is outside the views; it is drawn by
+* end_frame
+* @param mesh Mesh to draw
+* @param material Appearance of the mesh
+* @param transform Modeling matrix of the mesh
+*/
+void cgvSoftwareRenderer::submit(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& transform)
+{ cgvSoftwareInstance instance;
+    instance.mesh = mesh;
+    instance.material = material;
+    instance.transform = transform;
+    instance.visible = cull(get_bounds(mesh, transform));
+    if (instance.visible)
+    { instances.push_back(instance);
+    }
+}
+
+/**
+* Lights and projects the meshes of the frame, bins their triangles into the
+* tiles of the viewport and rasterizes the tiles on the thread pool. With
+* several views, the meshes are projected into each of them and the triangles
+* of all of them are binned and rasterized in one pass over the tiles that
+* cover the views. Each view only draws the meshes visible in it
+* @return The number of meshes drawn, once per view
+*/
+unsigned long cgvSoftwareRenderer::end_frame()
+{ triangles.clear();
+    unsigned long drawn = 0;
+    int left = viewport[0], bottom = viewport[1];
+    int right = viewport[0] + viewport[2], top = viewport[1] + viewport[3];
+    if (view_count > 1)
+    { left = bottom = INT_MAX;
+        right = top = 0;
+        for (int i = 0; i < view_count; i++)
+        { apply_viewport(views[i].x, views[i].y, views[i].width, views[i].height);
+            view_projection = views[i].projection * views[i].view;
+            for (const cgvSoftwareInstance& instance: instances)
+            { if (instance.visible & (1u << i))
+                { process_instance(instance);
+                    drawn++;
+                }
+            }
+            if (viewport[2] > 0 && viewport[3] > 0)
+            { left = std::min(left, viewport[0]);
+                bottom = std::min(bottom, viewport[1]);
+                right = std::max(right, viewport[0] + viewport[2]);
+                top = std::max(top, viewport[1] + viewport[3]);
+            }
+        }
+    }
+    else
+    { for (const cgvSoftwareInstance& instance: instances)
+        { process_instance(instance);
+        }
+        drawn = instances.size();
+    }
+
+    if (right <= left || top <= bottom)
+    { return drawn;
+    }
+
+    first_tile_x = left / CGV_RASTER_TILE;
+    first_tile_y = bottom / CGV_RASTER_TILE;
+    tiles_x = (right - 1) / CGV_RASTER_TILE - first_tile_x + 1;
+    tiles_y = (top - 1) / CGV_RASTER_TILE - first_tile_y + 1;
+    if (bins.size() < (size_t) (tiles_x * tiles_y))
+    { bins.resize(tiles_x * tiles_y);
+    }
+    for (int tile = 0; tile < tiles_x * tiles_y; tile++)
+    { bins[tile].clear();
+    }
+
+    // in submission order, so each tile draws its triangles in the same order as OpenGL
+    for (uint32_t t = 0; t < triangles.size(); t++)
+    { const cgvRasterTriangle& triangle = triangles[t];
+        for (int ty = triangle.min_y / CGV_RASTER_TILE; ty <= triangle.max_y / CGV_RASTER_TILE; ty++)
+        { for (int tx = triangle.min_x / CGV_RASTER_TILE; tx <= triangle.max_x / CGV_RASTER_TILE; tx++)
+            { bins[(ty - first_tile_y) * tiles_x + tx - first_tile_x].push_back(t);
+            }
+        }
+    }
+
+    pool->run(tiles_x * tiles_y, [this](int tile) { rasterize_tile(tile); });
+
+    return drawn;
+}
+
+/**
+* Method to query the width of the framebuffer
+* @return The width, in pixels
+*/
+int cgvSoftwareRenderer::get_width()
+{ return width;
+}
+
+/**
+* Method to query the height of the framebuffer
+* @return The height, in pixels
+*/
+int cgvSoftwareRenderer::get_height()
+{ return height;
+}
+
+/**
+* Method to access the pixels of the framebuffer
+* @return RGBA8 colors, with the rows from bottom to top
+*/
+const uint32_t* cgvSoftwareRenderer::get_pixels()
+{ return color.data();
+}
+
+/**
+* Method to query the distance between the rows of the framebuffer
+* @return The pixels per row, a multiple of 4
+*/
+int cgvSoftwareRenderer::get_stride()
+{ return stride;
+}
+
+/**
+* Lights and projects the vertices of a mesh, and adds its primitives to the
+* triangles of the frame. The lighting is the one of the core renderer
+* @param instance Mesh with its material and transform
+*/
+void cgvSoftwareRenderer::process_instance(const cgvSoftwareInstance& instance)
+{ const cgvMat4& t = instance.transform;
+    const cgvMaterial& material = instance.material;
+    cgvMat4 mvp = view_projection * t;
+
+    // the inverse transpose of the upper 3x3 block has the cross products of its columns
+    // as columns, divided by the determinant; only its sign matters, as normals are normalized
+    cgvVec3 column[3] = { t.column(0).xyz(), t.column(1).xyz(), t.column(2).xyz() };
+    cgvVec3 normal_matrix[3] = { cross(column[1], column[2]), cross(column[2], column[0]),
+                                 cross(column[0], column[1]) };
+    GLfloat sign = dot(column[0], normal_matrix[0]) < 0 ? -1.0f : 1.0f;
+
+    // all the vertices of the mesh are transformed at once, four at a time
+    const cgvPointArray& mesh_positions = positions[instance.mesh];
+    if (clip_w.size() < (size_t) mesh_positions.size())
+    { clip_w.resize(mesh_positions.size());
+    }
+    mesh_positions.transform(mvp, clip_positions, clip_w.data());
+    if (material.lit)
+    { cgvVec3 n0 = normal_matrix[0] * sign, n1 = normal_matrix[1] * sign, n2 = normal_matrix[2] * sign;
+        cgvMat4 normal_transform(n0[X], n0[Y], n0[Z], 0, n1[X], n1[Y], n1[Z], 0, n2[X], n2[Y], n2[Z], 0, 0, 0, 0, 1);
+        mesh_positions.transform(t, world_positions);
+        normals[instance.mesh].transform(normal_transform, world_normals, nullptr, 0);
+    }
+
+    int per_primitive = primitive[instance.mesh] == GL_LINES ? 2 : 3;
+    GLfloat clip[3][4], colors[3][3];
+    for (int i = 0; i < count[instance.mesh]; i++)
+    { const cgvVertex& vertex = vertices[first[instance.mesh] + i];
+        int k = i % per_primitive;
+
+        cgvVec3 clip_position = clip_positions.get(i);
+        memcpy(clip[k], clip_position.data(), sizeof(clip_position));
+        clip[k][3] = clip_w[i];
+
+        for (int c = 0; c < 3; c++)
+        { colors[k][c] = material.color[c] + (vertex.color[c] - material.color[c]) * vertex.color[3];
+        }
+
+        if (material.lit)
+        { cgvVec3 n = world_normals.get(i);
+            cgvVec3 l = light.xyz() - world_positions.get(i);
+            GLfloat n_length = length(n);
+            GLfloat l_length = length(l);
+            GLfloat diffuse = 0;
+            if (n_length > 0 && l_length > 0)
+            { diffuse = std::max(dot(n, l) / (n_length * l_length), 0.0f);
+            }
+            for (int c = 0; c < 3; c++)
+            { colors[k][c] = std::min(colors[k][c] + 0.04f + 0.8f * diffuse, 1.0f);
+            }
+        }
+
+        if (k == per_primitive - 1)
+        { if (per_primitive == 2)
+            { add_line(clip[0], clip[1], colors[0], colors[1], material.line_width);
+            }
+            else
+            { add_polygon(clip, colors, 3, material);
+            }
+        }
+    }
+}
+
+/**
+* Clips a polygon against the near plane and adds its triangles, or its edges
+* in GL_LINE mode
+* @param clip Vertices, in clip coordinates
+* @param colors Lit color of each vertex
+* @param vertices_count Number of vertices
+* @param material Material of the polygon
+*/
+void cgvSoftwareRenderer::add_polygon(const GLfloat clip[][4], const GLfloat colors[][3], int vertices_count,
+                                      const cgvMaterial& material)
+{ // clipping a triangle against one plane leaves at most four vertices
+    GLfloat out[4][4], out_colors[4][3];
+    int out_count = 0;
+    for (int i = 0; i < vertices_count; i++)
+    { const GLfloat* a = clip[i];
+        const GLfloat* b = clip[(i + 1) % vertices_count];
+        GLfloat da = a[2] + a[3], db = b[2] + b[3]; // distance to the near plane, z = -w
+        if (da >= 0)
+        { memcpy(out[out_count], a, sizeof(out[0]));
+            memcpy(out_colors[out_count], colors[i], sizeof(out_colors[0]));
+            out_count++;
+        }
+        if ((da >= 0) != (db >= 0))
+        { GLfloat s = da / (da - db);
+            const GLfloat* ca = colors[i];
+            const GLfloat* cb = colors[(i + 1) % vertices_count];
+            for (int c = 0; c < 4; c++)
+            { out[out_count][c] = a[c] + (b[c] - a[c]) * s;
+            }
+            for (int c = 0; c < 3; c++)
+            { out_colors[out_count][c] = ca[c] + (cb[c] - ca[c]) * s;
+            }
+            out_count++;
+        }
+    }
+    if (out_count < 3)
+    { return;
+    }
+
+    if (material.polygon_mode == GL_LINE)
+    { for (int i = 0; i < out_count; i++)
+        { int j = (i + 1) % out_count;
+            add_line(out[i], out[j], out_colors[i], out_colors[j], material.line_width);
+        }
+        return;
+    }
+
+    cgvRasterVertex window[4];
+    for (int i = 0; i < out_count; i++)
+    { window[i] = to_window(out[i], out_colors[i]);
+    }
+    for (int i = 1; i + 1 < out_count; i++)
+    { add_triangle(window[0], window[i], window[i + 1], false);
+    }
+}
+
+/**
+* Clips a line against the near plane and adds it as a quad of its width
+* @param a First end, in clip coordinates
+* @param b Second end, in clip coordinates
+* @param color_a Lit color of the first end
+* @param color_b Lit color of the second end
+* @param line_width Width, in pixels
+*/
+void cgvSoftwareRenderer::add_line(const GLfloat a[4], const GLfloat b[4], const GLfloat color_a[3],
+                                   const GLfloat color_b[3], GLfloat line_width)
+{ GLfloat da = a[2] + a[3], db = b[2] + b[3];
+    if (da < 0 && db < 0)
+    { return;
+    }
+
+    GLfloat ends[2][4], ends_colors[2][3];
+    memcpy(ends[0], a, sizeof(ends[0]));
+    memcpy(ends[1], b, sizeof(ends[1]));
+    memcpy(ends_colors[0], color_a, sizeof(ends_colors[0]));
+    memcpy(ends_colors[1], color_b, sizeof(ends_colors[1]));
+    if (da < 0 || db < 0)
+    { int outside = da < 0 ? 0 : 1;
+        GLfloat s = da / (da - db);
+        for (int c = 0; c < 4; c++)
+        { ends[outside][c] = a[c] + (b[c] - a[c]) * s;
+        }
+        for (int c = 0; c < 3; c++)
+        { ends_colors[outside][c] = color_a[c] + (color_b[c] - color_a[c]) * s;
+        }
+    }
+
+    cgvRasterVertex wa = to_window(ends[0], ends_colors[0]);
+    cgvRasterVertex wb = to_window(ends[1], ends_colors[1]);
+    GLfloat dx = wb.x - wa.x, dy = wb.y - wa.y;
+    GLfloat length = sqrtf(dx * dx + dy * dy);
+    if (length == 0)
+    { return;
+    }
+
+    GLfloat half = std::max(line_width, 1.0f) / 2;
+    GLfloat nx = -dy / length * half, ny = dx / length * half;
+    cgvRasterVertex corner[4] = { wa, wa, wb, wb };
+    corner[0].x += nx; corner[0].y += ny;
+    corner[1].x -= nx; corner[1].y -= ny;
+    corner[2].x -= nx; corner[2].y -= ny;
+    corner[3].x += nx; corner[3].y += ny;
+    add_triangle(corner[0], corner[1], corner[2], true);
+    add_triangle(corner[0], corner[2], corner[3], true);
+}
+
+/**
+* Sets up the edge functions of a triangle and adds it to the frame, unless it
+* is degenerate or outside the viewport
+* @param line Whether it is part of a line
+*/
+void cgvSoftwareRenderer::add_triangle(const cgvRasterVertex& v0, const cgvRasterVertex& v1,
+                                       const cgvRasterVertex& v2, bool line)
+{ GLfloat area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+    if (!(fabsf(area) > 1e-8f)) // also rejects NaN
+    { return;
+    }
+
+    // pixels whose center can be inside, clamped before converting so huge coordinates do not overflow
+    GLfloat left = (GLfloat) viewport[0], right = (GLfloat) (viewport[0] + viewport[2]);
+    GLfloat bottom = (GLfloat) viewport[1], top = (GLfloat) (viewport[1] + viewport[3]);
+    cgvRasterTriangle triangle;
+    triangle.min_x = (int) std::max(floorf(std::min(std::min(v0.x, v1.x), v2.x)), left);
+    triangle.max_x = (int) std::min(ceilf(std::max(std::max(v0.x, v1.x), v2.x)), right) - 1;
+    triangle.min_y = (int) std::max(floorf(std::min(std::min(v0.y, v1.y), v2.y)), bottom);
+    triangle.max_y = (int) std::min(ceilf(std::max(std::max(v0.y, v1.y), v2.y)), top) - 1;
+    if (triangle.min_x > triangle.max_x || triangle.min_y > triangle.max_y)
+    { return;
+    }
+
+    // barycentric coordinate of each vertex: edge function of the opposite edge over the area
+    const cgvRasterVertex* v[3] = { &v0, &v1, &v2 };
+    for (int i = 0; i < 3; i++)
+    { const cgvRasterVertex& a = *v[(i + 1) % 3];
+        const cgvRasterVertex& b = *v[(i + 2) % 3];
+        triangle.edge[i][0] = -(b.y - a.y) / area;
+        triangle.edge[i][1] = (b.x - a.x) / area;
+        triangle.edge[i][2] = ((b.y - a.y) * a.x - (b.x - a.x) * a.y) / area;
+        // the inside is to the right of left edges, and below top edges
+        triangle.edge_inclusive[i] = triangle.edge[i][0] > 0 || (triangle.edge[i][0] == 0 && triangle.edge[i][1] < 0);
+
+        triangle.z[i] = v[i]->z;
+        triangle.inv_w[i] = v[i]->inv_w;
+        for (int c = 0; c < 3; c++)
+        { triangle.color[i][c] = v[i]->color[c] * v[i]->inv_w;
+        }
+    }
+    triangle.line = line;
+    triangles.push_back(triangle);
+}
+
+/**
+* Projects a vertex to the viewport
+* @param clip Position, in clip coordinates, in front of the near plane
+* @param rgb Lit color
+* @return The vertex in window coordinates
+*/
+cgvRasterVertex cgvSoftwareRenderer::to_window(const GLfloat clip[4], const GLfloat rgb[3])
+{ cgvRasterVertex vertex;
+    GLfloat inv_w = clip[3] != 0 ? 1 / clip[3] : 0;
+    vertex.x = viewport[0] + (clip[0] * inv_w + 1) * viewport[2] / 2;
+    vertex.y = viewport[1] + (clip[1] * inv_w + 1) * viewport[3] / 2;
+    vertex.z = (clip[2] * inv_w + 1) / 2;
+    vertex.inv_w = inv_w;
+    memcpy(vertex.color, rgb, sizeof(vertex.color));
+    return vertex;
+}
+
+/**
+* Rasterizes the triangles binned into a tile. The depth is interpolated from
+* the first vertex, so coplanar faces of different meshes round alike. Tiles
+* start on multiples of 4 pixels, so the groups of 4 pixels of a row never cross
+* into another tile
+* @param tile Index of the tile in the viewport, row by row
+*/
+void cgvSoftwareRenderer::rasterize_tile(int tile)
+{ int tile_x = (first_tile_x + tile % tiles_x) * CGV_RASTER_TILE;
+    int tile_y = (first_tile_y + tile / tiles_x) * CGV_RASTER_TILE;
+
+    for (uint32_t index: bins[tile])
+    { const cgvRasterTriangle& t = triangles[index];
+        int x0 = std::max(t.min_x, tile_x) & ~3;
+        int x1 = std::min(t.max_x, tile_x + CGV_RASTER_TILE - 1);
+        int y0 = std::max(t.min_y, tile_y);
+        int y1 = std::min(t.max_y, tile_y + CGV_RASTER_TILE - 1);
+
+        for (int y = y0; y <= y1; y++)
+        { GLfloat py = y + 0.5f;
+            GLfloat row[3] = { t.edge[0][1] * py + t.edge[0][2], t.edge[1][1] * py + t.edge[1][2],
+                               t.edge[2][1] * py + t.edge[2][2] };
+            uint32_t* color_row = &color[(size_t) y * stride];
+            GLfloat* depth_row = &depth[(size_t) y * stride];
+
+#ifdef CGV_RASTER_SSE2
+            const __m128 lane = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+            const __m128 zero = _mm_setzero_ps(), scale = _mm_set1_ps(255.0f);
+            const __m128 first_x = _mm_set1_ps((GLfloat) t.min_x), last_x = _mm_set1_ps((GLfloat) t.max_x + 1);
+            const __m128 a0 = _mm_set1_ps(t.edge[0][0]), a1 = _mm_set1_ps(t.edge[1][0]), a2 = _mm_set1_ps(t.edge[2][0]);
+            const __m128 r0 = _mm_set1_ps(row[0]), r1 = _mm_set1_ps(row[1]), r2 = _mm_set1_ps(row[2]);
+            const __m128 all = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            const __m128 on0 = t.edge_inclusive[0] ? all : zero, on1 = t.edge_inclusive[1] ? all : zero;
+            const __m128 on2 = t.edge_inclusive[2] ? all : zero, equal = t.line ? all : zero;
+
+            for (int x = x0; x <= x1; x += 4)
+            { __m128 px = _mm_add_ps(_mm_set1_ps((GLfloat) x), lane);
+                __m128 l0 = _mm_add_ps(_mm_mul_ps(a0, px), r0);
+                __m128 l1 = _mm_add_ps(_mm_mul_ps(a1, px), r1);
+                __m128 l2 = _mm_add_ps(_mm_mul_ps(a2, px), r2);
+
+                __m128 in0 = _mm_or_ps(_mm_cmpgt_ps(l0, zero), _mm_and_ps(_mm_cmpeq_ps(l0, zero), on0));
+                __m128 in1 = _mm_or_ps(_mm_cmpgt_ps(l1, zero), _mm_and_ps(_mm_cmpeq_ps(l1, zero), on1));
+                __m128 in2 = _mm_or_ps(_mm_cmpgt_ps(l2, zero), _mm_and_ps(_mm_cmpeq_ps(l2, zero), on2));
+                __m128 mask = _mm_and_ps(_mm_and_ps(in0, in1), in2);
+                mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpgt_ps(px, first_x), _mm_cmplt_ps(px, last_x)));
+                if (!_mm_movemask_ps(mask))
+                { continue;
+                }
+
+                __m128 z = _mm_add_ps(_mm_set1_ps(t.z[0]), _mm_add_ps(_mm_mul_ps(l1, _mm_set1_ps(t.z[1] - t.z[0])),
+                                                                   _mm_mul_ps(l2, _mm_set1_ps(t.z[2] - t.z[0]))));
+                __m128 old_depth = _mm_loadu_ps(depth_row + x);
+                __m128 passes = _mm_or_ps(_mm_cmplt_ps(z, old_depth), _mm_and_ps(_mm_cmpeq_ps(z, old_depth), equal));
+                mask = _mm_and_ps(mask, _mm_and_ps(passes, _mm_cmpge_ps(z, zero)));
+                if (!_mm_movemask_ps(mask))
+                { continue;
+                }
+
+                __m128 iw = _mm_add_ps(_mm_add_ps(_mm_mul_ps(l0, _mm_set1_ps(t.inv_w[0])), _mm_mul_ps(l1, _mm_set1_ps(t.inv_w[1]))),
+                                       _mm_mul_ps(l2, _mm_set1_ps(t.inv_w[2])));
+                __m128 w = _mm_div_ps(scale, iw);
+                __m128i packed = _mm_set1_epi32((int) 0xff000000u);
+                for (int c = 0; c < 3; c++)
+                { __m128 value = _mm_add_ps(_mm_add_ps(_mm_mul_ps(l0, _mm_set1_ps(t.color[0][c])),
+                                                        _mm_mul_ps(l1, _mm_set1_ps(t.color[1][c]))),
+                                             _mm_mul_ps(l2, _mm_set1_ps(t.color[2][c])));
+                    value = _mm_min_ps(_mm_max_ps(_mm_mul_ps(value, w), zero), scale);
+                    __m128i channel = _mm_cvttps_epi32(_mm_add_ps(value, _mm_set1_ps(0.5f)));
+                    packed = _mm_or_si128(packed, _mm_slli_epi32(channel, 8 * c));
+                }
+
+                __m128i select = _mm_castps_si128(mask);
+                __m128i old_color = _mm_loadu_si128((const __m128i*) (color_row + x));
+                _mm_storeu_si128((__m128i*) (color_row + x),
+                                 _mm_or_si128(_mm_and_si128(select, packed), _mm_andnot_si128(select, old_color)));
+                _mm_storeu_ps(depth_row + x, _mm_or_ps(_mm_and_ps(mask, z), _mm_andnot_ps(mask, old_depth)));
+            }
+#else
+            for (int x = std::max(x0, t.min_x); x <= x1; x++)
+            { GLfloat px = x + 0.5f;
+                GLfloat l[3];
+                for (int i = 0; i < 3; i++)
+                { l[i] = t.edge[i][0] * px + row[i];
+                }
+                bool inside = true;
+                for (int i = 0; i < 3; i++)
+                { inside = inside && (l[i] > 0 || (l[i] == 0 && t.edge_inclusive[i]));
+                }
+                if (!inside)
+                { continue;
+                }
+
+                GLfloat z = t.z[0] + l[1] * (t.z[1] - t.z[0]) + l[2] * (t.z[2] - t.z[0]);
+                if (z < 0 || z > depth_row[x] || (z == depth_row[x] && !t.line))
+                { continue;
+                }
+
+                GLfloat w = 1 / (l[0] * t.inv_w[0] + l[1] * t.inv_w[1] + l[2] * t.inv_w[2]);
+                GLfloat rgb[3];
+                for (int c = 0; c < 3; c++)
+                { rgb[c] = std::max((l[0] * t.color[0][c] + l[1] * t.color[1][c] + l[2] * t.color[2][c]) * w, 0.0f);
+                }
+                color_row[x] = pack_color(rgb[0], rgb[1], rgb[2]);
+                depth_row[x] = z;
+            }
+#endif   // CGV_RASTER_SSE2
+        }
+    }
+}
@@ -0,0 +1,139 @@
+#ifndef __CGVSOFTWARERENDERER
+#define __CGVSOFTWARERENDERER
+
+#include <cstdint>
+#include <vector>
+
+#include "cgvPointArray.h"
+#include "cgvRenderer.h"
+#include "cgvThreadPool.h"
+
+#define CGV_RASTER_TILE 64 ///< Width and height of the screen tiles, in pixels (multiple of 4)
+
+/**
+ * Mesh submitted to the software renderer, drawn at the end of the frame
+ */
+struct cgvSoftwareInstance {
+    cgvMesh mesh; ///< Mesh to draw
+    cgvMaterial material; ///< Appearance of the mesh
+    cgvMat4 transform; ///< Modeling matrix
+    cgvViewMask visible; ///< Views the mesh is drawn in
+};
+
+/**
+ * Vertex after lighting and projection, in window coordinates
+ */
+struct cgvRasterVertex {
+    GLfloat x, y; ///< Position in the framebuffer, in pixels
+    GLfloat z; ///< Depth, from 0 (near plane) to 1 (far plane)
+    GLfloat inv_w; ///< 1 / w, for perspective-correct colors
+    GLfloat color[3]; ///< Lit color
+};
+
+/**
+ * Triangle ready to be rasterized. The edge functions are scaled by the area, so
+ * they give the barycentric coordinates of a pixel, and the attributes are
+ * premultiplied by 1 / w
+ */
+struct cgvRasterTriangle {
+    GLfloat edge[3][3]; ///< a, b, c of the barycentric coordinate of each vertex: a * x + b * y + c
+    GLfloat z[3]; ///< Depth of each vertex
+    GLfloat inv_w[3]; ///< 1 / w of each vertex
+    GLfloat color[3][3]; ///< Color of each vertex, times its 1 / w
+    bool edge_inclusive[3]; ///< Whether pixel centers on each edge are inside (top-left rule)
+    bool line; ///< Whether it is part of a line, which passes the depth test on equal depths
+    int min_x, min_y, max_x, max_y; ///< Pixels covered, clamped to the viewport
+};
+
+/**
+ * Renderer that draws on the CPU to a framebuffer in memory, so the scenes can be
+ * drawn on machines without a GPU. The triangles of a frame are lit per vertex as
+ * GL_LIGHTING does, binned into CGV_RASTER_TILE square tiles, and the tiles are
+ * rasterized in parallel on a thread pool, four pixels at a time with SSE2 edge
+ * functions when available. It supports the features the labs use: depth test,
+ * emission and Lambert lighting, fill and line polygon modes and line widths.
+ * Triangles follow the top-left fill rule and the GL_LESS depth test, and lines
+ * pass on equal depths so outlines show over their faces. The number of threads
+ * can be set with the CGV_RASTER_THREADS environment variable
+ */
+class cgvSoftwareRenderer: public cgvRenderer {
+private:
+    cgvThreadPool* pool = nullptr; ///< Threads that rasterize the tiles
+
+    // Framebuffer, with the rows from bottom to top as in OpenGL
+    int width = 0; ///< Width, in pixels
+    int height = 0; ///< Height, in pixels
+    int stride = 0; ///< Pixels per row, a multiple of 4
+    std::vector<uint32_t> color; ///< RGBA8 colors
+    std::vector<GLfloat> depth; ///< Depths, from 0 to 1
+    uint32_t clear_color = 0; ///< Color set by clear, packed as RGBA8
+
+    GLint viewport[4] = { 0, 0, 0, 0 }; ///< Region drawn to: x, y, width, height
+    cgvMat4 view_projection; ///< Projection times view matrix of the camera
+    cgvVec4 light = cgvVec4(0, 0, 0, 0); ///< Position of the point light, in world coordinates
+
+    std::vector<cgvVertex> vertices; ///< Vertices of all the meshes
+    GLint first[CGV_MESHES]; ///< First vertex of each mesh
+    GLsizei count[CGV_MESHES]; ///< Number of vertices of each mesh
+    GLenum primitive[CGV_MESHES]; ///< GL_TRIANGLES or GL_LINES
+    cgvPointArray positions[CGV_MESHES]; ///< Positions of the vertices of each mesh, transformed all at once
+    cgvPointArray normals[CGV_MESHES]; ///< Normals of the vertices of each mesh
+
+    // Vertices of the mesh being processed, reused by every instance
+    cgvPointArray clip_positions; ///< x, y, z in clip coordinates
+    std::vector<GLfloat> clip_w; ///< w in clip coordinates
+    cgvPointArray world_positions; ///< Positions in world coordinates, if lit
+    cgvPointArray world_normals; ///< Normals in world coordinates, not normalized, if lit
+
+    std::vector<cgvSoftwareInstance> instances; ///< Meshes submitted in the frame
+    std::vector<cgvRasterTriangle> triangles; ///< Triangles of the frame, in submission order
+    std::vector<std::vector<uint32_t>> bins; ///< Triangles that overlap each tile of the viewport
+    int first_tile_x = 0, first_tile_y = 0; ///< Tile of the bottom left corner of the viewport
+    int tiles_x = 0, tiles_y = 0; ///< Tiles of the viewport in each direction
+
+public:
+    /// Default constructor. The threads are started by initialize
+    cgvSoftwareRenderer() = default;
+
+    /// Destructor
+    ~cgvSoftwareRenderer() override;
+
+    // Methods
+    const char* get_name() override;
+    bool requires_window() override;
+    bool initialize() override;
+
+    void set_clear_color(GLfloat r, GLfloat g, GLfloat b) override;
+    void clear() override;
+    void present() override;
+    bool save_frame(const char* path) override;
+
+    void set_camera(const cgvMat4& projection, const cgvMat4& view) override;
+    void set_light(const cgvVec4& position) override;
+
+    void begin_frame() override;
+    void submit(cgvMesh mesh, const cgvMaterial& material, const cgvMat4& transform) override;
+    unsigned long end_frame() override;
+
+    int get_width();
+    int get_height();
+    const uint32_t* get_pixels(); // rows from bottom to top, get_stride() pixels apart
+    int get_stride();
+
+protected:
+    void apply_viewport(GLint x, GLint y, GLsizei _width, GLsizei _height) override;
+    bool update_target() override;
+
+private:
+    void get_frame_size(int size[2]);
+    void process_instance(const cgvSoftwareInstance& instance);
+    void add_polygon(const GLfloat clip[][4], const GLfloat colors[][3], int vertices_count,
+                     const cgvMaterial& material);
+    void add_line(const GLfloat a[4], const GLfloat b[4], const GLfloat color_a[3], const GLfloat color_b[3],
+                  GLfloat line_width);
+    void add_triangle(const cgvRasterVertex& v0, const cgvRasterVertex& v1, const cgvRasterVertex& v2, bool line);
+    cgvRasterVertex to_window(const GLfloat clip[4], const GLfloat rgb[3]);
+    void rasterize_tile(int tile);
+};
+
+#endif   // __CGVSOFTWARERENDERER
@@ -0,0 +1,72 @@
+#ifndef __CGVSTREAMBUFFER
+#define __CGVSTREAMBUFFER
+
+#include <vector>
+
+#include "cgvGLCore.h"
+
+#define CGV_STREAM_REGIONS 3 ///< Regions of the ring: one written by the CPU while the GPU reads the other two
+#define CGV_STREAM_ALIGNMENT 256 ///< Alignment of the regions in the buffer, in bytes
+
+/**
+ * Vertex buffer for data rewritten on every frame. With GL_ARB_buffer_storage it
+ * is a ring of CGV_STREAM_REGIONS regions of one buffer that stays mapped, with
+ * persistent and coherent mapping: the CPU writes the data of a frame straight
+ * through the mapping into one region, the draws of a frame may take several
+ * pieces of it, while the GPU may still read the regions of the previous frames.
+ * A fence placed after the draws that read a region guards it until the GPU is
+ * done with it, and the CPU only waits for that fence when it comes back to the
+ * region; each wait that blocks is counted and reported on stderr. Without the
+ * extension, or with CGV_STREAM=orphan, the data is written to memory kept from
+ * frame to frame and uploaded with glBufferSubData after orphaning the buffer
+ */
+class cgvStreamBuffer {
+private:
+    GLuint buffer = 0; ///< Buffer of the ring
+    bool persistent = false; ///< Whether buffer is persistently mapped; orphaned on every upload otherwise
+    GLsizeiptr region_size = 0; ///< Size of each region, in bytes; the size of the whole buffer if orphaned
+    int region = 0; ///< Region the frame is written to
+    GLsizeiptr used = 0; ///< Bytes of the region written in the frame
+    bool released = true; ///< Whether the GPU is known to be done with the previous contents of the region
+    char* mapped = nullptr; ///< Mapping of the whole buffer, if persistent
+    GLsync fences[CGV_STREAM_REGIONS] = {}; ///< Fences after the last draws that read each region; null if none
+
+    std::vector<char> staging; ///< Data being written, if orphaned; only grows, so steady frames do not allocate
+    GLsizeiptr size = 0; ///< Bytes being written
+    GLintptr offset = 0; ///< Offset in the buffer of the data being written
+
+    unsigned long frame_bytes = 0; ///< Bytes written since the frame started
+    unsigned long streamed_bytes = 0; ///< Bytes written by the last frame presented
+    unsigned long waits = 0; ///< Times the CPU has waited for the GPU to release a region
+    double wait_ms = 0; ///< Time spent in those waits
+
+public:
+    /// Default constructor. The buffer is created by initialize
+    cgvStreamBuffer() = default;
+
+    /// Destructor
+    ~cgvStreamBuffer() = default;
+
+    cgvStreamBuffer(const cgvStreamBuffer&) = delete;
+    cgvStreamBuffer& operator=(const cgvStreamBuffer&) = delete;
+
+    // Methods
+    void initialize(); // once the core entry points are loaded
+
+    void* map(GLsizeiptr _size); // memory to write data in
+    GLintptr unmap(); // returns the offset of the data in the buffer, which is bound to GL_ARRAY_BUFFER
+    void fence(); // after the draws that read the data
+    void next_frame(); // when the frame is presented
+
+    bool is_persistent();
+    unsigned long get_streamed_bytes(); // by the last frame presented
+    unsigned long get_waits();
+    double get_wait_ms();
+
+private:
+    void allocate(GLsizeiptr _region_size);
+    void next_region();
+    void wait(int _region);
+};
+
+#endif   // __CGVSTREAMBUFFER
@@ -0,0 +1,91 @@
+#include "cgvThreadPool.h"
+
+/**
+* Constructor that starts the workers
+* @param threads Threads that run each loop, including the caller
+*/
+cgvThreadPool::cgvThreadPool(unsigned int threads)
+{ for (unsigned int i = 1; i < threads; i++)
+    { workers.emplace_back(&cgvThreadPool::work, this);
+    }
+}
+
+/**
+* Destructor that waits for the workers to exit
+*/
+cgvThreadPool::~cgvThreadPool()
+{ { std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_ready.notify_all();
+    for (std::thread& worker: workers)
+    { worker.join();
+    }
+}
+
+/**
+* Method to query the number of threads that run each loop
+* @return The workers plus the calling thread
+*/
+unsigned int cgvThreadPool::get_threads()
+{ return (unsigned int) workers.size() + 1;
+}
+
+/**
+* Runs the iterations of a loop on all the threads, and returns once all of them
+* have finished. Iterations are taken one at a time, so uneven ones balance out
+* @param iterations Number of iterations
+* @param body Function called with the index of each iteration
+*/
+void cgvThreadPool::run(int iterations, const std::function<void(int)>& body)
+{ if (iterations <= 0)
+    { return;
+    }
+
+    { std::lock_guard<std::mutex> lock(mutex);
+        job = body;
+        count = iterations;
+        next = 0;
+        busy = (int) workers.size();
+        generation++;
+    }
+    work_ready.notify_all();
+
+    take_iterations();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    work_done.wait(lock, [this] { return busy == 0; });
+    job = nullptr;
+}
+
+/**
+* Loop of the workers: waits for a loop to start and takes part in it
+*/
+void cgvThreadPool::work()
+{ unsigned long done = 0;
+    for (;;)
+    { { std::unique_lock<std::mutex> lock(mutex);
+            work_ready.wait(lock, [this, done] { return stopping || generation != done; });
+            if (stopping)
+            { return;
+            }
+            done = generation;
+        }
+
+        take_iterations();
+
+        { std::lock_guard<std::mutex> lock(mutex);
+            busy--;
+        }
+        work_done.notify_one();
+    }
+}
+
+/**
+* Runs iterations of the current loop until there are none left
+*/
+void cgvThreadPool::take_iterations()
+{ for (int i = next++; i < count; i = next++)
+    { job(i);
+    }
+}